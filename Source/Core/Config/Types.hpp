@@ -14,6 +14,7 @@
 #include <set>
 #include <unordered_set>
 #include <vector>
+#include <list>
 #include <array>
 #include <optional>
 #include <filesystem>
@@ -94,6 +95,9 @@ template <typename T> using UniquePtr = std::unique_ptr<T>;
 ///////////////////////////////////////////////////////////////////////////////
 template <typename T> using Vector = std::vector<T>;
 
+///////////////////////////////////////////////////////////////////////////////
+template <typename T> using List = std::list<T>;
+
 ///////////////////////////////////////////////////////////////////////////////
 typedef unsigned char Uint8;
 typedef unsigned short Uint16;
@@ -7,4 +7,7 @@
 // Dependencies
 ///////////////////////////////////////////////////////////////////////////////
 #include "Core/Media.hpp"
-#include "Core/Player/VideoPlayer.hpp"
+#include "Core/Player.hpp"
+#include "Core/System.hpp"
+#include "Core/Interface.hpp"
+#include "Core/Tools.hpp"
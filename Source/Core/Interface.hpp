@@ -0,0 +1,14 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/Timeline.hpp"
+#include "Core/Interface/WaveformStrip.hpp"
+#include "Core/Interface/VideoWall.hpp"
+#include "Core/Interface/Scopes.hpp"
+#include "Core/Interface/Spectrum.hpp"
+#include "Core/Interface/ColorGrade.hpp"
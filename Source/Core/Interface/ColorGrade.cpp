@@ -0,0 +1,97 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/ColorGrade.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Lattice coordinates from the pixel, then two lookups per slice
+///
+///////////////////////////////////////////////////////////////////////////////
+static constexpr const char* FRAGMENT_SHADER = R"(
+uniform sampler2D source;
+uniform sampler2D lut;
+uniform float size;
+uniform vec3 scale;
+uniform vec3 offset;
+
+void main()
+{
+    vec4 pixel = texture2D(source, gl_TexCoord[0].xy);
+    vec3 point = clamp(pixel.rgb * scale + offset, 0.0, size - 1.0);
+    float slice = min(floor(point.b), size - 2.0);
+    vec2 position = vec2((slice * size + point.r + 0.5) / (size * size),
+        (point.g + 0.5) / size);
+    vec3 low = texture2D(lut, position).rgb;
+    vec3 high = texture2D(lut, position + vec2(1.0 / size, 0.0)).rgb;
+
+    gl_FragColor = vec4(mix(low, high, point.b - slice), pixel.a) * gl_Color;
+}
+)";
+
+///////////////////////////////////////////////////////////////////////////////
+ColorGrade::ColorGrade(void)
+    : mCompiled(false)
+    , mFailed(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ColorGrade::SetLut(SharedPtr<const ColorLut> lut)
+{
+    mLut.reset();
+
+    if (!lut) {
+        return (true);
+    }
+
+    if (!mCompiled && !mFailed) {
+        mFailed = !sf::Shader::isAvailable() || !mShader.loadFromMemory(
+            FRAGMENT_SHADER, sf::Shader::Type::Fragment);
+        mCompiled = !mFailed;
+    }
+
+    Uint32 size = static_cast<Uint32>(lut->GetSize());
+
+    if (!mCompiled || size * size > sf::Texture::getMaximumSize()) {
+        return (false);
+    }
+
+    if (!mTexture.loadFromImage(lut->ToImage())) {
+        return (false);
+    }
+    mTexture.setSmooth(true);
+
+    sf::Glsl::Vec3 scale;
+    sf::Glsl::Vec3 offset;
+    float* scales[3] = {&scale.x, &scale.y, &scale.z};
+    float* offsets[3] = {&offset.x, &offset.y, &offset.z};
+
+    // The shader reads normalized colors, the domain is per 8 bit value
+    for (int c = 0; c < 3; c++) {
+        Pair<float, float> domain = lut->GetDomain(c);
+
+        *scales[c] = domain.first * 255.f;
+        *offsets[c] = domain.second;
+    }
+
+    mShader.setUniform("source", sf::Shader::CurrentTexture);
+    mShader.setUniform("lut", mTexture);
+    mShader.setUniform("size", static_cast<float>(size));
+    mShader.setUniform("scale", scale);
+    mShader.setUniform("offset", offset);
+    mLut = std::move(lut);
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Shader* ColorGrade::GetShader(void) const
+{
+    return (mLut ? &mShader : nullptr);
+}
+
+} // namespace Moon
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/ColorLut.hpp"
+#include <SFML/Graphics.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Fragment shader applying a 3D LUT while the frame is drawn
+///
+/// SFML has no 3D textures, so the lattice is uploaded as its blue slices
+/// laid side by side in a smooth 2D texture: the hardware filters within a
+/// slice and the shader blends the two nearest slices, which makes the
+/// lookup trilinear rather than tetrahedral. Grading costs nothing on the
+/// decoding thread and a new table shows on the next drawn frame.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ColorGrade
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Shader mShader;
+    sf::Texture mTexture;
+    bool mCompiled;
+    bool mFailed;
+    SharedPtr<const ColorLut> mLut;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ColorGrade(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Upload a table for the shader
+    ///
+    /// Must be called from the thread owning the OpenGL context. Fails when
+    /// shaders are not supported or the slices exceed the texture size, the
+    /// table must then be applied on the CPU.
+    ///
+    /// \param lut Table to apply, nullptr for none
+    ///
+    /// \return True if the shader applies the table
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool SetLut(SharedPtr<const ColorLut> lut);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Shader to draw the frame with, nullptr without a table
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Shader* GetShader(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,536 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/Scopes.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <imgui.h>
+#include <imgui-SFML.h>
+#include <cmath>
+extern "C" {
+    #include <libavutil/pixdesc.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static Uint8 ClampByte(int value)
+{
+    return (static_cast<Uint8>(std::clamp(value, 0, 255)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void ConvertRowScalar(
+    const Uint8* y,
+    const Uint8* u,
+    const Uint8* v,
+    size_t first,
+    size_t count,
+    const Scopes::Coefficients& c,
+    Uint8* r,
+    Uint8* g,
+    Uint8* b
+)
+{
+    for (size_t i = first; i < count; i++) {
+        int luma = (y[i] - c.yOffset) * c.yScale;
+        int cb = u[i] - 128;
+        int cr = v[i] - 128;
+
+        r[i] = ClampByte((luma + c.rv * cr + 512) >> 10);
+        g[i] = ClampByte((luma - c.gu * cb - c.gv * cr + 512) >> 10);
+        b[i] = ClampByte((luma + c.bu * cb + 512) >> 10);
+    }
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static void ConvertRowAvx2(
+    const Uint8* y,
+    const Uint8* u,
+    const Uint8* v,
+    size_t count,
+    const Scopes::Coefficients& c,
+    Uint8* r,
+    Uint8* g,
+    Uint8* b
+)
+{
+    const __m256i yOffset = _mm256_set1_epi32(c.yOffset);
+    const __m256i chromaOffset = _mm256_set1_epi32(128);
+    const __m256i yScale = _mm256_set1_epi32(c.yScale);
+    const __m256i rv = _mm256_set1_epi32(c.rv);
+    const __m256i gu = _mm256_set1_epi32(c.gu);
+    const __m256i gv = _mm256_set1_epi32(c.gv);
+    const __m256i bu = _mm256_set1_epi32(c.bu);
+    const __m256i rounding = _mm256_set1_epi32(512);
+    size_t i = 0;
+
+    // Eight pixels in 32 bit lanes, same arithmetic as the scalar path
+    for (; i + 8 <= count; i += 8) {
+        __m256i luma = _mm256_mullo_epi32(_mm256_sub_epi32(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(y + i))),
+            yOffset), yScale);
+        __m256i cb = _mm256_sub_epi32(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + i))),
+            chromaOffset);
+        __m256i cr = _mm256_sub_epi32(_mm256_cvtepu8_epi32(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + i))),
+            chromaOffset);
+
+        luma = _mm256_add_epi32(luma, rounding);
+
+        __m256i red = _mm256_srai_epi32(_mm256_add_epi32(luma,
+            _mm256_mullo_epi32(rv, cr)), 10);
+        __m256i green = _mm256_srai_epi32(_mm256_sub_epi32(luma,
+            _mm256_add_epi32(_mm256_mullo_epi32(gu, cb),
+            _mm256_mullo_epi32(gv, cr))), 10);
+        __m256i blue = _mm256_srai_epi32(_mm256_add_epi32(luma,
+            _mm256_mullo_epi32(bu, cb)), 10);
+
+        // Saturating packs clamp to [0, 255]; the permutes undo the lane
+        // interleaving so that each channel ends up in 8 contiguous bytes
+        __m256i redGreen = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(red, green), 0xD8);
+        __m256i blueBlue = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(blue, blue), 0xD8);
+        __m256i bytes = _mm256_packus_epi16(redGreen, blueBlue);
+        __m128i low = _mm256_castsi256_si128(bytes);
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(r + i), low);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(g + i),
+            _mm256_extracti128_si256(bytes, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(b + i),
+            _mm_srli_si128(low, 8));
+    }
+
+    ConvertRowScalar(y, u, v, i, count, c, r, g, b);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+Scopes::Scopes(void)
+    : mAnalyzing(false)
+    , mStep(2)
+    , mShownStep(0)
+    , mShownSeconds(0.0)
+{
+    mCounts.waveform.resize(LEVELS * COLUMNS);
+    mCounts.parade.resize(3 * LEVELS * COLUMNS);
+    mCounts.vectorscope.resize(LEVELS * LEVELS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Scopes::~Scopes()
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mStop = true;
+    }
+    mTask.Stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Scopes::Coefficients Scopes::GetCoefficients(const AVFrame* picture)
+{
+    bool full = picture->color_range == AVCOL_RANGE_JPEG ||
+        picture->format == AV_PIX_FMT_YUVJ420P ||
+        picture->format == AV_PIX_FMT_YUVJ422P ||
+        picture->format == AV_PIX_FMT_YUVJ444P;
+    bool bt601 = picture->colorspace == AVCOL_SPC_BT470BG ||
+        picture->colorspace == AVCOL_SPC_SMPTE170M ||
+        (picture->colorspace == AVCOL_SPC_UNSPECIFIED && picture->height < 720);
+    double kr = bt601 ? 0.299 : 0.2126;
+    double kb = bt601 ? 0.114 : 0.0722;
+    double kg = 1.0 - kr - kb;
+    double yScale = full ? 1.0 : 255.0 / 219.0;
+    double cScale = full ? 1.0 : 255.0 / 224.0;
+    auto fixed = [](double value) {
+        return (static_cast<int>(std::lround(value * 1024.0)));
+    };
+
+    return (Coefficients{
+        full ? 0 : 16,
+        fixed(yScale),
+        fixed(cScale * 2.0 * (1.0 - kr)),
+        fixed(cScale * 2.0 * (1.0 - kb) * kb / kg),
+        fixed(cScale * 2.0 * (1.0 - kr) * kr / kg),
+        fixed(cScale * 2.0 * (1.0 - kb))
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Work(void)
+{
+    while (true) {
+        SharedPtr<VideoFrame> frame = nullptr;
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            if (mStop || !mPending) {
+                return;
+            }
+            frame.swap(mPending);
+            mAnalyzing = true;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        auto plots = std::make_unique<Plots>();
+
+        plots->step = mStep;
+        Analyze(*frame);
+        Render(*plots);
+
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+
+        plots->seconds = elapsed.count();
+
+        if (plots->seconds > TIME_BUDGET && mStep < MAX_STEP) {
+            mStep *= 2;
+        } else if (plots->seconds < TIME_BUDGET / 4 && mStep > 1) {
+            mStep /= 2;
+        }
+
+        std::unique_lock<Mutex> lock(mMutex);
+        mReady = std::move(plots);
+        mAnalyzing = false;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Analyze(const VideoFrame& frame)
+{
+    for (auto& histogram : mCounts.histograms) {
+        histogram.fill(0);
+    }
+    std::fill(mCounts.waveform.begin(), mCounts.waveform.end(), 0);
+    std::fill(mCounts.parade.begin(), mCounts.parade.end(), 0);
+    std::fill(mCounts.vectorscope.begin(), mCounts.vectorscope.end(), 0);
+
+    const AVFrame* picture = frame.picture;
+    const AVPixFmtDescriptor* descriptor = picture
+        ? av_pix_fmt_desc_get(static_cast<AVPixelFormat>(picture->format))
+        : nullptr;
+    bool planes = descriptor && descriptor->nb_components >= 3 &&
+        !(descriptor->flags & (AV_PIX_FMT_FLAG_RGB | AV_PIX_FMT_FLAG_HWACCEL));
+
+    for (int i = 0; planes && i < 3; i++) {
+        planes = descriptor->comp[i].depth == 8;
+    }
+
+    int width = planes ? picture->width : static_cast<int>(frame.width);
+    int height = planes ? picture->height : static_cast<int>(frame.height);
+
+    if (width <= 0 || height <= 0 || (!planes && !frame.data)) {
+        return;
+    }
+
+    int step = static_cast<int>(mStep);
+    size_t count = static_cast<size_t>((width + step - 1) / step);
+
+    for (auto& row : mRow) {
+        row.resize(count);
+    }
+    mColumns.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        mColumns[i] = static_cast<Uint32>(i * step * COLUMNS / width);
+    }
+
+    Uint8* y = mRow[0].data();
+    Uint8* u = mRow[1].data();
+    Uint8* v = mRow[2].data();
+    Uint8* r = mRow[3].data();
+    Uint8* g = mRow[4].data();
+    Uint8* b = mRow[5].data();
+    Coefficients coefficients = planes ? GetCoefficients(picture)
+        : Coefficients{};
+    bool avx2 = HasAvx2();
+
+    for (int line = 0; line < height; line += step) {
+        if (planes) {
+            const AVComponentDescriptor* comp = descriptor->comp;
+            const Uint8* rows[3];
+
+            for (int i = 0; i < 3; i++) {
+                int shift = i == 0 ? 0 : descriptor->log2_chroma_h;
+
+                rows[i] = picture->data[comp[i].plane] + comp[i].offset +
+                    static_cast<ptrdiff_t>(line >> shift) *
+                    picture->linesize[comp[i].plane];
+            }
+
+            for (size_t i = 0; i < count; i++) {
+                int x = static_cast<int>(i) * step;
+                int chroma = x >> descriptor->log2_chroma_w;
+
+                y[i] = rows[0][x * comp[0].step];
+                u[i] = rows[1][chroma * comp[1].step];
+                v[i] = rows[2][chroma * comp[2].step];
+            }
+
+#if MOON_X86
+            if (avx2) {
+                ConvertRowAvx2(y, u, v, count, coefficients, r, g, b);
+            } else {
+                ConvertRowScalar(y, u, v, 0, count, coefficients, r, g, b);
+            }
+#else
+            (void)avx2;
+            ConvertRowScalar(y, u, v, 0, count, coefficients, r, g, b);
+#endif
+        } else {
+            // Without the decoded picture, encode the RGBA pixels as BT.709
+            // limited range so that both paths read the same
+            const Uint8* pixels = frame.data +
+                static_cast<size_t>(line) * frame.width * 4;
+
+            for (size_t i = 0; i < count; i++) {
+                const Uint8* pixel = pixels + i * step * 4;
+                double luma = 0.2126 * pixel[0] + 0.7152 * pixel[1] +
+                    0.0722 * pixel[2];
+
+                r[i] = pixel[0];
+                g[i] = pixel[1];
+                b[i] = pixel[2];
+                y[i] = ClampByte(static_cast<int>(16.5 + luma * 219.0 / 255.0));
+                u[i] = ClampByte(static_cast<int>(128.5 +
+                    (pixel[2] - luma) / 1.8556 * 224.0 / 255.0));
+                v[i] = ClampByte(static_cast<int>(128.5 +
+                    (pixel[0] - luma) / 1.5748 * 224.0 / 255.0));
+            }
+        }
+
+        Accumulate(count);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Accumulate(size_t count)
+{
+    const Uint8* channels[4] = {
+        mRow[0].data(), mRow[3].data(), mRow[4].data(), mRow[5].data()
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        Uint32 column = mColumns[i];
+
+        for (int channel = 0; channel < 4; channel++) {
+            mCounts.histograms[channel][channels[channel][i]]++;
+        }
+
+        mCounts.waveform[(LEVELS - 1 - channels[0][i]) * COLUMNS + column]++;
+
+        for (Uint32 channel = 0; channel < 3; channel++) {
+            mCounts.parade[(channel * LEVELS + LEVELS - 1 -
+                channels[channel + 1][i]) * COLUMNS + column]++;
+        }
+
+        // Cb to the right and Cr up, as on hardware scopes
+        mCounts.vectorscope[(LEVELS - 1 - mRow[2][i]) * LEVELS + mRow[1][i]]++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Render(Plots& plots) const
+{
+    Uint64 samples = 0;
+    Uint32 peak = 1;
+
+    for (Uint32 count : mCounts.histograms[0]) {
+        samples += count;
+    }
+    for (const auto& histogram : mCounts.histograms) {
+        peak = std::max(peak, *std::max_element(
+            histogram.begin(), histogram.end()));
+    }
+
+    // Bars of the three channels add up, luma shows where none reaches
+    plots.histogram.assign(LEVELS * HISTOGRAM_HEIGHT * 4, 255);
+    for (Uint32 level = 0; level < LEVELS; level++) {
+        Uint32 heights[4];
+
+        for (int channel = 0; channel < 4; channel++) {
+            heights[channel] = static_cast<Uint32>(static_cast<Uint64>(
+                mCounts.histograms[channel][level]) * HISTOGRAM_HEIGHT / peak);
+        }
+
+        for (Uint32 row = 0; row < HISTOGRAM_HEIGHT; row++) {
+            Uint8* pixel = &plots.histogram[(row * LEVELS + level) * 4];
+            Uint32 above = HISTOGRAM_HEIGHT - row;
+            bool any = false;
+
+            for (int channel = 0; channel < 3; channel++) {
+                bool inside = heights[channel + 1] >= above;
+
+                pixel[channel] = inside ? 200 : 20;
+                any = any || inside;
+            }
+            if (!any && heights[0] >= above) {
+                pixel[0] = pixel[1] = pixel[2] = 110;
+            }
+        }
+    }
+
+    // Brightness follows the density of samples, relative to samples
+    // spread evenly over the plot
+    const double perColumn = std::max<double>(1.0,
+        static_cast<double>(samples) / COLUMNS);
+    auto intensity = [perColumn](Uint32 count) {
+        double density = count * LEVELS / perColumn;
+
+        return (static_cast<Uint8>(255.0 * std::min(1.0,
+            std::sqrt(density / 16.0))));
+    };
+    auto plot = [&](Vector<Uint8>& pixels, const Uint32* counts,
+        Uint32 size, const Uint8 tint[3]
+    ) {
+        pixels.resize(static_cast<size_t>(size) * 4);
+        for (Uint32 i = 0; i < size; i++) {
+            Uint8 value = intensity(counts[i]);
+
+            pixels[i * 4 + 0] = static_cast<Uint8>(value * tint[0] / 255);
+            pixels[i * 4 + 1] = static_cast<Uint8>(value * tint[1] / 255);
+            pixels[i * 4 + 2] = static_cast<Uint8>(value * tint[2] / 255);
+            pixels[i * 4 + 3] = 255;
+        }
+    };
+
+    static constexpr Uint8 LUMA[3] = {160, 255, 160};
+    static constexpr Uint8 CHANNELS[3][3] = {
+        {255, 64, 64}, {64, 255, 64}, {64, 96, 255}
+    };
+
+    plot(plots.waveform, mCounts.waveform.data(), LEVELS * COLUMNS, LUMA);
+
+    // The parade puts the three channels side by side
+    Vector<Uint8> channel;
+
+    plots.parade.resize(3 * LEVELS * COLUMNS * 4);
+    for (Uint32 c = 0; c < 3; c++) {
+        plot(channel, &mCounts.parade[c * LEVELS * COLUMNS], LEVELS * COLUMNS,
+            CHANNELS[c]);
+
+        for (Uint32 row = 0; row < LEVELS; row++) {
+            std::copy_n(&channel[row * COLUMNS * 4], COLUMNS * 4,
+                &plots.parade[(row * 3 * COLUMNS + c * COLUMNS) * 4]);
+        }
+    }
+
+    plot(plots.vectorscope, mCounts.vectorscope.data(), LEVELS * LEVELS, LUMA);
+
+    for (Uint32 i = 0; i < LEVELS; i++) {
+        for (Uint32 index : {(LEVELS / 2) * LEVELS + i, i * LEVELS + LEVELS / 2}) {
+            Uint8* pixel = &plots.vectorscope[index * 4];
+
+            pixel[0] = std::max<Uint8>(pixel[0], 60);
+            pixel[1] = std::max<Uint8>(pixel[1], 60);
+            pixel[2] = std::max<Uint8>(pixel[2], 60);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Submit(const SharedPtr<VideoFrame>& frame)
+{
+    if (!frame) {
+        return;
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mPending = frame;
+    }
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Scopes::Update(void)
+{
+    UniquePtr<Plots> plots = nullptr;
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        plots.swap(mReady);
+    }
+
+    if (!plots) {
+        return (false);
+    }
+
+    auto upload = [](sf::Texture& texture, const Vector<Uint8>& pixels,
+        sf::Vector2u size
+    ) {
+        if (texture.getSize() != size && !texture.resize(size)) {
+            std::cerr << "Could not create scope texture" << std::endl;
+            return;
+        }
+        texture.update(pixels.data());
+    };
+
+    upload(mHistogram, plots->histogram, {LEVELS, HISTOGRAM_HEIGHT});
+    upload(mWaveform, plots->waveform, {COLUMNS, LEVELS});
+    upload(mParade, plots->parade, {3 * COLUMNS, LEVELS});
+    upload(mVectorscope, plots->vectorscope, {LEVELS, LEVELS});
+    mShownStep = plots->step;
+    mShownSeconds = plots->seconds;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Scopes::IsPending(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mPending || mAnalyzing || mReady);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Scopes::Draw(bool* open)
+{
+    if (!ImGui::Begin("Scopes", open)) {
+        ImGui::End();
+        return;
+    }
+
+    if (mShownStep == 0) {
+        ImGui::Text("Waiting for a frame");
+        ImGui::End();
+        return;
+    }
+
+    float width = std::max(ImGui::GetContentRegionAvail().x, 64.f);
+    auto image = [&](const sf::Texture& texture) {
+        sf::Vector2f size(texture.getSize());
+
+        ImGui::Image(texture, {width, width * size.y / size.x});
+    };
+
+    if (ImGui::BeginTabBar("##Scopes")) {
+        if (ImGui::BeginTabItem("Histogram")) {
+            image(mHistogram);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Waveform")) {
+            image(mWaveform);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Parade")) {
+            image(mParade);
+            ImGui::EndTabItem();
+        }
+        if (ImGui::BeginTabItem("Vectorscope")) {
+            image(mVectorscope);
+            ImGui::EndTabItem();
+        }
+        ImGui::EndTabBar();
+    }
+
+    ImGui::Text("Sampling 1/%u, %.1f ms", mShownStep, mShownSeconds * 1000.0);
+    ImGui::End();
+}
+
+} // namespace Moon
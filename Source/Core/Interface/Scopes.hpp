@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/System/SerialTask.hpp"
+#include <SFML/Graphics.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Histogram, waveform, RGB parade and vectorscope panels
+///
+/// Frames are analyzed from their decoded YUV planes when they kept them,
+/// from their RGBA pixels otherwise, by a background scheduler task that
+/// only ever looks at the latest submitted frame. The task also renders
+/// the plots, so the main thread only uploads four small textures.
+///
+/// Pixels are sampled every `step` columns and rows; the step doubles when
+/// analyzing a frame exceeds TIME_BUDGET and halves when well below it.
+///
+/// Only the YUV to RGB conversion of a row has an AVX2 path. Counting stays
+/// scalar: every sample increments a bin picked by its own value, and AVX2
+/// has no scatter to do that, nor a cheap way around two samples hitting
+/// the same bin. The step keeps that part within the budget instead.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Scopes
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr Uint32 LEVELS = 256;
+    static constexpr Uint32 COLUMNS = 256;
+    static constexpr Uint32 HISTOGRAM_HEIGHT = 128;
+    static constexpr Uint32 MAX_STEP = 16;
+    static constexpr double TIME_BUDGET = 0.004;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Fixed point YUV to RGB matrix, scaled by 1024
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Coefficients
+    {
+        int yOffset;
+        int yScale;
+        int rv;
+        int gu;
+        int gv;
+        int bu;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Plots rendered by the task, RGBA
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Plots
+    {
+        Vector<Uint8> histogram;
+        Vector<Uint8> waveform;
+        Vector<Uint8> parade;
+        Vector<Uint8> vectorscope;
+        Uint32 step;
+        double seconds;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Counts accumulated over the samples of a frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Counts
+    {
+        Array<Array<Uint32, LEVELS>, 4> histograms;
+        Vector<Uint32> waveform;
+        Vector<Uint32> parade;
+        Vector<Uint32> vectorscope;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Mutex mMutex;
+    SharedPtr<VideoFrame> mPending;
+    UniquePtr<Plots> mReady;
+    bool mAnalyzing;
+    Atomic<bool> mStop{false};
+
+    Counts mCounts;
+    Uint32 mStep;
+    Vector<Uint8> mRow[6];
+    Vector<Uint32> mColumns;
+
+    sf::Texture mHistogram;
+    sf::Texture mWaveform;
+    sf::Texture mParade;
+    sf::Texture mVectorscope;
+    Uint32 mShownStep;
+    double mShownSeconds;
+
+    SerialTask mTask{
+        TaskScheduler::Priority::Background, [this]{ Work(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Scopes(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~Scopes();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, analyzes the latest frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Fill the counts from the samples of a frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Analyze(const VideoFrame& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Add the samples gathered in the row buffers to the counts
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Accumulate(size_t count);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Render the counts into RGBA plots
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Render(Plots& plots) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Matrix matching the colorimetry of a decoded picture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static Coefficients GetCoefficients(const AVFrame* picture);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Analyze a frame, replacing any frame still waiting
+    ///
+    /// \param frame Frame just presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Submit(const SharedPtr<VideoFrame>& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Upload the plots rendered since the last call
+    ///
+    /// Must be called from the thread owning the OpenGL context.
+    ///
+    /// \return True if the textures changed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True while a submitted frame is not uploaded yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPending(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draw the scopes window
+    ///
+    /// \param open Cleared when the window is closed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Draw(bool* open);
+};
+
+} // namespace Moon
@@ -0,0 +1,264 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/Spectrum.hpp"
+#include <imgui.h>
+#include <imgui-SFML.h>
+#include <cmath>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Dark to bright palette, position in [0, 1] to RGB
+///
+///////////////////////////////////////////////////////////////////////////////
+static void MapColor(float position, Uint8* pixel)
+{
+    static constexpr float STOPS[][3] = {
+        {0.f, 0.f, 0.f},
+        {40.f, 10.f, 90.f},
+        {180.f, 40.f, 90.f},
+        {250.f, 140.f, 30.f},
+        {255.f, 255.f, 200.f}
+    };
+    static constexpr int LAST = 4;
+
+    float scaled = std::clamp(position, 0.f, 1.f) * LAST;
+    int index = std::min(static_cast<int>(scaled), LAST - 1);
+    float blend = scaled - static_cast<float>(index);
+
+    for (int c = 0; c < 3; c++) {
+        pixel[c] = static_cast<Uint8>(STOPS[index][c] +
+            (STOPS[index + 1][c] - STOPS[index][c]) * blend);
+    }
+    pixel[3] = 255;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Spectrum::Spectrum(void)
+    : mTap(std::make_shared<SampleRing>(TAP_CAPACITY))
+    , mTransform(nullptr)
+    , mTransformFunction(nullptr)
+    , mWindow(FFT_SIZE)
+    , mFrame(FFT_SIZE, 0.f)
+    , mInput(FFT_SIZE)
+    , mOutput(FFT_SIZE / 2 + 1)
+    , mHop(HOP)
+    , mHopFilled(0)
+    , mBandRate(0)
+    , mScale(1.f)
+    , mLevels(ROWS, MIN_DB)
+    , mColumn(0)
+    , mShownLevels(ROWS, MIN_DB)
+{
+    float scale = 1.f;
+    float sum = 0.f;
+
+    if (av_tx_init(&mTransform, &mTransformFunction, AV_TX_FLOAT_RDFT, 0,
+        FFT_SIZE, &scale, 0) < 0
+    ) {
+        std::cerr << "Could not create the spectrum FFT" << std::endl;
+    }
+
+    for (int i = 0; i < FFT_SIZE; i++) {
+        mWindow[i] = static_cast<float>(
+            0.5 - 0.5 * std::cos(2.0 * M_PI * i / FFT_SIZE));
+        sum += mWindow[i];
+    }
+
+    // A full scale sine reads 0 dB
+    mScale = 4.f / (sum * sum);
+
+    if (!mTexture.resize({COLUMNS, ROWS})) {
+        std::cerr << "Could not create spectrogram texture" << std::endl;
+        return;
+    }
+
+    Vector<Uint8> black(COLUMNS * ROWS * 4, 0);
+
+    for (size_t i = 3; i < black.size(); i += 4) {
+        black[i] = 255;
+    }
+    mTexture.update(black.data());
+    mTexture.setRepeated(true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Spectrum::~Spectrum()
+{
+    mStop = true;
+    mTask.Stop();
+    av_tx_uninit(&mTransform);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Spectrum::MapBands(int sampleRate)
+{
+    double nyquist = sampleRate / 2.0;
+    double ratio = nyquist / MIN_FREQUENCY;
+    int bins = FFT_SIZE / 2 + 1;
+
+    mBands.resize(ROWS);
+
+    for (Uint32 band = 0; band < ROWS; band++) {
+        double low = MIN_FREQUENCY * std::pow(ratio,
+            static_cast<double>(band) / ROWS);
+        double high = MIN_FREQUENCY * std::pow(ratio,
+            static_cast<double>(band + 1) / ROWS);
+        int first = static_cast<int>(low / sampleRate * FFT_SIZE);
+        int last = static_cast<int>(std::ceil(high / sampleRate * FFT_SIZE));
+
+        // Low bands are narrower than a bin, they repeat its level
+        first = std::min(first, bins - 1);
+        mBands[band] = {first, std::clamp(last, first + 1, bins)};
+    }
+    mBandRate = sampleRate;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Spectrum::Analyze(Vector<float>& levels)
+{
+    for (int i = 0; i < FFT_SIZE; i++) {
+        mInput[i] = mFrame[i] * mWindow[i];
+    }
+
+    mTransformFunction(mTransform, mOutput.data(), mInput.data(),
+        sizeof(float));
+
+    for (Uint32 band = 0; band < ROWS; band++) {
+        float power = 0.f;
+
+        for (int bin = mBands[band].first; bin < mBands[band].second; bin++) {
+            const AVComplexFloat& value = mOutput[bin];
+
+            power = std::max(power, value.re * value.re + value.im * value.im);
+        }
+
+        levels[band] = std::max(MIN_DB,
+            10.f * std::log10(power * mScale + 1e-12f));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Spectrum::Work(void)
+{
+    if (!mTransform) {
+        return;
+    }
+
+    Vector<float> levels(ROWS);
+    Vector<Uint8> column(ROWS * 4);
+
+    while (!mStop) {
+        mHopFilled += mTap->Read(mHop.data() + mHopFilled, HOP - mHopFilled);
+        if (mHopFilled < HOP) {
+            return;
+        }
+        mHopFilled = 0;
+
+        std::memmove(mFrame.data(), mFrame.data() + HOP,
+            (FFT_SIZE - HOP) * sizeof(float));
+        std::memcpy(mFrame.data() + FFT_SIZE - HOP, mHop.data(),
+            HOP * sizeof(float));
+
+        if (mSampleRate != mBandRate) {
+            MapBands(mSampleRate);
+        }
+        Analyze(levels);
+
+        // Highest band on the top row
+        for (Uint32 band = 0; band < ROWS; band++) {
+            MapColor((levels[band] - MIN_DB) / (MAX_DB - MIN_DB),
+                &column[(ROWS - 1 - band) * 4]);
+        }
+
+        std::unique_lock<Mutex> lock(mMutex);
+        size_t size = column.size();
+
+        // Columns older than the whole width would be overwritten anyway
+        if (mPending.size() >= COLUMNS * size) {
+            mPending.erase(mPending.begin(), mPending.begin() + size);
+        }
+        mPending.insert(mPending.end(), column.begin(), column.end());
+        mLevels = levels;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<SampleRing>& Spectrum::GetTap(void) const
+{
+    return (mTap);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Spectrum::SetSampleRate(int sampleRate)
+{
+    mSampleRate = std::max(sampleRate, 1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Spectrum::Update(void)
+{
+    Vector<Uint8> columns;
+
+    if (mTap->GetAvailable() > 0) {
+        mTask.Wake();
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        columns.swap(mPending);
+        mShownLevels = mLevels;
+    }
+
+    size_t size = ROWS * 4;
+
+    for (size_t offset = 0; offset < columns.size(); offset += size) {
+        mTexture.update(columns.data() + offset, {1, ROWS}, {mColumn, 0});
+        mColumn = (mColumn + 1) % COLUMNS;
+    }
+    return (!columns.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Spectrum::IsPending(void)
+{
+    if (mTap->GetAvailable() >= static_cast<size_t>(HOP)) {
+        return (true);
+    }
+
+    std::unique_lock<Mutex> lock(mMutex);
+    return (!mPending.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Spectrum::Draw(bool* open)
+{
+    if (!ImGui::Begin("Spectrum", open)) {
+        ImGui::End();
+        return;
+    }
+
+    float width = std::max(ImGui::GetContentRegionAvail().x, 64.f);
+
+    ImGui::PlotLines("##Spectrum", mShownLevels.data(),
+        static_cast<int>(mShownLevels.size()), 0, nullptr, MIN_DB, MAX_DB,
+        {width, 96.f});
+
+    // The texture repeats, starting at the oldest column scrolls it
+    sf::Sprite sprite(mTexture, sf::IntRect(
+        {static_cast<int>(mColumn), 0},
+        {static_cast<int>(COLUMNS), static_cast<int>(ROWS)}));
+
+    ImGui::Image(sprite, {width, width * ROWS / COLUMNS});
+    ImGui::Text("%d Hz, %d point FFT, %.0f Hz to %.0f Hz", mSampleRate.load(),
+        FFT_SIZE, MIN_FREQUENCY, mSampleRate / 2.0);
+    ImGui::End();
+}
+
+} // namespace Moon
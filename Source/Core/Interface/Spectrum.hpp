@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/SampleRing.hpp"
+#include "Core/System/SerialTask.hpp"
+#include <SFML/Graphics.hpp>
+extern "C" {
+    #include <libavutil/tx.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Spectrum and scrolling spectrogram of the audio being played
+///
+/// The samples come from a SampleRing tapped on the audio output. A
+/// background task runs a Hann windowed real FFT every HOP samples and
+/// turns it into one spectrogram column of ROWS log spaced bands. The
+/// main thread uploads only the new columns into a wrapping texture, the
+/// oldest column being overwritten, and the panel draws it from the
+/// current write position so the history scrolls without a redraw.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Spectrum
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int FFT_SIZE = 2048;
+    static constexpr int HOP = 1024;
+    static constexpr Uint32 COLUMNS = 512;
+    static constexpr Uint32 ROWS = 256;
+    static constexpr size_t TAP_CAPACITY = 1 << 16;
+    static constexpr double MIN_FREQUENCY = 20.0;
+    static constexpr float MIN_DB = -90.f;
+    static constexpr float MAX_DB = 0.f;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<SampleRing> mTap;
+    Atomic<int> mSampleRate{48000};
+    Atomic<bool> mStop{false};
+
+    AVTXContext* mTransform;
+    av_tx_fn mTransformFunction;
+    Vector<float> mWindow;
+    Vector<float> mFrame;
+    Vector<float> mInput;
+    Vector<AVComplexFloat> mOutput;
+    Vector<float> mHop;
+    size_t mHopFilled;
+    Vector<Pair<int, int>> mBands;
+    int mBandRate;
+    float mScale;
+
+    Mutex mMutex;
+    Vector<Uint8> mPending;
+    Vector<float> mLevels;
+
+    sf::Texture mTexture;
+    Uint32 mColumn;
+    Vector<float> mShownLevels;
+
+    SerialTask mTask{
+        TaskScheduler::Priority::Background, [this]{ Work(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Spectrum(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~Spectrum();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, turns every complete hop of samples into a column
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief FFT bins of each band at a sample rate
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void MapBands(int sampleRate);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Transform the current frame into band levels in dB
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Analyze(Vector<float>& levels);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Ring to attach to the audio output
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<SampleRing>& GetTap(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param sampleRate Rate of the samples written to the tap
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetSampleRate(int sampleRate);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Analyze the samples tapped so far and upload the new columns
+    ///
+    /// Must be called from the thread owning the OpenGL context.
+    ///
+    /// \return True if the texture changed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True while tapped samples or columns wait to be shown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPending(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draw the spectrum window
+    ///
+    /// \param open Cleared when the window is closed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Draw(bool* open);
+};
+
+} // namespace Moon
@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/Timeline.hpp"
+#include <imgui.h>
+#include <imgui-SFML.h>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static void DrawMarkers(
+    const MediaAnalysis& analysis,
+    double duration,
+    ImVec2 origin,
+    ImVec2 size
+)
+{
+    if (duration <= 0.0) {
+        return;
+    }
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    MediaAnalysis::Results results = analysis.GetResults();
+    float bottom = origin.y + size.y;
+
+    auto toX = [&](double seconds) {
+        return (origin.x + size.x *
+            static_cast<float>(std::clamp(seconds / duration, 0.0, 1.0)));
+    };
+
+    for (const MediaAnalysis::Range& black : results.blacks) {
+        drawList->AddRectFilled(ImVec2(toX(black.start), origin.y),
+            ImVec2(toX(black.end), bottom), IM_COL32(0, 0, 0, 160));
+    }
+
+    for (const MediaAnalysis::Range& silence : results.silences) {
+        drawList->AddRectFilled(
+            ImVec2(toX(silence.start), bottom - Timeline::SILENCE_HEIGHT),
+            ImVec2(toX(silence.end), bottom), IM_COL32(90, 160, 255, 200));
+    }
+
+    for (double scene : results.scenes) {
+        float x = toX(scene);
+
+        drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, bottom),
+            IM_COL32(255, 200, 60, 220));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Timeline::Timeline(void)
+    : mDragging(false)
+    , mDragTime(0.0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+String Timeline::FormatTime(double seconds)
+{
+    Int64 total = static_cast<Int64>(std::max(0.0, seconds));
+    char buffer[32];
+
+    if (total >= 3600) {
+        std::snprintf(buffer, sizeof(buffer), "%d:%02d:%02d",
+            static_cast<int>(total / 3600), static_cast<int>(total / 60 % 60),
+            static_cast<int>(total % 60));
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%02d:%02d",
+            static_cast<int>(total / 60), static_cast<int>(total % 60));
+    }
+    return (buffer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Timeline::Draw(
+    VideoPlayer& player,
+    ThumbnailProvider* thumbnails,
+    const MediaAnalysis* analysis
+)
+{
+    double duration = player.GetDuration();
+    double current = mDragging ? mDragTime : player.GetCurrentTime();
+
+    ImGui::Text("%s / %s", FormatTime(current).c_str(),
+        FormatTime(duration).c_str());
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 1.f), BAR_HEIGHT);
+
+    ImGui::InvisibleButton("##Timeline", size);
+
+    bool hovered = ImGui::IsItemHovered();
+    bool active = ImGui::IsItemActive();
+    float mouse = std::clamp(
+        (ImGui::GetIO().MousePos.x - origin.x) / size.x, 0.f, 1.f);
+    double target = duration * mouse;
+
+    if (active) {
+        mDragging = true;
+        mDragTime = target;
+    } else if (mDragging) {
+        mDragging = false;
+        player.Seek(mDragTime);
+    }
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    float progress = duration > 0.0
+        ? static_cast<float>(std::clamp(current / duration, 0.0, 1.0)) : 0.f;
+    ImVec2 end(origin.x + size.x, origin.y + size.y);
+
+    drawList->AddRectFilled(origin, end,
+        ImGui::GetColorU32(ImGuiCol_FrameBg), 3.f);
+    drawList->AddRectFilled(origin,
+        ImVec2(origin.x + size.x * progress, end.y),
+        ImGui::GetColorU32(ImGuiCol_SliderGrabActive), 3.f);
+
+    if (analysis) {
+        DrawMarkers(*analysis, duration, origin, size);
+    }
+
+    if (!hovered && !active) {
+        return;
+    }
+
+    float x = origin.x + size.x * mouse;
+    drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, end.y),
+        ImGui::GetColorU32(ImGuiCol_Text));
+
+    ImGui::BeginTooltip();
+    if (thumbnails) {
+        Optional<sf::IntRect> rect = thumbnails->Request(target);
+
+        if (rect) {
+            sf::Sprite thumbnail(thumbnails->GetTexture(), *rect);
+            sf::Vector2u thumbnailSize = thumbnails->GetThumbnailSize();
+
+            ImGui::Image(thumbnail, sf::Vector2f(
+                static_cast<float>(thumbnailSize.x),
+                static_cast<float>(thumbnailSize.y)
+            ));
+        }
+    }
+    ImGui::TextUnformatted(FormatTime(target).c_str());
+    ImGui::EndTooltip();
+}
+
+} // namespace Moon
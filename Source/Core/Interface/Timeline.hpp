@@ -0,0 +1,76 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoPlayer.hpp"
+#include "Core/Player/ThumbnailProvider.hpp"
+#include "Core/Player/MediaAnalysis.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief ImGui seek bar with a thumbnail preview under the mouse
+///
+/// When the file has been analyzed, black ranges shade the bar, silences
+/// are underlined and scene cuts are drawn as ticks.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Timeline
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr float BAR_HEIGHT = 14.f;
+    static constexpr float SILENCE_HEIGHT = 3.f;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    bool mDragging;
+    double mDragTime;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Timeline(void);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Format a position as [h:]mm:ss
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static String FormatTime(double seconds);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draw the seek bar in the current ImGui window
+    ///
+    /// The player is only seeked once the mouse button is released, the
+    /// thumbnails give the feedback while dragging.
+    ///
+    /// \param player Player to control
+    /// \param thumbnails Preview source, may be nullptr
+    /// \param analysis Markers source, may be nullptr
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Draw(
+        VideoPlayer& player,
+        ThumbnailProvider* thumbnails,
+        const MediaAnalysis* analysis
+    );
+};
+
+} // namespace Moon
@@ -0,0 +1,207 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/VideoWall.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+VideoWall::VideoWall(const Vector<Path>& files, sf::Vector2u cellSize)
+    : mCellSize(cellSize)
+    , mColumns(0)
+    , mRows(0)
+    , mVertices(sf::PrimitiveType::Triangles)
+    , mPlaying(false)
+{
+    TaskScheduler& scheduler = TaskScheduler::GetInstance();
+    Vector<UniquePtr<Source>> sources(files.size());
+    Vector<std::future<void>> tasks;
+
+    for (size_t i = 0; i < files.size(); i++) {
+        tasks.push_back(scheduler.Submit(
+            TaskScheduler::Priority::Interactive, [&, i]{
+                auto source = std::make_unique<Source>(files[i]);
+
+                // The scheduler spreads the tiles over the cores, a codec
+                // thread pool per tile would only oversubscribe them
+                source->options.threads = 1;
+                source->options.minWidth = static_cast<int>(mCellSize.x);
+                source->maxWidth = mCellSize.x;
+                source->maxHeight = mCellSize.y;
+
+                if (source->Open(nullptr, PREDECODED_FRAMES)) {
+                    sources[i] = std::move(source);
+                }
+            }
+        ));
+    }
+
+    for (auto& task : tasks) {
+        task.wait();
+    }
+
+    for (size_t i = 0; i < files.size(); i++) {
+        if (!sources[i]) {
+            std::cerr << "Could not open " << files[i] << std::endl;
+            continue;
+        }
+
+        Tile tile = {files[i], nullptr, {0U, 0U}};
+
+        tile.player = std::make_unique<VideoPlayer>(std::move(sources[i]));
+        tile.player->SetFrameCacheBudget(STEP_CACHE_BUDGET);
+        tile.player->SetDropLateFrames(true);
+        mTiles.push_back(std::move(tile));
+    }
+
+    if (mTiles.empty()) {
+        return;
+    }
+
+    mColumns = static_cast<Uint32>(
+        std::ceil(std::sqrt(static_cast<double>(mTiles.size()))));
+    mRows = static_cast<Uint32>((mTiles.size() + mColumns - 1) / mColumns);
+
+    if (!mAtlas.resize({mCellSize.x * mColumns, mCellSize.y * mRows})) {
+        std::cerr << "Could not create video wall texture" << std::endl;
+        return;
+    }
+    mAtlas.setSmooth(true);
+
+    // Uninitialized texture memory would show in cells without a frame
+    Vector<Uint8> black(
+        static_cast<size_t>(mAtlas.getSize().x) * mAtlas.getSize().y * 4, 0);
+
+    for (size_t i = 3; i < black.size(); i += 4) {
+        black[i] = 255;
+    }
+    mAtlas.update(black.data());
+
+    for (size_t i = 0; i < mTiles.size(); i++) {
+        Tile& tile = mTiles[i];
+
+        tile.position = {
+            static_cast<Uint32>(i % mColumns) * mCellSize.x,
+            static_cast<Uint32>(i / mColumns) * mCellSize.y
+        };
+        tile.player->SetTarget(&mAtlas, tile.position);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoWall::Update(void)
+{
+    bool presented = false;
+
+    for (Tile& tile : mTiles) {
+        presented = tile.player->Update() || presented;
+    }
+    return (presented);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double VideoWall::GetNextUpdateDelay(void) const
+{
+    double delay = std::numeric_limits<double>::infinity();
+
+    for (const Tile& tile : mTiles) {
+        delay = std::min(delay, tile.player->GetNextUpdateDelay());
+    }
+    return (delay);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoWall::Draw(sf::RenderTarget& target, const sf::FloatRect& area)
+{
+    if (mTiles.empty()) {
+        return;
+    }
+
+    sf::Vector2f cell(area.size.x / mColumns, area.size.y / mRows);
+
+    mVertices.resize(mTiles.size() * 6);
+
+    for (size_t i = 0; i < mTiles.size(); i++) {
+        const Tile& tile = mTiles[i];
+        sf::Vector2f frame(tile.player->GetFrameSize());
+        float scale = frame.x > 0.f && frame.y > 0.f
+            ? std::min(cell.x / frame.x, cell.y / frame.y) : 0.f;
+        sf::Vector2f size = frame * scale;
+        sf::Vector2f origin(
+            area.position.x + (i % mColumns) * cell.x + (cell.x - size.x) / 2,
+            area.position.y + (i / mColumns) * cell.y + (cell.y - size.y) / 2
+        );
+        sf::Vector2f texture(tile.position);
+        sf::Vertex* quad = &mVertices[i * 6];
+
+        quad[0] = {origin, sf::Color::White, texture};
+        quad[1] = {origin + sf::Vector2f(size.x, 0.f), sf::Color::White,
+            texture + sf::Vector2f(frame.x, 0.f)};
+        quad[2] = {origin + sf::Vector2f(0.f, size.y), sf::Color::White,
+            texture + sf::Vector2f(0.f, frame.y)};
+        quad[3] = quad[2];
+        quad[4] = quad[1];
+        quad[5] = {origin + size, sf::Color::White, texture + frame};
+    }
+
+    target.draw(mVertices, &mAtlas);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoWall::Play(void)
+{
+    mPlaying = true;
+    for (Tile& tile : mTiles) {
+        tile.player->Play();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoWall::Pause(void)
+{
+    mPlaying = false;
+    for (Tile& tile : mTiles) {
+        tile.player->Pause();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoWall::TogglePause(void)
+{
+    if (mPlaying) {
+        Pause();
+    } else {
+        Play();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t VideoWall::GetCount(void) const
+{
+    return (mTiles.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u VideoWall::GetGridSize(void) const
+{
+    return (sf::Vector2u(mColumns, mRows));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const VideoPlayer& VideoWall::GetPlayer(size_t index) const
+{
+    return (*mTiles[index].player);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Path& VideoWall::GetFilePath(size_t index) const
+{
+    return (mTiles[index].filePath);
+}
+
+} // namespace Moon
@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Source.hpp"
+#include "Core/Player/VideoPlayer.hpp"
+#include <SFML/Graphics.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Grid of players composited in a single draw call
+///
+/// Every player decodes at the size of its cell, with one codec thread, and
+/// presents straight into its region of a shared atlas texture. The decode
+/// tasks of all the tiles are balanced by the task scheduler, and the whole
+/// grid is drawn as one vertex array over the atlas.
+///
+///////////////////////////////////////////////////////////////////////////////
+class VideoWall
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr Uint32 DEFAULT_CELL_WIDTH = 480;
+    static constexpr Uint32 DEFAULT_CELL_HEIGHT = 270;
+    static constexpr Uint64 STEP_CACHE_BUDGET = 32ULL * 1024 * 1024;
+    static constexpr size_t PREDECODED_FRAMES = 2;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct Tile
+    {
+        Path filePath;
+        UniquePtr<VideoPlayer> player;
+        sf::Vector2u position;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u mCellSize;
+    Uint32 mColumns;
+    Uint32 mRows;
+    Vector<Tile> mTiles;
+    sf::Texture mAtlas;
+    sf::VertexArray mVertices;
+    bool mPlaying;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open every file, in parallel
+    ///
+    /// Files that cannot be opened are reported and left out of the grid.
+    ///
+    /// \param files Media files, one per tile
+    /// \param cellSize Size the tiles are decoded at
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    VideoWall(
+        const Vector<Path>& files,
+        sf::Vector2u cellSize = {DEFAULT_CELL_WIDTH, DEFAULT_CELL_HEIGHT}
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief The tiles keep a pointer to the atlas
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    VideoWall(const VideoWall&) = delete;
+    VideoWall& operator=(const VideoWall&) = delete;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Update every player
+    ///
+    /// \return True if any tile presented a new frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Seconds until the earliest tile needs an update
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetNextUpdateDelay(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draw the grid, each tile letterboxed in its cell
+    ///
+    /// \param target Render target
+    /// \param area Region of the target covered by the grid
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Draw(sf::RenderTarget& target, const sf::FloatRect& area);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Play(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Pause(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void TogglePause(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of tiles
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetCount(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of columns and rows of the grid
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u GetGridSize(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param index Tile index
+    ///
+    /// \return Player of the tile
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const VideoPlayer& GetPlayer(size_t index) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param index Tile index
+    ///
+    /// \return Media file of the tile
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Path& GetFilePath(size_t index) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Interface/WaveformStrip.hpp"
+#include <imgui.h>
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+WaveformStrip::WaveformStrip(void)
+    : mViewStart(0.0)
+    , mViewLength(0.0)
+    , mDragged(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void WaveformStrip::Draw(VideoPlayer& player, const AudioPeaks& peaks)
+{
+    double duration = player.GetDuration();
+
+    if (duration <= 0.0) {
+        return;
+    }
+
+    if (mViewLength <= 0.0 || mViewLength > duration) {
+        mViewLength = duration;
+    }
+
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImVec2 size(std::max(ImGui::GetContentRegionAvail().x, 1.f), STRIP_HEIGHT);
+
+    ImGui::InvisibleButton("##Waveform", size);
+    ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
+
+    const ImGuiIO& io = ImGui::GetIO();
+    double mouse = std::clamp(
+        static_cast<double>((io.MousePos.x - origin.x) / size.x), 0.0, 1.0);
+    double current = player.GetCurrentTime();
+
+    if (ImGui::IsItemHovered() && io.MouseWheel != 0.f) {
+        double anchor = mViewStart + mouse * mViewLength;
+
+        mViewLength = std::clamp(
+            mViewLength * std::pow(ZOOM_STEP, -io.MouseWheel),
+            std::min(MIN_VIEW_LENGTH, duration), duration);
+        mViewStart = anchor - mouse * mViewLength;
+    }
+
+    if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left)) {
+        mViewStart -= io.MouseDelta.x / size.x * mViewLength;
+        mDragged = true;
+    } else if (ImGui::IsItemDeactivated()) {
+        if (!mDragged) {
+            player.Seek(mViewStart + mouse * mViewLength);
+        }
+        mDragged = false;
+    } else if (!ImGui::IsItemActive() && player.IsPlaying() && (
+        current < mViewStart || current > mViewStart + mViewLength)
+    ) {
+        mViewStart = current;
+    }
+
+    mViewStart = std::clamp(mViewStart, 0.0, duration - mViewLength);
+
+    // One column per pixel, the peaks come from the matching level
+    mColumns.resize(static_cast<size_t>(size.x));
+    peaks.GetPeaks(mViewStart, mViewStart + mViewLength, mColumns);
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 end(origin.x + size.x, origin.y + size.y);
+    float middle = origin.y + size.y / 2.f;
+    float half = size.y / 2.f;
+    ImU32 peakColor = IM_COL32(70, 140, 200, 255);
+    ImU32 powerColor = IM_COL32(150, 210, 255, 255);
+
+    drawList->AddRectFilled(origin, end,
+        ImGui::GetColorU32(ImGuiCol_FrameBg), 3.f);
+
+    for (size_t i = 0; i < mColumns.size(); i++) {
+        const AudioPeaks::Peak& peak = mColumns[i];
+        float x = origin.x + static_cast<float>(i);
+        float rms = std::min(std::sqrt(peak.power), 1.f) * half;
+        float top = middle - std::clamp(peak.max, -1.f, 1.f) * half;
+        float bottom = middle - std::clamp(peak.min, -1.f, 1.f) * half;
+
+        drawList->AddRectFilled(ImVec2(x, top), ImVec2(x + 1.f, bottom + 1.f),
+            peakColor);
+        drawList->AddRectFilled(ImVec2(x, middle - rms),
+            ImVec2(x + 1.f, middle + rms + 1.f), powerColor);
+    }
+
+    if (current >= mViewStart && current <= mViewStart + mViewLength) {
+        float x = origin.x + size.x *
+            static_cast<float>((current - mViewStart) / mViewLength);
+
+        drawList->AddLine(ImVec2(x, origin.y), ImVec2(x, end.y),
+            ImGui::GetColorU32(ImGuiCol_Text));
+    }
+
+    if (!peaks.IsComplete()) {
+        char label[32];
+
+        std::snprintf(label, sizeof(label), "%.0f%%",
+            peaks.GetProgress() * 100.0);
+        drawList->AddText(ImVec2(origin.x + 4.f, origin.y + 2.f),
+            ImGui::GetColorU32(ImGuiCol_Text), label);
+    }
+}
+
+} // namespace Moon
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoPlayer.hpp"
+#include "Core/Player/AudioPeaks.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief ImGui audio waveform under the seek bar
+///
+/// The mouse wheel zooms around the pointer, dragging scrolls and a click
+/// seeks. While playing, a zoomed view pages along with the playhead.
+///
+///////////////////////////////////////////////////////////////////////////////
+class WaveformStrip
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr float STRIP_HEIGHT = 48.f;
+    static constexpr double ZOOM_STEP = 1.25;
+    static constexpr double MIN_VIEW_LENGTH = 0.05;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    double mViewStart;
+    double mViewLength;
+    bool mDragged;
+    Vector<AudioPeaks::Peak> mColumns;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    WaveformStrip(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Draw the waveform in the current ImGui window
+    ///
+    /// \param player Player to control
+    /// \param peaks Peaks of the file played
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Draw(VideoPlayer& player, const AudioPeaks& peaks);
+};
+
+} // namespace Moon
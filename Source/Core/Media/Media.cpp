@@ -25,6 +25,14 @@ Media::Media(const Path& filePath)
     ParseFile();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+Media::Media(const Path& filePath, const AVFormatContext* formatContext)
+    : filePath(filePath)
+    , fullFilePath(std::filesystem::absolute(filePath))
+{
+    ParseContext(formatContext);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 Media::~Media()
 {
@@ -49,6 +57,13 @@ void Media::ParseFile(void)
         return;
     }
 
+    ParseContext(formatContext);
+    avformat_close_input(&formatContext);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Media::ParseContext(const AVFormatContext* formatContext)
+{
     duration = static_cast<Uint64>(formatContext->duration / AV_TIME_BASE);
     bitrate = static_cast<Uint64>(formatContext->bit_rate);
 
@@ -130,8 +145,6 @@ void Media::ParseFile(void)
             streams.push_back(subtitle);
         }
     }
-
-    avformat_close_input(&formatContext);
 }
 
 } // namespace Moon
@@ -8,6 +8,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "Core/Config/Config.hpp"
 #include "Core/Media/Stream.hpp"
+extern "C" {
+    #include <libavformat/avformat.h>
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 // Namespace Moon
@@ -41,6 +44,16 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     explicit Media(const Path& filePath);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Describe a file that is already opened and probed
+    ///
+    /// \param filePath
+    /// \param formatContext Context the description is read from, it is
+    ///                      neither kept nor closed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Media(const Path& filePath, const AVFormatContext* formatContext);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
     ///
@@ -53,6 +66,14 @@ private:
     ///
     ///////////////////////////////////////////////////////////////////////////
     void ParseFile(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param formatContext
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ParseContext(const AVFormatContext* formatContext);
 };
 
 } // namespace Moon
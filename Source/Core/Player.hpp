@@ -0,0 +1,30 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/AudioDecoder.hpp"
+#include "Core/Player/ToneMap.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/Player/FilterGraph.hpp"
+#include "Core/Player/ColorLut.hpp"
+#include "Core/Player/FrameCache.hpp"
+#include "Core/Player/ReversePlayback.hpp"
+#include "Core/Player/FrameStepper.hpp"
+#include "Core/Player/ThumbnailProvider.hpp"
+#include "Core/Player/MediaAnalysis.hpp"
+#include "Core/Player/AudioPeaks.hpp"
+#include "Core/Player/LoudnessScan.hpp"
+#include "Core/Player/TimeStretch.hpp"
+#include "Core/Player/AudioOutput.hpp"
+#include "Core/Player/Source.hpp"
+#include "Core/Player/Playlist.hpp"
+#include "Core/Player/Loader.hpp"
+#include "Core/Player/VideoPlayer.hpp"
+#include "Core/Player/ComparePlayer.hpp"
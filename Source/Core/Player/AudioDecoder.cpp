@@ -0,0 +1,379 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/AudioDecoder.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+AudioDecoder::AudioDecoder(void)
+    : mFormatContext(nullptr)
+    , mCodecContext(nullptr)
+    , mResampler(nullptr)
+    , mPacket(nullptr)
+    , mFrame(nullptr)
+    , mStreamIndex(-1)
+    , mSampleRate(0)
+    , mChannels(0)
+    , mLayout{}
+    , mStartPts(0)
+    , mEndOfFile(false)
+    , mResync(true)
+    , mTimestamp(0.0)
+    , mChunkTimestamp(0.0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioDecoder::~AudioDecoder()
+{
+    Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioDecoder::Open(const Path& filePath)
+{
+    return (Open(filePath, Options()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioDecoder::Open(const Path& filePath, const Options& options)
+{
+    Close();
+    mOptions = options;
+
+    if (avformat_open_input(
+        &mFormatContext, filePath.c_str(), nullptr, nullptr) != 0
+    ) {
+        std::cerr << "Could not open input file: " << filePath << std::endl;
+        return (false);
+    }
+
+    if (avformat_find_stream_info(mFormatContext, nullptr) < 0) {
+        std::cerr << "Could not find stream information" << std::endl;
+        Close();
+        return (false);
+    }
+
+    int streamIndex = mOptions.streamIndex;
+
+    if (streamIndex < 0) {
+        streamIndex = av_find_best_stream(
+            mFormatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    }
+
+    // Files without sound are common, not worth an error message
+    if (streamIndex < 0 ||
+        streamIndex >= static_cast<int>(mFormatContext->nb_streams) ||
+        mFormatContext->streams[streamIndex]->codecpar->codec_type !=
+        AVMEDIA_TYPE_AUDIO
+    ) {
+        Close();
+        return (false);
+    }
+
+    AVStream* stream = mFormatContext->streams[streamIndex];
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+
+    if (!codec) {
+        std::cerr << "Could not find audio decoder" << std::endl;
+        Close();
+        return (false);
+    }
+
+    mCodecContext = avcodec_alloc_context3(codec);
+
+    if (!mCodecContext ||
+        avcodec_parameters_to_context(mCodecContext, stream->codecpar) < 0
+    ) {
+        std::cerr << "Could not allocate audio codec context" << std::endl;
+        Close();
+        return (false);
+    }
+
+    mCodecContext->pkt_timebase = stream->time_base;
+
+    if (avcodec_open2(mCodecContext, codec, nullptr) < 0) {
+        std::cerr << "Could not open audio codec" << std::endl;
+        Close();
+        return (false);
+    }
+
+    mPacket = av_packet_alloc();
+    mFrame = av_frame_alloc();
+
+    if (!mPacket || !mFrame) {
+        std::cerr << "Could not allocate audio frame" << std::endl;
+        Close();
+        return (false);
+    }
+
+    for (unsigned int i = 0; i < mFormatContext->nb_streams; i++) {
+        mFormatContext->streams[i]->discard = static_cast<int>(i) ==
+            streamIndex ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    mStreamIndex = streamIndex;
+    mStartPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    mSampleRate = mOptions.sampleRate > 0
+        ? mOptions.sampleRate : mCodecContext->sample_rate;
+    mChannels = mOptions.channels > 0
+        ? mOptions.channels : mCodecContext->ch_layout.nb_channels;
+    mEndOfFile = false;
+    mResync = true;
+    mTimestamp = 0.0;
+    mChunkTimestamp = 0.0;
+
+    if (mSampleRate <= 0 || mChannels <= 0) {
+        std::cerr << "Invalid audio format" << std::endl;
+        Close();
+        return (false);
+    }
+
+    // Channels keep the order and names of the file unless they are mixed
+    const AVChannelLayout& layout = mCodecContext->ch_layout;
+
+    if (layout.order == AV_CHANNEL_ORDER_UNSPEC ||
+        layout.nb_channels != mChannels ||
+        av_channel_layout_copy(&mLayout, &layout) < 0
+    ) {
+        av_channel_layout_default(&mLayout, mChannels);
+    }
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioDecoder::Close(void)
+{
+    if (mResampler) {
+        swr_free(&mResampler);
+    }
+
+    if (mFrame) {
+        av_frame_free(&mFrame);
+    }
+
+    if (mPacket) {
+        av_packet_free(&mPacket);
+    }
+
+    if (mCodecContext) {
+        avcodec_free_context(&mCodecContext);
+    }
+
+    if (mFormatContext) {
+        avformat_close_input(&mFormatContext);
+    }
+
+    av_channel_layout_uninit(&mLayout);
+    mStreamIndex = -1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioDecoder::IsOpen(void) const
+{
+    return (mFormatContext && mCodecContext && mPacket && mFrame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioDecoder::OpenResampler(const AVFrame* frame)
+{
+    AVChannelLayout input;
+
+    // Some demuxers only know the channel count
+    if (frame->ch_layout.order == AV_CHANNEL_ORDER_UNSPEC) {
+        av_channel_layout_default(&input, frame->ch_layout.nb_channels);
+    } else if (av_channel_layout_copy(&input, &frame->ch_layout) < 0) {
+        return (false);
+    }
+
+    int ret = swr_alloc_set_opts2(&mResampler,
+        &mLayout, AV_SAMPLE_FMT_FLT, mSampleRate,
+        &input, static_cast<AVSampleFormat>(frame->format), frame->sample_rate,
+        0, nullptr);
+
+    av_channel_layout_uninit(&input);
+
+    if (ret < 0 || swr_init(mResampler) < 0) {
+        std::cerr << "Could not create audio resampler" << std::endl;
+        swr_free(&mResampler);
+        return (false);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioDecoder::Status AudioDecoder::Decode(Vector<float>& samples)
+{
+    samples.clear();
+
+    if (!IsOpen()) {
+        return (Status::Error);
+    }
+
+    while (true) {
+        int ret = avcodec_receive_frame(mCodecContext, mFrame);
+
+        if (ret == 0) {
+            if (!mResampler && !OpenResampler(mFrame)) {
+                av_frame_unref(mFrame);
+                return (Status::Error);
+            }
+
+            // Positions follow the sample count, only resynchronized to the
+            // timestamps after a seek
+            if (mResync) {
+                Int64 pts = mFrame->best_effort_timestamp;
+
+                if (pts != AV_NOPTS_VALUE) {
+                    mTimestamp = av_q2d(
+                        mFormatContext->streams[mStreamIndex]->time_base) *
+                        (pts - mStartPts);
+                }
+                mResync = false;
+            }
+
+            int capacity = swr_get_out_samples(mResampler, mFrame->nb_samples);
+            samples.resize(static_cast<size_t>(std::max(capacity, 0)) *
+                mChannels);
+
+            Uint8* output = reinterpret_cast<Uint8*>(samples.data());
+            int count = swr_convert(mResampler, &output, capacity,
+                const_cast<const Uint8**>(mFrame->extended_data),
+                mFrame->nb_samples);
+
+            av_frame_unref(mFrame);
+
+            if (count < 0) {
+                samples.clear();
+                return (Status::Error);
+            }
+            if (count == 0) {
+                continue;
+            }
+
+            samples.resize(static_cast<size_t>(count) * mChannels);
+            mChunkTimestamp = mTimestamp;
+            mTimestamp += static_cast<double>(count) / mSampleRate;
+            return (Status::Frame);
+        } else if (ret == AVERROR_EOF) {
+            // The resampler still holds its filter delay
+            int capacity = mResampler ? swr_get_out_samples(mResampler, 0) : 0;
+
+            if (capacity > 0) {
+                samples.resize(static_cast<size_t>(capacity) * mChannels);
+
+                Uint8* output = reinterpret_cast<Uint8*>(samples.data());
+                int count = swr_convert(
+                    mResampler, &output, capacity, nullptr, 0);
+
+                if (count > 0) {
+                    samples.resize(static_cast<size_t>(count) * mChannels);
+                    mChunkTimestamp = mTimestamp;
+                    mTimestamp += static_cast<double>(count) / mSampleRate;
+                    return (Status::Frame);
+                }
+                samples.clear();
+            }
+            return (Status::EndOfFile);
+        } else if (ret != AVERROR(EAGAIN)) {
+            return (Status::Error);
+        }
+
+        ret = av_read_frame(mFormatContext, mPacket);
+
+        if (ret < 0) {
+            if (ret != AVERROR_EOF && !avio_feof(mFormatContext->pb)) {
+                return (Status::Error);
+            }
+            if (mEndOfFile) {
+                return (Status::EndOfFile);
+            }
+            mEndOfFile = true;
+            avcodec_send_packet(mCodecContext, nullptr);
+            continue;
+        }
+
+        if (mPacket->stream_index == mStreamIndex) {
+            // Corrupted packets are dropped, the decoder resynchronizes
+            avcodec_send_packet(mCodecContext, mPacket);
+        }
+        av_packet_unref(mPacket);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioDecoder::Seek(double seconds)
+{
+    if (!IsOpen()) {
+        return (false);
+    }
+
+    AVStream* stream = mFormatContext->streams[mStreamIndex];
+    Int64 pts = mStartPts + static_cast<Int64>(
+        std::max(seconds, 0.0) / av_q2d(stream->time_base));
+
+    if (av_seek_frame(
+        mFormatContext, mStreamIndex, pts, AVSEEK_FLAG_BACKWARD) < 0
+    ) {
+        return (false);
+    }
+
+    avcodec_flush_buffers(mCodecContext);
+
+    // Buffered samples belong to the old position
+    if (mResampler) {
+        swr_free(&mResampler);
+    }
+
+    mEndOfFile = false;
+    mResync = true;
+    mTimestamp = std::max(seconds, 0.0);
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double AudioDecoder::GetTimestamp(void) const
+{
+    return (mChunkTimestamp);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AudioDecoder::GetSampleRate(void) const
+{
+    return (mSampleRate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AudioDecoder::GetChannels(void) const
+{
+    return (mChannels);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const AVChannelLayout& AudioDecoder::GetChannelLayout(void) const
+{
+    return (mLayout);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double AudioDecoder::GetDuration(void) const
+{
+    if (mFormatContext && mFormatContext->duration != AV_NOPTS_VALUE) {
+        return (static_cast<double>(mFormatContext->duration) / AV_TIME_BASE);
+    }
+    return (0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AudioDecoder::GetStreamIndex(void) const
+{
+    return (mStreamIndex);
+}
+
+} // namespace Moon
@@ -0,0 +1,200 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Decoder.hpp"
+extern "C" {
+    #include <libswresample/swresample.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Demuxer and decoder pair for the audio stream of a file
+///
+/// Samples come out interleaved as 32 bit floats, resampled to the
+/// requested rate and channel count. Like Decoder, every subsystem owns its
+/// own instance.
+///
+///////////////////////////////////////////////////////////////////////////////
+class AudioDecoder
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Output format
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Options
+    {
+        int sampleRate = 0;         ///< Output rate, 0 for the stream rate
+        int channels = 0;           ///< Output channels, 0 for the stream's
+        int streamIndex = -1;       ///< Audio stream, -1 for the best one
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    using Status = Decoder::Status;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Options mOptions;
+    AVFormatContext* mFormatContext;
+    AVCodecContext* mCodecContext;
+    SwrContext* mResampler;
+    AVPacket* mPacket;
+    AVFrame* mFrame;
+    int mStreamIndex;
+    int mSampleRate;
+    int mChannels;
+    AVChannelLayout mLayout;
+    Int64 mStartPts;
+    bool mEndOfFile;
+    bool mResync;
+    double mTimestamp;
+    double mChunkTimestamp;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AudioDecoder(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~AudioDecoder();
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    AudioDecoder(const AudioDecoder&) = delete;
+    AudioDecoder& operator=(const AudioDecoder&) = delete;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Create the resampler from the format of the first frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool OpenResampler(const AVFrame* frame);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the best audio stream of a file
+    ///
+    /// \param filePath Path of the media file
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(const Path& filePath);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open an audio stream of a file
+    ///
+    /// \param filePath Path of the media file
+    /// \param options Output format and stream
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(const Path& filePath, const Options& options);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Release every FFmpeg context
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Close(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if a stream is open
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsOpen(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode the next chunk of samples
+    ///
+    /// \param samples Replaced by interleaved samples
+    ///
+    /// \return Frame when samples were produced
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Status Decode(Vector<float>& samples);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Seek to the last keyframe at or before a position
+    ///
+    /// \param seconds Position from the start of the stream
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Seek(double seconds);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Position of the first sample of the last chunk, in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetTimestamp(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Output sample rate in Hz
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetSampleRate(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Output channel count
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetChannels(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Layout of the output channels, the stream's own layout when
+    ///         its channel count is kept
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const AVChannelLayout& GetChannelLayout(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Duration of the file in seconds, 0 if unknown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetDuration(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the decoded stream in the file, -1 if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetStreamIndex(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,350 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/AudioOutput.hpp"
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+AudioOutput::AudioOutput(const Path& filePath, int streamIndex)
+    : mDecodedOffset(0)
+    , mWritten(0)
+    , mSampleOffset(0)
+    , mSampleCount(0)
+    , mSampleStart(0)
+    , mRead(0)
+    , mStretching(false)
+    , mAppliedGain(1.f)
+    , mOpened(false)
+    , mMarks{}
+    , mMarkCount(0)
+    , mOutputFrames(0)
+    , mSeekOffset(0.0)
+{
+    AudioDecoder::Options options;
+
+    options.streamIndex = streamIndex;
+
+    // Probe the stream first to know its channel count
+    if (!mDecoder.Open(filePath, options)) {
+        return;
+    }
+
+    options.channels = std::min(mDecoder.GetChannels(), MAX_CHANNELS);
+    if (!mDecoder.Open(filePath, options)) {
+        return;
+    }
+
+    int channels = mDecoder.GetChannels();
+
+    // Sized up front, the streaming thread must not allocate
+    mStretch.Configure(channels, mDecoder.GetSampleRate(), CHUNK_FRAMES);
+    mSamples.resize(CHUNK_FRAMES * channels);
+    mStretched.resize(CHUNK_FRAMES * channels);
+    mBuffer.reserve(CHUNK_FRAMES * channels);
+
+    initialize(static_cast<unsigned int>(channels),
+        static_cast<unsigned int>(mDecoder.GetSampleRate()),
+        channels == 1
+            ? std::vector<sf::SoundChannel>{sf::SoundChannel::Mono}
+            : std::vector<sf::SoundChannel>{
+                sf::SoundChannel::FrontLeft, sf::SoundChannel::FrontRight
+            });
+
+    // Decoded ahead right away, the first chunk must not wait for the task
+    Produce();
+    mOpened = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioOutput::~AudioOutput()
+{
+    // The streaming thread must not call back into a destroyed object
+    stop();
+    mDecodeTask.Stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::Produce(void)
+{
+    {
+        std::unique_lock<Mutex> lock(mDecodeMutex);
+
+        while (!mEndOfStream) {
+            if (mDecodedOffset >= mDecoded.size()) {
+                if (mDecoder.Decode(mDecoded) != AudioDecoder::Status::Frame) {
+                    mEndOfStream = true;
+                    break;
+                }
+
+                // Positions follow the sample count after the first block
+                if (mWritten == 0) {
+                    mStartTime = mDecoder.GetTimestamp();
+                }
+                mDecodedOffset = 0;
+            }
+
+            // The capacity is a power of two, so with at most two channels
+            // the ring always stops on a whole frame
+            size_t written = mRing.Write(mDecoded.data() + mDecodedOffset,
+                mDecoded.size() - mDecodedOffset);
+
+            mDecodedOffset += written;
+            mWritten += written;
+
+            if (mDecodedOffset < mDecoded.size()) {
+                break;
+            }
+        }
+    }
+
+    std::unique_lock<Mutex> lock(mReadyMutex);
+    mReadyCV.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioOutput::Refill(void)
+{
+    if (mSampleOffset < mSampleCount) {
+        return (true);
+    }
+
+    size_t channels = static_cast<size_t>(mDecoder.GetChannels());
+    size_t count = mRing.Read(mSamples.data(), mSamples.size());
+
+    // Only happens when the task falls behind, or at the end of the stream
+    if (count == 0 && !mEndOfStream) {
+        mDecodeTask.Wake();
+
+        std::unique_lock<Mutex> lock(mReadyMutex);
+        mReadyCV.wait(lock, [this]{
+            return (mRing.GetAvailable() > 0 || mEndOfStream);
+        });
+        lock.unlock();
+
+        count = mRing.Read(mSamples.data(), mSamples.size());
+    }
+
+    if (mRing.GetAvailable() < RING_FRAMES * channels / 2) {
+        mDecodeTask.Wake();
+    }
+
+    mSampleOffset = 0;
+    mSampleCount = count;
+    mSampleStart = mRead;
+    mRead += count;
+    return (count > 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double AudioOutput::GetTimestamp(Uint64 sample) const
+{
+    Uint64 channels = static_cast<Uint64>(mDecoder.GetChannels());
+
+    return (mStartTime + static_cast<double>(sample / channels) /
+        mDecoder.GetSampleRate());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::AddMark(size_t frames, double timestamp, double speed)
+{
+    std::unique_lock<Mutex> lock(mMarkMutex);
+
+    mMarks[mMarkCount % MARK_COUNT] = {mOutputFrames, timestamp, speed};
+    mMarkCount++;
+    mOutputFrames += frames;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioOutput::onGetData(Chunk& data)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    size_t channels = static_cast<size_t>(mDecoder.GetChannels());
+    double rate = static_cast<double>(mDecoder.GetSampleRate());
+    double speed = mSpeed;
+    const float* samples = nullptr;
+    size_t frames = 0;
+
+    if (speed == 1.0) {
+        // Whatever the stretcher still holds is dropped, a few tens of ms
+        if (mStretching) {
+            mStretch.Clear();
+            mStretching = false;
+        }
+
+        if (!Refill()) {
+            return (false);
+        }
+
+        size_t available = (mSampleCount - mSampleOffset) / channels;
+
+        frames = std::min(available, CHUNK_FRAMES);
+        samples = mSamples.data() + mSampleOffset;
+        AddMark(frames, GetTimestamp(mSampleStart + mSampleOffset), speed);
+        mSampleOffset += frames * channels;
+    } else {
+        mStretch.SetSpeed(speed);
+        mStretching = true;
+
+        while (mStretch.GetOutputFrames() < CHUNK_FRAMES) {
+            if (mStretch.Process()) {
+                continue;
+            }
+            if (!Refill()) {
+                break;
+            }
+
+            size_t accepted = mStretch.Push(mSamples.data() + mSampleOffset,
+                (mSampleCount - mSampleOffset) / channels);
+
+            mSampleOffset += accepted * channels;
+        }
+
+        // The output pending comes from input before the buffered input
+        double pushed = GetTimestamp(mSampleStart + mSampleOffset);
+        double timestamp = pushed - (mStretch.GetInputFrames() +
+            mStretch.GetOutputFrames() * speed) / rate;
+
+        frames = mStretch.Pull(mStretched.data(), CHUNK_FRAMES);
+        samples = mStretched.data();
+        if (frames == 0) {
+            return (false);
+        }
+        AddMark(frames, timestamp, speed);
+    }
+
+    float target = mGain;
+    float step = (target - mAppliedGain) / static_cast<float>(frames);
+    float gain = mAppliedGain;
+    float mix = 1.f / static_cast<float>(channels);
+    Array<float, TAP_BLOCK> tap;
+    size_t tapped = 0;
+
+    mBuffer.resize(frames * channels);
+
+    for (size_t i = 0; i < frames; i++) {
+        float mono = 0.f;
+
+        gain += step;
+
+        for (size_t c = 0; c < channels; c++) {
+            float value = std::clamp(
+                samples[i * channels + c] * gain, -1.f, 1.f);
+
+            mBuffer[i * channels + c] =
+                static_cast<Int16>(std::lrint(value * 32767.f));
+            mono += value;
+        }
+
+        if (mTap) {
+            tap[tapped++] = mono * mix;
+            if (tapped == TAP_BLOCK) {
+                mTap->Write(tap.data(), tapped);
+                tapped = 0;
+            }
+        }
+    }
+
+    if (mTap && tapped > 0) {
+        mTap->Write(tap.data(), tapped);
+    }
+
+    mAppliedGain = target;
+    data.samples = mBuffer.data();
+    data.sampleCount = mBuffer.size();
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::onSeek(sf::Time timeOffset)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    {
+        std::unique_lock<Mutex> decodeLock(mDecodeMutex);
+
+        if (!mDecoder.Seek(timeOffset.asSeconds())) {
+            std::cerr << "Could not seek audio to: "
+                << timeOffset.asSeconds() << std::endl;
+        }
+
+        mDecoded.clear();
+        mDecodedOffset = 0;
+        mWritten = 0;
+        mEndOfStream = false;
+
+        // Reads are serialized by mMutex, the ring can be drained from here
+        while (mRing.Read(mSamples.data(), mSamples.size()) > 0) {}
+    }
+
+    mSampleOffset = 0;
+    mSampleCount = 0;
+    mRead = 0;
+    mStretch.Clear();
+    Produce();
+
+    std::unique_lock<Mutex> markLock(mMarkMutex);
+    mMarkCount = 0;
+    mOutputFrames = 0;
+    mSeekOffset = timeOffset.asSeconds();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioOutput::IsOpen(void) const
+{
+    return (mOpened);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::SetGain(double decibels)
+{
+    mGain = static_cast<float>(std::pow(10.0, decibels / 20.0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::SetSpeed(double speed)
+{
+    mSpeed = std::clamp(speed, TimeStretch::MIN_SPEED, TimeStretch::MAX_SPEED);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double AudioOutput::GetPosition(void)
+{
+    double offset = getPlayingOffset().asSeconds();
+    double rate = static_cast<double>(mDecoder.GetSampleRate());
+    std::unique_lock<Mutex> lock(mMarkMutex);
+    double played = std::max(0.0, (offset - mSeekOffset) * rate);
+    Uint64 count = std::min<Uint64>(mMarkCount, MARK_COUNT);
+
+    // Newest mark whose chunk started playing
+    for (Uint64 i = 0; i < count; i++) {
+        const Mark& mark = mMarks[(mMarkCount - 1 - i) % MARK_COUNT];
+
+        if (static_cast<double>(mark.output) <= played) {
+            return (mark.timestamp +
+                (played - mark.output) / rate * mark.speed);
+        }
+    }
+    return (mSeekOffset + played / rate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioOutput::SetTap(const SharedPtr<SampleRing>& tap)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    mTap = tap;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int AudioOutput::GetSampleRate(void) const
+{
+    return (mDecoder.GetSampleRate());
+}
+
+} // namespace Moon
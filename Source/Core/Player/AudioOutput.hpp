@@ -0,0 +1,221 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/AudioDecoder.hpp"
+#include "Core/Player/TimeStretch.hpp"
+#include "Core/System/SampleRing.hpp"
+#include "Core/System/SerialTask.hpp"
+#include <SFML/Audio.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Sound output of an audio stream, with a normalization gain
+///
+/// The stream is decoded on a scheduler task, downmixed to stereo at most,
+/// into a SampleRing kept a few chunks ahead. SFML asks for samples from
+/// the audio device callback, which then only copies, stretches and
+/// converts them: it wakes the task when the ring runs below half and
+/// waits for it only if the ring runs dry. The gain is applied while
+/// converting the floats to the 16 bit samples SFML plays, so it costs no
+/// extra pass; changes ramp over one chunk to avoid clicks.
+///
+/// Away from normal speed the samples go through a TimeStretch, so the
+/// pitch is kept. Each chunk handed to SFML is marked with the media time
+/// of its first sample, which GetPosition interpolates from the played
+/// offset since the last seek.
+///
+/// A SampleRing can be attached as a tap: it receives the samples as they
+/// are handed to SFML, after gain and mixed down to mono, without locking.
+///
+///////////////////////////////////////////////////////////////////////////////
+class AudioOutput : public sf::SoundStream
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr size_t CHUNK_FRAMES = 4096;
+    static constexpr size_t RING_FRAMES = 4 * CHUNK_FRAMES;
+    static constexpr size_t MARK_COUNT = 32;
+    static constexpr size_t TAP_BLOCK = 256;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Media time of the first sample of a chunk
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Mark
+    {
+        Uint64 output;                  ///< Frames output since the seek
+        double timestamp;               ///< Media time in seconds
+        double speed;                   ///< Media seconds per output second
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    AudioDecoder mDecoder;
+    Mutex mDecodeMutex;
+    Vector<float> mDecoded;
+    size_t mDecodedOffset;
+    Uint64 mWritten;
+
+    SampleRing mRing{RING_FRAMES * MAX_CHANNELS};
+    Atomic<double> mStartTime{0.0};
+    Atomic<bool> mEndOfStream{false};
+    Mutex mReadyMutex;
+    ConditionVariable mReadyCV;
+
+    Mutex mMutex;
+    Vector<float> mSamples;
+    size_t mSampleOffset;
+    size_t mSampleCount;
+    Uint64 mSampleStart;
+    Uint64 mRead;
+    Vector<float> mStretched;
+    Vector<Int16> mBuffer;
+    TimeStretch mStretch;
+    bool mStretching;
+    Atomic<float> mGain{1.f};
+    Atomic<double> mSpeed{1.0};
+    float mAppliedGain;
+    bool mOpened;
+    SharedPtr<SampleRing> mTap;
+
+    Mutex mMarkMutex;
+    Array<Mark, MARK_COUNT> mMarks;
+    Uint64 mMarkCount;
+    Uint64 mOutputFrames;
+    double mSeekOffset;
+
+    SerialTask mDecodeTask{
+        TaskScheduler::Priority::RealTime, [this]{ Produce(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open an audio stream of a file
+    ///
+    /// \param filePath Path of the media file
+    /// \param streamIndex Audio stream, -1 for the best one
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AudioOutput(const Path& filePath, int streamIndex);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~AudioOutput() override;
+
+protected:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert the next chunk taken from the ring
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool onGetData(Chunk& data) override;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Move the decoder to a position
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void onSeek(sf::Time timeOffset) override;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode until the ring is full or the stream ends
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Produce(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take the next samples from the ring once the previous ones are
+    ///        consumed
+    ///
+    /// \return False at the end of the stream or on error
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Refill(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param sample Samples read from the ring since the seek
+    ///
+    /// \return Media time of that sample in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetTimestamp(Uint64 sample) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Mark the chunk about to be output
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void AddMark(size_t frames, double timestamp, double speed);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if the stream could be opened
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsOpen(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set the gain applied to the samples
+    ///
+    /// \param decibels Gain in dB, 0 to play the stream as is
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetGain(double decibels);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set the playback speed, keeping the pitch
+    ///
+    /// \param speed Speed factor, 1 for normal speed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetSpeed(double speed);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Media time being heard
+    ///
+    /// Unlike getPlayingOffset, it accounts for the speed changes.
+    ///
+    /// \return Position in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetPosition(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Copy the output to a ring, read by another thread
+    ///
+    /// \param tap Ring receiving mono samples, nullptr to detach it
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetTap(const SharedPtr<SampleRing>& tap);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Output sample rate in Hz
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetSampleRate(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,395 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/AudioPeaks.hpp"
+#include "Core/System/CacheDirectory.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <cmath>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static AudioPeaks::Peak MeasureScalar(const float* samples, size_t count)
+{
+    AudioPeaks::Peak peak = {INFINITY, -INFINITY, 0.f};
+
+    for (size_t i = 0; i < count; i++) {
+        peak.min = std::min(peak.min, samples[i]);
+        peak.max = std::max(peak.max, samples[i]);
+        peak.power += samples[i] * samples[i];
+    }
+    return (peak);
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static AudioPeaks::Peak MeasureAvx2(
+    const float* samples,
+    size_t count
+)
+{
+    __m256 low = _mm256_set1_ps(INFINITY);
+    __m256 high = _mm256_set1_ps(-INFINITY);
+    __m256 power = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 value = _mm256_loadu_ps(samples + i);
+
+        low = _mm256_min_ps(low, value);
+        high = _mm256_max_ps(high, value);
+        power = _mm256_fmadd_ps(value, value, power);
+    }
+
+    alignas(32) float lows[8];
+    alignas(32) float highs[8];
+    alignas(32) float powers[8];
+    AudioPeaks::Peak peak = MeasureScalar(samples + i, count - i);
+
+    _mm256_store_ps(lows, low);
+    _mm256_store_ps(highs, high);
+    _mm256_store_ps(powers, power);
+    for (int lane = 0; lane < 8; lane++) {
+        peak.min = std::min(peak.min, lows[lane]);
+        peak.max = std::max(peak.max, highs[lane]);
+        peak.power += powers[lane];
+    }
+    return (peak);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+static AudioPeaks::Peak Measure(const float* samples, size_t count)
+{
+    AudioPeaks::Peak peak;
+
+#if MOON_X86
+    if (HasAvx2()) {
+        peak = MeasureAvx2(samples, count);
+    } else {
+        peak = MeasureScalar(samples, count);
+    }
+#else
+    peak = MeasureScalar(samples, count);
+#endif
+
+    peak.power /= static_cast<float>(std::max<size_t>(count, 1));
+    return (peak);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioPeaks::AudioPeaks(const Path& filePath)
+    : mFilePath(filePath)
+    , mSampleRate(0)
+    , mDuration(0.0)
+    , mComplete(false)
+{
+    mTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ Work(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioPeaks::~AudioPeaks()
+{
+    mStop = true;
+
+    if (mTask.valid()) {
+        mTask.wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioPeaks::Work(void)
+{
+    if (Load()) {
+        return;
+    }
+
+    AudioDecoder decoder;
+
+    // Nothing to measure in a silent file
+    if (!decoder.Open(mFilePath)) {
+        std::unique_lock<Mutex> lock(mMutex);
+        mComplete = true;
+        return;
+    }
+
+    size_t channels = static_cast<size_t>(decoder.GetChannels());
+    double rate = static_cast<double>(decoder.GetSampleRate());
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mSampleRate = decoder.GetSampleRate();
+        mDuration = decoder.GetDuration();
+    }
+
+    size_t blockLength = BLOCK_SIZE * channels;
+    Vector<float> samples;
+    Vector<float> pending;
+    Vector<Peak> batch;
+    AudioDecoder::Status status = AudioDecoder::Status::Frame;
+
+    while (!mStop &&
+        (status = decoder.Decode(samples)) == AudioDecoder::Status::Frame
+    ) {
+        pending.insert(pending.end(), samples.begin(), samples.end());
+
+        size_t offset = 0;
+
+        for (; offset + blockLength <= pending.size(); offset += blockLength) {
+            batch.push_back(Measure(pending.data() + offset, blockLength));
+        }
+        pending.erase(pending.begin(), pending.begin() + offset);
+
+        mPosition = decoder.GetTimestamp() +
+            static_cast<double>(samples.size() / channels) / rate;
+
+        if (batch.size() >= PUBLISH_INTERVAL) {
+            std::unique_lock<Mutex> lock(mMutex);
+            Append(batch);
+            batch.clear();
+        }
+    }
+
+    if (mStop) {
+        return;
+    }
+
+    if (!pending.empty()) {
+        batch.push_back(Measure(pending.data(), pending.size()));
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        Append(batch);
+        Seal();
+        mComplete = true;
+    }
+
+    // A decoding error would save a truncated waveform
+    if (status == AudioDecoder::Status::EndOfFile) {
+        Save();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AudioPeaks::Peak AudioPeaks::Merge(const Peak* peaks, size_t count)
+{
+    Peak merged = {INFINITY, -INFINITY, 0.f};
+
+    for (size_t i = 0; i < count; i++) {
+        merged.min = std::min(merged.min, peaks[i].min);
+        merged.max = std::max(merged.max, peaks[i].max);
+        merged.power += peaks[i].power;
+    }
+    merged.power /= static_cast<float>(std::max<size_t>(count, 1));
+    return (merged);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioPeaks::Append(const Vector<Peak>& peaks)
+{
+    if (mLevels.empty()) {
+        mLevels.emplace_back();
+    }
+
+    for (const Peak& peak : peaks) {
+        mLevels[0].push_back(peak);
+
+        // Every completed group of a level becomes a bucket of the next
+        for (size_t level = 0;
+            mLevels[level].size() % LEVEL_FACTOR == 0;
+            level++
+        ) {
+            if (level + 1 == mLevels.size()) {
+                mLevels.emplace_back();
+            }
+            mLevels[level + 1].push_back(Merge(
+                mLevels[level].data() + mLevels[level].size() - LEVEL_FACTOR,
+                LEVEL_FACTOR));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioPeaks::Seal(void)
+{
+    for (size_t level = 0;
+        level < mLevels.size() && mLevels[level].size() > 1;
+        level++
+    ) {
+        size_t size = mLevels[level].size();
+        size_t remainder = size % LEVEL_FACTOR;
+
+        if (level + 1 == mLevels.size()) {
+            mLevels.emplace_back();
+        }
+
+        if (mLevels[level + 1].size() < (size + LEVEL_FACTOR - 1) / LEVEL_FACTOR) {
+            mLevels[level + 1].push_back(Merge(
+                mLevels[level].data() + size - remainder, remainder));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Path AudioPeaks::GetCachePath(void) const
+{
+    Path directory = GetCacheDirectory(mFilePath);
+
+    if (directory.empty()) {
+        return (Path());
+    }
+    return (directory / "peaks.bin");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioPeaks::Load(void)
+{
+    Path path = GetCachePath();
+    IfStream file(path, std::ios::binary);
+    char magic[sizeof(CACHE_MAGIC)];
+    Uint32 version = 0;
+    Uint32 sampleRate = 0;
+    Uint64 count = 0;
+
+    if (path.empty() || !file ||
+        !file.read(magic, sizeof(magic)) ||
+        !file.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+        !file.read(reinterpret_cast<char*>(&sampleRate), sizeof(sampleRate)) ||
+        !file.read(reinterpret_cast<char*>(&count), sizeof(count)) ||
+        std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        version != CACHE_VERSION || sampleRate == 0
+    ) {
+        return (false);
+    }
+
+    Vector<Peak> peaks(count);
+
+    if (!file.read(reinterpret_cast<char*>(peaks.data()),
+        static_cast<std::streamsize>(count * sizeof(Peak)))
+    ) {
+        return (false);
+    }
+
+    std::unique_lock<Mutex> lock(mMutex);
+    mSampleRate = static_cast<int>(sampleRate);
+    mDuration = static_cast<double>(count * BLOCK_SIZE) / sampleRate;
+    mLevels.clear();
+    Append(peaks);
+    Seal();
+    mComplete = true;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void AudioPeaks::Save(void) const
+{
+    Path path = GetCachePath();
+
+    if (path.empty()) {
+        return;
+    }
+
+    // Written aside then renamed, a reader never sees half a file
+    Path temporary = path;
+    temporary += ".tmp";
+
+    {
+        OfStream file(temporary, std::ios::binary);
+        std::unique_lock<Mutex> lock(mMutex);
+        Uint32 version = CACHE_VERSION;
+        Uint32 sampleRate = static_cast<Uint32>(mSampleRate);
+        Uint64 count = mLevels.empty() ? 0 : mLevels[0].size();
+
+        file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        file.write(reinterpret_cast<const char*>(&sampleRate),
+            sizeof(sampleRate));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        if (count > 0) {
+            file.write(reinterpret_cast<const char*>(mLevels[0].data()),
+                static_cast<std::streamsize>(count * sizeof(Peak)));
+        }
+
+        if (!file) {
+            std::cerr << "Could not write " << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioPeaks::GetPeaks(double start, double end, Vector<Peak>& columns) const
+{
+    std::fill(columns.begin(), columns.end(), Peak{0.f, 0.f, 0.f});
+
+    std::unique_lock<Mutex> lock(mMutex);
+
+    if (mLevels.empty() || mLevels[0].empty() || columns.empty() ||
+        end <= start
+    ) {
+        return (false);
+    }
+
+    // Coarsest level that still has a bucket per column
+    double bucketSeconds = static_cast<double>(BLOCK_SIZE) / mSampleRate;
+    double columnSeconds = (end - start) / columns.size();
+    size_t level = 0;
+
+    while (level + 1 < mLevels.size() &&
+        bucketSeconds * LEVEL_FACTOR <= columnSeconds
+    ) {
+        bucketSeconds *= LEVEL_FACTOR;
+        level++;
+    }
+
+    const Vector<Peak>& buckets = mLevels[level];
+
+    for (size_t column = 0; column < columns.size(); column++) {
+        double from = (start + column * columnSeconds) / bucketSeconds;
+        double to = (start + (column + 1) * columnSeconds) / bucketSeconds;
+
+        if (to <= 0.0 || from >= static_cast<double>(buckets.size())) {
+            continue;
+        }
+
+        size_t first = static_cast<size_t>(std::max(from, 0.0));
+        size_t last = std::min(buckets.size(),
+            std::max(first + 1, static_cast<size_t>(to)));
+
+        columns[column] = Merge(buckets.data() + first, last - first);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double AudioPeaks::GetProgress(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    if (mComplete) {
+        return (1.0);
+    }
+    if (mDuration <= 0.0) {
+        return (0.0);
+    }
+    return (std::clamp(mPosition / mDuration, 0.0, 1.0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool AudioPeaks::IsComplete(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mComplete);
+}
+
+} // namespace Moon
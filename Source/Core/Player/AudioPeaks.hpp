@@ -0,0 +1,167 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/AudioDecoder.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Minimum, maximum and power of the audio of a file, at every zoom
+///        level
+///
+/// A background task decodes the audio and measures blocks of BLOCK_SIZE
+/// sample frames, all channels together. Each level of the pyramid merges
+/// LEVEL_FACTOR buckets of the level below, so a view of any length reads
+/// a few buckets per column from the level closest to its resolution.
+///
+/// The finest level is saved in the cache directory of the file once
+/// complete; the coarser levels are rebuilt from it when loaded.
+///
+///////////////////////////////////////////////////////////////////////////////
+class AudioPeaks
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t BLOCK_SIZE = 256;
+    static constexpr size_t LEVEL_FACTOR = 4;
+    static constexpr size_t PUBLISH_INTERVAL = 1024;
+    static constexpr char CACHE_MAGIC[8] = {'M', 'O', 'O', 'N', 'P', 'E', 'A', 'K'};
+    static constexpr Uint32 CACHE_VERSION = 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Summary of a run of samples
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Peak
+    {
+        float min;                  ///< Lowest sample
+        float max;                  ///< Highest sample
+        float power;                ///< Mean of the squared samples
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    std::future<void> mTask;
+
+    mutable Mutex mMutex;
+    Vector<Vector<Peak>> mLevels;
+    int mSampleRate;
+    double mDuration;
+    bool mComplete;
+
+    Atomic<bool> mStop{false};
+    Atomic<double> mPosition{0.0};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start measuring a file, or load the saved peaks
+    ///
+    /// \param filePath Path of the media file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AudioPeaks(const Path& filePath);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~AudioPeaks();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Add buckets to the finest level and merge them upwards
+    ///
+    /// Must be called with the mutex held.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Append(const Vector<Peak>& peaks);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Merge the incomplete groups left at the end of each level
+    ///
+    /// Must be called with the mutex held.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Seal(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Path of the saved peaks in the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Path GetCachePath(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Load peaks saved by an earlier run
+    ///
+    /// \return True if the peaks were loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Load(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Save the finest level to the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Save(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Merge consecutive buckets
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static Peak Merge(const Peak* peaks, size_t count);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Peaks of evenly sized columns of a time range
+    ///
+    /// Columns past the measured part of the file are left silent.
+    ///
+    /// \param start Start of the range in seconds
+    /// \param end End of the range in seconds
+    /// \param columns Replaced by one peak per column, keeps its size
+    ///
+    /// \return False when nothing has been measured yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool GetPeaks(double start, double end, Vector<Peak>& columns) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Fraction of the file measured, between 0 and 1
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetProgress(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once the whole file was measured or loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsComplete(void) const;
+};
+
+} // namespace Moon
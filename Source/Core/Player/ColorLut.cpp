@@ -0,0 +1,403 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/ColorLut.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include "Core/System/ParallelFor.hpp"
+#include <cctype>
+#include <cmath>
+#include <sstream>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Layout of the table for the kernels, 4 floats per lattice point
+///
+///////////////////////////////////////////////////////////////////////////////
+struct Lattice
+{
+    const float* table;
+    int size;
+    const float* scale;
+    const float* offset;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static void ApplyScalar(const Lattice& lut, Uint8* pixels, Uint32 count)
+{
+    int last = lut.size - 1;
+    int stride[3] = {4, 4 * lut.size, 4 * lut.size * lut.size};
+
+    for (Uint32 i = 0; i < count; i++) {
+        Uint8* pixel = pixels + 4 * i;
+        int index[3];
+        float fraction[3];
+
+        for (int c = 0; c < 3; c++) {
+            float coordinate = std::clamp(pixel[c] * lut.scale[c] +
+                lut.offset[c], 0.f, static_cast<float>(last));
+
+            index[c] = std::min(static_cast<int>(coordinate), last - 1);
+            fraction[c] = coordinate - static_cast<float>(index[c]);
+        }
+
+        // The axis of the largest fraction is walked first, the smallest
+        // last; ties pick any tetrahedron, their weights are then zero
+        bool rg = fraction[0] >= fraction[1];
+        bool gb = fraction[1] >= fraction[2];
+        bool rb = fraction[0] >= fraction[2];
+        int high = rg && rb ? 0 : (gb ? 1 : 2);
+        int low = gb && rb ? 2 : (rg ? 1 : 0);
+        int middle = 3 - high - low;
+        int base = index[0] * stride[0] + index[1] * stride[1] +
+            index[2] * stride[2];
+        int corner = stride[0] + stride[1] + stride[2];
+        const float* c0 = lut.table + base;
+        const float* c1 = c0 + stride[high];
+        const float* c2 = c0 + corner - stride[low];
+        const float* c3 = c0 + corner;
+        float w0 = 1.f - fraction[high];
+        float w1 = fraction[high] - fraction[middle];
+        float w2 = fraction[middle] - fraction[low];
+        float w3 = fraction[low];
+
+        for (int c = 0; c < 3; c++) {
+            float value = w0 * c0[c] + w1 * c1[c] + w2 * c2[c] + w3 * c3[c];
+
+            pixel[c] = static_cast<Uint8>(
+                std::lrint(std::clamp(value, 0.f, 1.f) * 255.f));
+        }
+    }
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static void ApplyAvx2(
+    const Lattice& lut,
+    Uint8* pixels,
+    Uint32 count
+)
+{
+    const __m256i byteMask = _mm256_set1_epi32(0xFF);
+    const __m256i alphaMask = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 maximum = _mm256_set1_ps(static_cast<float>(lut.size - 1));
+    const __m256i lastCell = _mm256_set1_epi32(lut.size - 2);
+    const __m256 full = _mm256_set1_ps(255.f);
+    const __m256i strideR = _mm256_set1_epi32(4);
+    const __m256i strideG = _mm256_set1_epi32(4 * lut.size);
+    const __m256i strideB = _mm256_set1_epi32(4 * lut.size * lut.size);
+    const __m256i corner = _mm256_set1_epi32(4 + 4 * lut.size +
+        4 * lut.size * lut.size);
+    __m256 scale[3];
+    __m256 offset[3];
+    Uint32 i = 0;
+
+    for (int c = 0; c < 3; c++) {
+        scale[c] = _mm256_set1_ps(lut.scale[c]);
+        offset[c] = _mm256_set1_ps(lut.offset[c]);
+    }
+
+    for (; i + 8 <= count; i += 8) {
+        __m256i* address = reinterpret_cast<__m256i*>(pixels + 4 * i);
+        __m256i packed = _mm256_loadu_si256(address);
+        __m256i index[3];
+        __m256 fraction[3];
+
+        for (int c = 0; c < 3; c++) {
+            __m256i value = _mm256_and_si256(
+                _mm256_srli_epi32(packed, 8 * c), byteMask);
+            __m256 coordinate = _mm256_fmadd_ps(
+                _mm256_cvtepi32_ps(value), scale[c], offset[c]);
+
+            coordinate = _mm256_min_ps(_mm256_max_ps(coordinate, zero), maximum);
+            index[c] = _mm256_min_epi32(
+                _mm256_cvttps_epi32(coordinate), lastCell);
+            fraction[c] = _mm256_sub_ps(
+                coordinate, _mm256_cvtepi32_ps(index[c]));
+        }
+
+        __m256 rg = _mm256_cmp_ps(fraction[0], fraction[1], _CMP_GE_OQ);
+        __m256 gb = _mm256_cmp_ps(fraction[1], fraction[2], _CMP_GE_OQ);
+        __m256 rb = _mm256_cmp_ps(fraction[0], fraction[2], _CMP_GE_OQ);
+        __m256i highR = _mm256_castps_si256(_mm256_and_ps(rg, rb));
+        __m256i lowB = _mm256_castps_si256(_mm256_and_ps(gb, rb));
+
+        // Stride of the largest and of the smallest fraction
+        __m256i high = _mm256_blendv_epi8(
+            _mm256_blendv_epi8(strideB, strideG, _mm256_castps_si256(gb)),
+            strideR, highR);
+        __m256i low = _mm256_blendv_epi8(
+            _mm256_blendv_epi8(strideR, strideG, _mm256_castps_si256(rg)),
+            strideB, lowB);
+
+        __m256 largest = _mm256_max_ps(fraction[0],
+            _mm256_max_ps(fraction[1], fraction[2]));
+        __m256 smallest = _mm256_min_ps(fraction[0],
+            _mm256_min_ps(fraction[1], fraction[2]));
+        __m256 middle = _mm256_sub_ps(_mm256_add_ps(fraction[0],
+            _mm256_add_ps(fraction[1], fraction[2])),
+            _mm256_add_ps(largest, smallest));
+        __m256 w0 = _mm256_sub_ps(one, largest);
+        __m256 w1 = _mm256_sub_ps(largest, middle);
+        __m256 w2 = _mm256_sub_ps(middle, smallest);
+        __m256 w3 = smallest;
+
+        __m256i i0 = _mm256_add_epi32(
+            _mm256_mullo_epi32(index[0], strideR),
+            _mm256_add_epi32(_mm256_mullo_epi32(index[1], strideG),
+                _mm256_mullo_epi32(index[2], strideB)));
+        __m256i i1 = _mm256_add_epi32(i0, high);
+        __m256i i3 = _mm256_add_epi32(i0, corner);
+        __m256i i2 = _mm256_sub_epi32(i3, low);
+        __m256i result = _mm256_and_si256(packed, alphaMask);
+
+        for (int c = 0; c < 3; c++) {
+            const float* table = lut.table + c;
+            __m256 value = _mm256_mul_ps(w0,
+                _mm256_i32gather_ps(table, i0, 4));
+
+            value = _mm256_fmadd_ps(w1, _mm256_i32gather_ps(table, i1, 4), value);
+            value = _mm256_fmadd_ps(w2, _mm256_i32gather_ps(table, i2, 4), value);
+            value = _mm256_fmadd_ps(w3, _mm256_i32gather_ps(table, i3, 4), value);
+            value = _mm256_min_ps(_mm256_max_ps(value, zero), one);
+
+            __m256i channel = _mm256_cvtps_epi32(_mm256_mul_ps(value, full));
+
+            result = _mm256_or_si256(result,
+                _mm256_slli_epi32(channel, 8 * c));
+        }
+
+        _mm256_storeu_si256(address, result);
+    }
+
+    ApplyScalar(lut, pixels + 4 * i, count - i);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+ColorLut::ColorLut(void)
+    : mSize(MIN_SIZE)
+    , mScale{1.f / 255.f, 1.f / 255.f, 1.f / 255.f}
+    , mOffset{0.f, 0.f, 0.f}
+{
+    mTable.resize(MIN_SIZE * MIN_SIZE * MIN_SIZE * 4, 0.f);
+
+    for (int b = 0; b < MIN_SIZE; b++) {
+        for (int g = 0; g < MIN_SIZE; g++) {
+            for (int r = 0; r < MIN_SIZE; r++) {
+                float* point = &mTable[((b * MIN_SIZE + g) * MIN_SIZE + r) * 4];
+
+                point[0] = static_cast<float>(r);
+                point[1] = static_cast<float>(g);
+                point[2] = static_cast<float>(b);
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ColorLut::LoadFromFile(const Path& filePath)
+{
+    IfStream file(filePath);
+
+    if (!file) {
+        std::cerr << "Could not open LUT: " << filePath << std::endl;
+        return (false);
+    }
+
+    if (!LoadFromStream(file)) {
+        std::cerr << "Invalid LUT: " << filePath << std::endl;
+        return (false);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ColorLut::LoadFromStream(std::istream& input)
+{
+    String line;
+    String title;
+    int size = 0;
+    float domainMin[3] = {0.f, 0.f, 0.f};
+    float domainMax[3] = {1.f, 1.f, 1.f};
+    Vector<float> table;
+    size_t points = 0;
+
+    while (std::getline(input, line)) {
+        std::istringstream words(line);
+        String keyword;
+
+        if (!(words >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+
+        if (keyword == "TITLE") {
+            size_t quote = line.find('"');
+            size_t end = line.rfind('"');
+
+            if (quote != String::npos && end > quote) {
+                title = line.substr(quote + 1, end - quote - 1);
+            }
+        } else if (keyword == "LUT_3D_SIZE") {
+            if (!(words >> size) || size < MIN_SIZE || size > MAX_SIZE) {
+                return (false);
+            }
+            table.assign(static_cast<size_t>(size) * size * size * 4, 0.f);
+        } else if (keyword == "LUT_1D_SIZE") {
+            return (false);
+        } else if (keyword == "DOMAIN_MIN") {
+            if (!(words >> domainMin[0] >> domainMin[1] >> domainMin[2])) {
+                return (false);
+            }
+        } else if (keyword == "DOMAIN_MAX") {
+            if (!(words >> domainMax[0] >> domainMax[1] >> domainMax[2])) {
+                return (false);
+            }
+        } else if (keyword == "LUT_3D_INPUT_RANGE") {
+            // Resolve's form of the domain, shared by the three channels
+            float minimum = 0.f;
+            float maximum = 0.f;
+
+            if (!(words >> minimum >> maximum)) {
+                return (false);
+            }
+            std::fill(std::begin(domainMin), std::end(domainMin), minimum);
+            std::fill(std::begin(domainMax), std::end(domainMax), maximum);
+        } else if (std::isalpha(static_cast<unsigned char>(keyword[0]))) {
+            // Other keywords, like LUT_1D_INPUT_RANGE without a 1D table or
+            // vendor extensions, do not change the 3D table
+            continue;
+        } else {
+            // Data lines, red changes fastest then green then blue
+            if (size == 0 || points == table.size() / 4) {
+                return (false);
+            }
+
+            float* point = &table[points * 4];
+
+            words.clear();
+            words.str(line);
+            if (!(words >> point[0] >> point[1] >> point[2])) {
+                return (false);
+            }
+            points++;
+        }
+    }
+
+    if (size == 0 || points != table.size() / 4) {
+        return (false);
+    }
+
+    for (int c = 0; c < 3; c++) {
+        float range = domainMax[c] - domainMin[c];
+
+        if (range <= 0.f) {
+            return (false);
+        }
+        mScale[c] = (size - 1) / (255.f * range);
+        mOffset[c] = -domainMin[c] * (size - 1) / range;
+    }
+
+    mSize = size;
+    mTable = std::move(table);
+    mTitle = title;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ColorLut::ApplyRows(
+    Uint8* pixels,
+    size_t stride,
+    Uint32 width,
+    Uint32 first,
+    Uint32 last
+) const
+{
+    Lattice lattice{mTable.data(), mSize, mScale, mOffset};
+
+    for (Uint32 y = first; y < last; y++) {
+        Uint8* row = pixels + y * stride;
+
+#if MOON_X86
+        if (HasAvx2()) {
+            ApplyAvx2(lattice, row, width);
+            continue;
+        }
+#endif
+        ApplyScalar(lattice, row, width);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ColorLut::Apply(
+    Uint8* pixels,
+    Uint32 width,
+    Uint32 height,
+    bool parallel,
+    TaskScheduler::Priority priority
+) const
+{
+    size_t stride = static_cast<size_t>(width) * 4;
+    Uint32 strips = (height + STRIP_ROWS - 1) / STRIP_ROWS;
+
+    if (!parallel || strips <= 1) {
+        ApplyRows(pixels, stride, width, 0, height);
+        return;
+    }
+
+    ParallelFor(strips, [&](Uint32 strip) {
+        Uint32 first = strip * STRIP_ROWS;
+
+        ApplyRows(pixels, stride, width, first,
+            std::min(first + STRIP_ROWS, height));
+    }, priority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Image ColorLut::ToImage(void) const
+{
+    Uint32 size = static_cast<Uint32>(mSize);
+    Vector<Uint8> pixels(static_cast<size_t>(size) * size * size * 4);
+
+    for (Uint32 b = 0; b < size; b++) {
+        for (Uint32 g = 0; g < size; g++) {
+            for (Uint32 r = 0; r < size; r++) {
+                const float* point = &mTable[((b * size + g) * size + r) * 4];
+                Uint8* pixel = &pixels[(g * size * size + b * size + r) * 4];
+
+                for (int c = 0; c < 3; c++) {
+                    pixel[c] = static_cast<Uint8>(std::lrint(
+                        std::clamp(point[c], 0.f, 1.f) * 255.f));
+                }
+                pixel[3] = 255;
+            }
+        }
+    }
+    return (sf::Image({size * size, size}, pixels.data()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int ColorLut::GetSize(void) const
+{
+    return (mSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const String& ColorLut::GetTitle(void) const
+{
+    return (mTitle);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Pair<float, float> ColorLut::GetDomain(int channel) const
+{
+    return (Pair<float, float>(mScale[channel], mOffset[channel]));
+}
+
+} // namespace Moon
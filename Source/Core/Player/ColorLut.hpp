@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+#include <SFML/Graphics/Image.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief 3D color lookup table loaded from an Adobe / Resolve .cube file
+///
+/// RGBA pixels are graded in place with tetrahedral interpolation: the
+/// lattice cell of a color is split in six tetrahedra by the order of its
+/// fractional coordinates, and the result blends only the four corners of
+/// the one it falls in. The AVX2 path does 8 pixels per pass with gathers.
+///
+/// Apply splits the picture in strips shared by the calling thread and
+/// scheduler tasks with ParallelFor, so it is safe from a scheduler worker.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ColorLut
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int MIN_SIZE = 2;
+    static constexpr int MAX_SIZE = 256;
+    static constexpr Uint32 STRIP_ROWS = 32;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    int mSize;
+    Vector<float> mTable;
+    float mScale[3];
+    float mOffset[3];
+    String mTitle;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Identity table of the minimum size
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ColorLut(void);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Grade rows of pixels, scalar or AVX2
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ApplyRows(Uint8* pixels, size_t stride, Uint32 width,
+        Uint32 first, Uint32 last) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Read a .cube file
+    ///
+    /// \return False if the file cannot be read or holds no 3D table
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool LoadFromFile(const Path& filePath);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Read a table in the .cube format
+    ///
+    /// \return False if the text holds no valid 3D table
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool LoadFromStream(std::istream& input);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Grade an RGBA picture in place
+    ///
+    /// \param pixels Rows of RGBA pixels, alpha is kept
+    /// \param width Width in pixels
+    /// \param height Height in pixels
+    /// \param parallel False to do every strip on the calling thread
+    /// \param priority Class of the strip tasks
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Apply(Uint8* pixels, Uint32 width, Uint32 height,
+        bool parallel = true,
+        TaskScheduler::Priority priority =
+            TaskScheduler::Priority::RealTime) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Table laid out for a 2D texture, for shaders
+    ///
+    /// The blue slices sit side by side: red runs along x inside a slice,
+    /// green along y, so the image is size * size by size pixels.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Image ToImage(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Points along each axis
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetSize(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return TITLE of the file, may be empty
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const String& GetTitle(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Lattice coordinate of an 8 bit value, from DOMAIN_MIN/MAX
+    ///
+    /// \param channel 0 to 2 for red, green and blue
+    ///
+    /// \return Pair of the scale and offset, coordinate = value * scale +
+    ///         offset, before clamping to [0, size - 1]
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Pair<float, float> GetDomain(int channel) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,396 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/ComparePlayer.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+ComparePlayer::ComparePlayer(const Path& reference, const Path& other)
+    : mOpened(false)
+    , mPlaying(false)
+    , mShowNextPair(true)
+    , mPendingStep(false)
+    , mDuration(0.0)
+    , mClockBase(0.0)
+    , mPositionBase(0.0)
+{
+    mSides[0].filePath = reference;
+    mSides[1].filePath = other;
+
+    for (Side& side : mSides) {
+        side.frame = av_frame_alloc();
+
+        if (!side.frame || !side.decoder.Open(side.filePath)) {
+            std::cerr << "Could not open " << side.filePath << std::endl;
+            return;
+        }
+        side.frameDuration = side.decoder.GetFrameDuration();
+        mDuration = std::max(mDuration, side.decoder.GetDuration());
+    }
+
+    mOpened = true;
+
+    for (Side& side : mSides) {
+        side.task = std::make_unique<SerialTask>(
+            TaskScheduler::Priority::RealTime, [this, &side]{ Decode(side); });
+        side.task->Wake();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ComparePlayer::~ComparePlayer()
+{
+    mStop = true;
+
+    for (Side& side : mSides) {
+        if (side.task) {
+            side.task->Stop();
+        }
+        av_frame_free(&side.frame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::Decode(Side& side)
+{
+    int errors = 0;
+
+    while (!mStop) {
+        Optional<double> seek;
+
+        {
+            std::unique_lock<Mutex> lock(side.mutex);
+            seek.swap(side.seek);
+            if (!seek && (side.queue.size() >= MAX_QUEUE_SIZE || side.endOfFile)) {
+                return;
+            }
+        }
+
+        if (seek) {
+            if (side.decoder.Seek(*seek)) {
+                side.skipUntil = *seek;
+                continue;
+            }
+
+            // The position is unknown, nothing decoded from here would match
+            std::cerr << "Could not seek to timestamp: " << *seek << std::endl;
+            std::unique_lock<Mutex> lock(side.mutex);
+            side.queue.clear();
+            side.endOfFile = !side.seek;
+            continue;
+        }
+
+        Decoder::Status status = side.decoder.Decode(side.frame);
+
+        // A damaged packet is skipped, only a failing input ends the side
+        if (status == Decoder::Status::Error &&
+            ++errors < MAX_DECODE_ERRORS) {
+            std::cerr << "Could not decode frame" << std::endl;
+            continue;
+        }
+
+        if (status != Decoder::Status::Frame) {
+            std::unique_lock<Mutex> lock(side.mutex);
+            side.endOfFile = !side.seek;
+            continue;
+        }
+        errors = 0;
+
+        Int64 pts = Decoder::GetFramePts(side.frame);
+        double timestamp = side.decoder.ToSeconds(pts);
+
+        // Half a frame of slack, a step back seeks to the exact previous
+        // timestamp and rounding must not skip it
+        if (timestamp < side.skipUntil - side.frameDuration / 2) {
+            av_frame_unref(side.frame);
+            continue;
+        }
+
+        SharedPtr<VideoFrame> frame = side.converter.Convert(
+            side.frame, pts, timestamp);
+        av_frame_unref(side.frame);
+
+        if (!frame) {
+            continue;
+        }
+
+        // A frame decoded before a pending seek is stale
+        std::unique_lock<Mutex> lock(side.mutex);
+        if (!side.seek) {
+            side.queue.push_back(std::move(frame));
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ComparePlayer::PresentNextPair(void)
+{
+    Side& reference = mSides[0];
+    Side& other = mSides[1];
+    SharedPtr<VideoFrame> next = nullptr;
+    SharedPtr<VideoFrame> match = nullptr;
+
+    {
+        std::scoped_lock lock(reference.mutex, other.mutex);
+
+        if (reference.queue.empty()) {
+            return (false);
+        }
+
+        next = reference.queue.front();
+
+        // The match is the last frame starting before the limit, it is only
+        // known once a later frame is queued or the file ended
+        double limit = next->timestamp + reference.frameDuration / 2;
+        auto end = std::find_if(other.queue.begin(), other.queue.end(),
+            [&](const SharedPtr<VideoFrame>& frame) {
+                return (frame->timestamp > limit);
+            }
+        );
+
+        if (end == other.queue.end() && !other.endOfFile) {
+            // Older candidates can never match, make room for the decoder
+            if (other.queue.size() > 1) {
+                other.queue.erase(other.queue.begin(), std::prev(end));
+                other.task->Wake();
+            }
+            return (false);
+        }
+
+        reference.queue.pop_front();
+        if (end != other.queue.begin()) {
+            match = *std::prev(end);
+            other.queue.erase(other.queue.begin(), end);
+        }
+    }
+
+    for (Side& side : mSides) {
+        side.task->Wake();
+    }
+
+    PresentFrame(reference, next);
+    if (match) {
+        PresentFrame(other, match);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::PresentFrame(Side& side, const SharedPtr<VideoFrame>& frame)
+{
+    sf::Vector2u size(frame->width, frame->height);
+
+    if (side.texture.getSize() != size && !side.texture.resize(size)) {
+        std::cerr << "Could not resize SFML texture" << std::endl;
+        return;
+    }
+    side.texture.update(frame->data, size, {0U, 0U});
+    side.current = frame;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::Rebase(double position)
+{
+    mClockBase = mClock.getElapsedTime().asSeconds();
+    mPositionBase = position;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ComparePlayer::Update(void)
+{
+    if (!mOpened) {
+        return (false);
+    }
+
+    if (mShowNextPair || mPendingStep) {
+        if (!PresentNextPair()) {
+            return (false);
+        }
+        mShowNextPair = false;
+        mPendingStep = false;
+        Rebase(GetCurrentTime());
+        return (true);
+    }
+
+    if (!mPlaying) {
+        return (false);
+    }
+
+    Side& reference = mSides[0];
+    double position = mPositionBase +
+        mClock.getElapsedTime().asSeconds() - mClockBase;
+    double timestamp = 0.0;
+
+    {
+        std::unique_lock<Mutex> lock(reference.mutex);
+        if (reference.queue.empty()) {
+            return (false);
+        }
+        timestamp = reference.queue.front()->timestamp;
+    }
+
+    if (timestamp > position || !PresentNextPair()) {
+        return (false);
+    }
+
+    // After a stall, resume at normal speed rather than rushing to catch up
+    if (position - timestamp > reference.frameDuration) {
+        Rebase(timestamp);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double ComparePlayer::GetNextUpdateDelay(void)
+{
+    if (!mOpened) {
+        return (std::numeric_limits<double>::infinity());
+    }
+
+    if (mShowNextPair || mPendingStep) {
+        return (POLL_INTERVAL);
+    }
+
+    if (!mPlaying || IsEndOfVideo()) {
+        return (std::numeric_limits<double>::infinity());
+    }
+
+    Side& reference = mSides[0];
+    std::unique_lock<Mutex> lock(reference.mutex);
+
+    if (reference.queue.empty()) {
+        return (POLL_INTERVAL);
+    }
+
+    double due = reference.queue.front()->timestamp - mPositionBase -
+        (mClock.getElapsedTime().asSeconds() - mClockBase);
+
+    return (due > 0.0 ? due : POLL_INTERVAL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::Play(void)
+{
+    if (!mPlaying) {
+        mPlaying = true;
+        Rebase(GetCurrentTime());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::Pause(void)
+{
+    mPlaying = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::TogglePause(void)
+{
+    if (mPlaying) {
+        Pause();
+    } else {
+        Play();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ComparePlayer::IsPlaying(void) const
+{
+    return (mPlaying);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::Seek(double seconds)
+{
+    if (!mOpened) {
+        return;
+    }
+
+    double target = std::clamp(seconds, 0.0, mDuration);
+
+    for (Side& side : mSides) {
+        {
+            std::unique_lock<Mutex> lock(side.mutex);
+            side.queue.clear();
+            side.seek = target;
+            side.endOfFile = false;
+        }
+        side.task->Wake();
+    }
+
+    mShowNextPair = true;
+    mPendingStep = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::StepForward(void)
+{
+    Pause();
+    mPendingStep = true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ComparePlayer::StepBackward(void)
+{
+    Pause();
+
+    const Side& reference = mSides[0];
+
+    if (reference.current) {
+        Seek(reference.current->timestamp - reference.frameDuration);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ComparePlayer::IsOpen(void) const
+{
+    return (mOpened);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ComparePlayer::IsEndOfVideo(void)
+{
+    Side& reference = mSides[0];
+    std::unique_lock<Mutex> lock(reference.mutex);
+
+    return (reference.endOfFile && reference.queue.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double ComparePlayer::GetDuration(void) const
+{
+    return (mDuration);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double ComparePlayer::GetCurrentTime(void) const
+{
+    return (GetFrameTime(0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double ComparePlayer::GetFrameTime(size_t side) const
+{
+    const SharedPtr<VideoFrame>& frame = mSides[side].current;
+
+    return (frame ? frame->timestamp : 0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Texture& ComparePlayer::GetTexture(size_t side) const
+{
+    return (mSides[side].texture);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Path& ComparePlayer::GetFilePath(size_t side) const
+{
+    return (mSides[side].filePath);
+}
+
+} // namespace Moon
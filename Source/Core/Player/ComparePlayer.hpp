@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/SerialTask.hpp"
+#include <SFML/Graphics.hpp>
+#include <deque>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Two files played in lockstep, for comparing encodes
+///
+/// Each side is decoded by its own real time scheduler task, so both run
+/// in parallel on different workers. Frames are only presented in pairs:
+/// every frame of the first file is shown together with the last frame of
+/// the second file starting no later than half a frame after it, and the
+/// pair waits until that match is known. Both sides therefore never drift,
+/// playback stalls instead.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ComparePlayer
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t SIDE_COUNT = 2;
+    static constexpr size_t MAX_QUEUE_SIZE = 8;
+    static constexpr double POLL_INTERVAL = 0.005;
+    static constexpr int MAX_DECODE_ERRORS = 32;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct Side
+    {
+        Path filePath;
+        Decoder decoder;
+        FrameConverter converter;
+        AVFrame* frame = nullptr;
+        double frameDuration = 1.0 / 25.0;
+        double skipUntil = -1.0;
+
+        Mutex mutex;
+        std::deque<SharedPtr<VideoFrame>> queue;
+        Optional<double> seek;
+        bool endOfFile = false;
+
+        sf::Texture texture;
+        SharedPtr<VideoFrame> current;
+        UniquePtr<SerialTask> task;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Array<Side, SIDE_COUNT> mSides;
+    Atomic<bool> mStop{false};
+    bool mOpened;
+    bool mPlaying;
+    bool mShowNextPair;
+    bool mPendingStep;
+    double mDuration;
+
+    sf::Clock mClock;
+    double mClockBase;
+    double mPositionBase;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open both files and start decoding their first frames
+    ///
+    /// \param reference File driving the playback
+    /// \param other File matched against it
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ComparePlayer(const Path& reference, const Path& other);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~ComparePlayer();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, fills the queue of one side
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Decode(Side& side);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Present the next pair if both of its frames are decoded
+    ///
+    /// \return True if a pair was presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool PresentNextPair(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Upload a frame to the texture of its side
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void PresentFrame(Side& side, const SharedPtr<VideoFrame>& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Restart the playback clock from a position
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Rebase(double position);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Present the pair due, if any
+    ///
+    /// \return True if new frames were presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Seconds until Update has something to do, infinity if idle
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetNextUpdateDelay(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Play(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Pause(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void TogglePause(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True while playing
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPlaying(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Seek both files, the first pair at the target is shown even
+    ///        while paused
+    ///
+    /// \param seconds Position from the start of the files
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Seek(double seconds);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pause and show the next pair
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void StepForward(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pause and show the previous pair, by an exact seek
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void StepBackward(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if both files could be opened
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsOpen(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once the reference file has been played to the end
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsEndOfVideo(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Duration of the longest file in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetDuration(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Timestamp of the reference frame shown, in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetCurrentTime(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param side 0 for the reference file, 1 for the other
+    ///
+    /// \return Timestamp of the frame shown on that side, in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetFrameTime(size_t side) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param side 0 for the reference file, 1 for the other
+    ///
+    /// \return Texture holding the frame shown on that side
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Texture& GetTexture(size_t side) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param side 0 for the reference file, 1 for the other
+    ///
+    /// \return Media file of that side
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Path& GetFilePath(size_t side) const;
+};
+
+} // namespace Moon
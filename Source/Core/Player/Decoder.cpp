@@ -0,0 +1,683 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/Decoder.hpp"
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static constexpr int MAX_KEYFRAME_PROBE_PACKETS = 1024;
+
+///////////////////////////////////////////////////////////////////////////////
+Decoder::Decoder(void)
+    : mFormatContext(nullptr)
+    , mCodecContext(nullptr)
+    , mPacket(nullptr)
+    , mStreamIndex(-1)
+    , mAudioStreamIndex(-1)
+    , mSubtitleStreamIndex(-1)
+    , mEndOfFile(false)
+    , mStartPts(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+Decoder::~Decoder()
+{
+    Close();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::Open(const Path& filePath)
+{
+    return (Open(filePath, Options()));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Decoder::Decoder(Decoder&& other) noexcept
+    : Decoder()
+{
+    Swap(other);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Decoder& Decoder::operator=(Decoder&& other) noexcept
+{
+    if (this != &other) {
+        Close();
+        Swap(other);
+    }
+    return (*this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Decoder::Swap(Decoder& other) noexcept
+{
+    std::swap(mFormatContext, other.mFormatContext);
+    std::swap(mCodecContext, other.mCodecContext);
+    std::swap(mPacket, other.mPacket);
+    std::swap(mStreamIndex, other.mStreamIndex);
+    std::swap(mAudioStreamIndex, other.mAudioStreamIndex);
+    std::swap(mSubtitleStreamIndex, other.mSubtitleStreamIndex);
+    std::swap(mEndOfFile, other.mEndOfFile);
+    std::swap(mStartPts, other.mStartPts);
+    std::swap(mOptions, other.mOptions);
+    std::swap(mKeyframeIndex, other.mKeyframeIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::Open(const Path& filePath, const Options& options)
+{
+    if (!OpenInput(filePath, options) || !OpenCodec()) {
+        Close();
+        return (false);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::OpenInput(const Path& filePath, const Options& options)
+{
+    Close();
+    mOptions = options;
+
+    mFormatContext = avformat_alloc_context();
+    if (!mFormatContext) {
+        std::cerr << "Could not allocate format context" << std::endl;
+        return (false);
+    }
+
+    if (mOptions.interrupt) {
+        mFormatContext->interrupt_callback.callback = &Decoder::Interrupt;
+        mFormatContext->interrupt_callback.opaque = mOptions.interrupt.get();
+    }
+
+    if (avformat_open_input(
+        &mFormatContext, filePath.c_str(), nullptr, nullptr) != 0
+    ) {
+        std::cerr << "Could not open input file: " << filePath << std::endl;
+        return (false);
+    }
+
+    if (avformat_find_stream_info(mFormatContext, nullptr) < 0) {
+        std::cerr << "Could not find stream information" << std::endl;
+        Close();
+        return (false);
+    }
+
+    int streamIndex = mOptions.streamIndex;
+
+    if (streamIndex < 0) {
+        streamIndex = av_find_best_stream(
+            mFormatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    }
+
+    if (streamIndex < 0 ||
+        streamIndex >= static_cast<int>(mFormatContext->nb_streams) ||
+        mFormatContext->streams[streamIndex]->codecpar->codec_type !=
+        AVMEDIA_TYPE_VIDEO
+    ) {
+        std::cerr << "Could not find video stream" << std::endl;
+        Close();
+        return (false);
+    }
+
+    mPacket = av_packet_alloc();
+    if (!mPacket) {
+        std::cerr << "Could not allocate packet" << std::endl;
+        Close();
+        return (false);
+    }
+
+    AVStream* stream = mFormatContext->streams[streamIndex];
+
+    mStreamIndex = streamIndex;
+    mStartPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+    mEndOfFile = false;
+    ApplyDiscard();
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::Interrupt(void* opaque)
+{
+    return (*static_cast<Atomic<bool>*>(opaque) ? 1 : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::OpenCodec(void)
+{
+    if (!mFormatContext || !mPacket) {
+        return (false);
+    }
+    return (OpenCodec(mStreamIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::AdoptCodec(Decoder& previous)
+{
+    AVStream* previousStream = previous.GetStream();
+
+    if (!mFormatContext || !mPacket || !previous.mCodecContext ||
+        !previousStream ||
+        !IsCompatible(previousStream->codecpar, GetStream()->codecpar)
+    ) {
+        return (false);
+    }
+
+    // Flushing also leaves the draining state reached at end of file
+    avcodec_flush_buffers(previous.mCodecContext);
+
+    if (mCodecContext) {
+        avcodec_free_context(&mCodecContext);
+    }
+
+    mCodecContext = previous.mCodecContext;
+    mCodecContext->pkt_timebase = GetStream()->time_base;
+    previous.mCodecContext = nullptr;
+    mEndOfFile = false;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::IsCompatible(
+    const AVCodecParameters* first,
+    const AVCodecParameters* second
+)
+{
+    if (!first || !second) {
+        return (false);
+    }
+
+    return (
+        first->codec_id == second->codec_id &&
+        first->format == second->format &&
+        first->width == second->width &&
+        first->height == second->height &&
+        first->profile == second->profile &&
+        first->extradata_size == second->extradata_size && (
+            first->extradata_size == 0 || std::memcmp(
+                first->extradata, second->extradata,
+                static_cast<size_t>(first->extradata_size)) == 0
+        )
+    );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::OpenCodec(int streamIndex)
+{
+    if (streamIndex < 0 ||
+        streamIndex >= static_cast<int>(mFormatContext->nb_streams) ||
+        mFormatContext->streams[streamIndex]->codecpar->codec_type !=
+        AVMEDIA_TYPE_VIDEO
+    ) {
+        std::cerr << "Could not find video stream" << std::endl;
+        return (false);
+    }
+
+    AVStream* stream = mFormatContext->streams[streamIndex];
+    const AVCodec* codec = avcodec_find_decoder(stream->codecpar->codec_id);
+
+    if (!codec) {
+        std::cerr << "Could not find video decoder" << std::endl;
+        return (false);
+    }
+
+    AVCodecContext* codecContext = avcodec_alloc_context3(codec);
+
+    if (!codecContext) {
+        std::cerr << "Could not allocate video codec context" << std::endl;
+        return (false);
+    }
+
+    if (avcodec_parameters_to_context(codecContext, stream->codecpar) < 0) {
+        std::cerr << "Failed to copy video codec parameters to decoder context" << std::endl;
+        avcodec_free_context(&codecContext);
+        return (false);
+    }
+
+    codecContext->thread_count = mOptions.threads;
+    codecContext->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+    codecContext->pkt_timebase = stream->time_base;
+    codecContext->lowres = std::min(mOptions.lowres, (int)codec->max_lowres);
+
+    // Downscale as much as possible while staying above the requested width
+    while (mOptions.minWidth > 0 && codecContext->lowres < codec->max_lowres &&
+        (stream->codecpar->width >> (codecContext->lowres + 1)) >=
+        mOptions.minWidth
+    ) {
+        codecContext->lowres++;
+    }
+
+    if (mOptions.keyframesOnly) {
+        codecContext->skip_frame = AVDISCARD_NONKEY;
+    }
+
+    if (avcodec_open2(codecContext, codec, nullptr) < 0) {
+        std::cerr << "Could not open video codec" << std::endl;
+        avcodec_free_context(&codecContext);
+        return (false);
+    }
+
+    if (mCodecContext) {
+        avcodec_free_context(&mCodecContext);
+    }
+
+    mCodecContext = codecContext;
+    mStreamIndex = streamIndex;
+    mStartPts = stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Decoder::ApplyDiscard(void)
+{
+    for (unsigned int i = 0; i < mFormatContext->nb_streams; i++) {
+        int index = static_cast<int>(i);
+        bool selected = index == mStreamIndex ||
+            index == mAudioStreamIndex || index == mSubtitleStreamIndex;
+
+        mFormatContext->streams[i]->discard =
+            selected ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::SelectStreams(int video, int audio, int subtitle)
+{
+    if (!IsOpen()) {
+        return (false);
+    }
+
+    if (video != mStreamIndex) {
+        if (!OpenCodec(video)) {
+            return (false);
+        }
+        mEndOfFile = false;
+    }
+
+    mAudioStreamIndex = audio;
+    mSubtitleStreamIndex = subtitle;
+    ApplyDiscard();
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Decoder::Close(void)
+{
+    if (mPacket) {
+        av_packet_free(&mPacket);
+    }
+
+    if (mCodecContext) {
+        avcodec_free_context(&mCodecContext);
+    }
+
+    if (mFormatContext) {
+        avformat_close_input(&mFormatContext);
+    }
+
+    mStreamIndex = -1;
+    mAudioStreamIndex = -1;
+    mSubtitleStreamIndex = -1;
+    mEndOfFile = false;
+    mStartPts = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::IsOpen(void) const
+{
+    return (mFormatContext && mCodecContext && mPacket);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Decoder::Status Decoder::Decode(AVFrame* frame)
+{
+    if (!IsOpen()) {
+        return (Status::Error);
+    }
+
+    while (true) {
+        int ret = avcodec_receive_frame(mCodecContext, frame);
+
+        if (ret == 0) {
+            return (Status::Frame);
+        } else if (ret == AVERROR_EOF) {
+            return (Status::EndOfFile);
+        } else if (ret != AVERROR(EAGAIN)) {
+            return (Status::Error);
+        }
+
+        ret = av_read_frame(mFormatContext, mPacket);
+
+        if (ret < 0) {
+            if (ret != AVERROR_EOF && !avio_feof(mFormatContext->pb)) {
+                return (Status::Error);
+            }
+            if (mEndOfFile) {
+                return (Status::EndOfFile);
+            }
+            mEndOfFile = true;
+            avcodec_send_packet(mCodecContext, nullptr);
+            continue;
+        }
+
+        bool skip = mPacket->stream_index != mStreamIndex ||
+            (mOptions.keyframesOnly && !(mPacket->flags & AV_PKT_FLAG_KEY));
+
+        if (!skip) {
+            // Corrupted packets are dropped, the decoder resynchronizes
+            avcodec_send_packet(mCodecContext, mPacket);
+        }
+
+        av_packet_unref(mPacket);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::Seek(double seconds)
+{
+    return (SeekToPts(ToPts(seconds)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::SeekToPts(Int64 pts)
+{
+    if (!IsOpen()) {
+        return (false);
+    }
+
+    Optional<KeyframeIndex::Entry> keyframe = std::nullopt;
+    int ret = -1;
+
+    if (mKeyframeIndex && mKeyframeIndex->GetStreamIndex() == mStreamIndex) {
+        keyframe = mKeyframeIndex->Find(pts);
+    }
+
+    if (keyframe && keyframe->position >= 0) {
+        if (!(mFormatContext->iformat->flags & AVFMT_NO_BYTE_SEEK)) {
+            ret = av_seek_frame(mFormatContext, mStreamIndex,
+                keyframe->position, AVSEEK_FLAG_BYTE);
+        } else {
+            // Let the generic index of the demuxer land on the keyframe
+            av_add_index_entry(GetStream(), keyframe->position, keyframe->pts,
+                0, 0, AVINDEX_KEYFRAME);
+        }
+    }
+
+    if (ret < 0 && av_seek_frame(
+        mFormatContext, mStreamIndex, pts, AVSEEK_FLAG_BACKWARD) < 0
+    ) {
+        return (false);
+    }
+
+    avcodec_flush_buffers(mCodecContext);
+    mEndOfFile = false;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Decoder::SetKeyframeIndex(const SharedPtr<KeyframeIndex>& index)
+{
+    mKeyframeIndex = index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Int64 Decoder::FindKeyframeBefore(Int64 pts)
+{
+    if (!IsOpen() || pts == AV_NOPTS_VALUE || pts <= mStartPts) {
+        return (AV_NOPTS_VALUE);
+    }
+
+    if (mKeyframeIndex && mKeyframeIndex->GetStreamIndex() == mStreamIndex) {
+        Optional<KeyframeIndex::Entry> keyframe = mKeyframeIndex->Find(pts - 1);
+
+        if (keyframe) {
+            return (keyframe->pts);
+        }
+    }
+
+    AVStream* stream = GetStream();
+    Int64 step = std::max<Int64>(1, av_rescale_q(1, {1, 1}, stream->time_base));
+    Int64 target = pts - 1;
+
+    // Demuxers seek on their own index, which may be coarser than the
+    // keyframes or keyed on dts, so step back until we land before `pts`.
+    for (int attempt = 0; attempt < 8; attempt++) {
+        if (!SeekToPts(std::max(target, mStartPts))) {
+            break;
+        }
+
+        Int64 keyframe = AV_NOPTS_VALUE;
+
+        for (int i = 0; i < MAX_KEYFRAME_PROBE_PACKETS; i++) {
+            if (av_read_frame(mFormatContext, mPacket) < 0) {
+                break;
+            }
+
+            if (mPacket->stream_index == mStreamIndex &&
+                (mPacket->flags & AV_PKT_FLAG_KEY)
+            ) {
+                keyframe = mPacket->pts != AV_NOPTS_VALUE
+                    ? mPacket->pts : mPacket->dts;
+                av_packet_unref(mPacket);
+                break;
+            }
+
+            av_packet_unref(mPacket);
+        }
+
+        if (keyframe != AV_NOPTS_VALUE && keyframe < pts) {
+            return (keyframe);
+        }
+
+        if (target <= mStartPts) {
+            break;
+        }
+
+        target -= step << attempt;
+    }
+
+    return (AV_NOPTS_VALUE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Decoder::DecodeRange(
+    Int64 startPts,
+    Int64 endPts,
+    AVFrame* frame,
+    const Function<bool(AVFrame*)>& callback
+)
+{
+    if (!SeekToPts(startPts)) {
+        return (false);
+    }
+
+    while (true) {
+        Status status = Decode(frame);
+
+        if (status == Status::EndOfFile) {
+            return (true);
+        } else if (status == Status::Error) {
+            return (false);
+        }
+
+        Int64 pts = GetFramePts(frame);
+
+        if (pts != AV_NOPTS_VALUE && pts >= endPts) {
+            av_frame_unref(frame);
+            return (true);
+        }
+
+        if (pts != AV_NOPTS_VALUE && pts >= startPts && !callback(frame)) {
+            av_frame_unref(frame);
+            return (true);
+        }
+
+        av_frame_unref(frame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Int64 Decoder::GetFramePts(const AVFrame* frame)
+{
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+        return (frame->best_effort_timestamp);
+    }
+    return (frame->pts);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double Decoder::ToSeconds(Int64 pts) const
+{
+    if (!IsOpen() || pts == AV_NOPTS_VALUE) {
+        return (0.0);
+    }
+    return (av_q2d(GetStream()->time_base) * (pts - mStartPts));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Int64 Decoder::ToPts(double seconds) const
+{
+    if (!IsOpen()) {
+        return (0);
+    }
+    return (mStartPts + static_cast<Int64>(
+        seconds / av_q2d(GetStream()->time_base)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double Decoder::GetDuration(void) const
+{
+    if (mFormatContext && mFormatContext->duration != AV_NOPTS_VALUE) {
+        return (static_cast<double>(mFormatContext->duration) / AV_TIME_BASE);
+    }
+    return (0.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AVRational Decoder::GetFrameRate(void) const
+{
+    AVStream* stream = GetStream();
+
+    if (!stream) {
+        return (AVRational{0, 1});
+    }
+
+    AVRational rate = stream->avg_frame_rate;
+
+    if (rate.num <= 0 || rate.den <= 0) {
+        rate = stream->r_frame_rate;
+    }
+
+    if (rate.num <= 0 || rate.den <= 0) {
+        return (AVRational{0, 1});
+    }
+    return (rate);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double Decoder::GetFrameDuration(void) const
+{
+    if (!GetStream()) {
+        return (0.0);
+    }
+
+    AVRational rate = GetFrameRate();
+
+    if (rate.num <= 0) {
+        return (1.0 / 25.0);
+    }
+
+    return (1.0 / av_q2d(rate));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::GetWidth(void) const
+{
+    return (mCodecContext ? mCodecContext->width : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::GetHeight(void) const
+{
+    return (mCodecContext ? mCodecContext->height : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::GetStreamIndex(void) const
+{
+    return (mStreamIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::GetAudioStreamIndex(void) const
+{
+    return (mAudioStreamIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::FindAudioStream(int rank) const
+{
+    if (!mFormatContext) {
+        return (-1);
+    }
+
+    for (unsigned int i = 0; rank >= 0 && i < mFormatContext->nb_streams; i++) {
+        if (mFormatContext->streams[i]->codecpar->codec_type ==
+            AVMEDIA_TYPE_AUDIO && rank-- == 0
+        ) {
+            return (static_cast<int>(i));
+        }
+    }
+
+    // The audio that goes with the video stream, as players pick it
+    int index = av_find_best_stream(
+        mFormatContext, AVMEDIA_TYPE_AUDIO, -1, mStreamIndex, nullptr, 0);
+
+    return (index >= 0 ? index : -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int Decoder::GetSubtitleStreamIndex(void) const
+{
+    return (mSubtitleStreamIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AVStream* Decoder::GetStream(void) const
+{
+    if (!mFormatContext || mStreamIndex < 0) {
+        return (nullptr);
+    }
+    return (mFormatContext->streams[mStreamIndex]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<KeyframeIndex>& Decoder::GetKeyframeIndex(void) const
+{
+    return (mKeyframeIndex);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AVFormatContext* Decoder::GetFormatContext(void) const
+{
+    return (mFormatContext);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AVCodecContext* Decoder::GetCodecContext(void) const
+{
+    return (mCodecContext);
+}
+
+} // namespace Moon
@@ -0,0 +1,429 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+extern "C" {
+    #include <libavformat/avformat.h>
+    #include <libavcodec/avcodec.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Demuxer and decoder pair for the video stream of a file
+///
+/// Every subsystem that needs decoded pictures (playback, reverse playback,
+/// frame stepping, ...) owns its own Decoder so they never share FFmpeg
+/// contexts across threads.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Decoder
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Options applied when opening the codec
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Options
+    {
+        int threads = 0;            ///< Decoder threads, 0 for automatic
+        int lowres = 0;             ///< Power of two downscale in the codec
+        int minWidth = 0;           ///< Raise lowres down to this width
+        bool keyframesOnly = false; ///< Skip every non keyframe packet
+        int streamIndex = -1;       ///< Video stream, -1 for the best one
+        SharedPtr<Atomic<bool>> interrupt; ///< Set to abort blocking I/O
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Result of a decode call
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Status
+    {
+        Frame,
+        EndOfFile,
+        Error
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    AVFormatContext* mFormatContext;
+    AVCodecContext* mCodecContext;
+    AVPacket* mPacket;
+    int mStreamIndex;
+    int mAudioStreamIndex;
+    int mSubtitleStreamIndex;
+    bool mEndOfFile;
+    Int64 mStartPts;
+    Options mOptions;
+    SharedPtr<KeyframeIndex> mKeyframeIndex;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Decoder(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~Decoder();
+
+    Decoder(const Decoder&) = delete;
+    Decoder& operator=(const Decoder&) = delete;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take over the contexts of another decoder
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Decoder(Decoder&& other) noexcept;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Close this decoder and take over the contexts of another one
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Decoder& operator=(Decoder&& other) noexcept;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the codec of a video stream, replacing the current one
+    ///
+    /// \param streamIndex Index of the stream in the file
+    ///
+    /// \return True on success, the current codec is kept otherwise
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool OpenCodec(int streamIndex);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief FFmpeg interrupt callback, opaque is Options::interrupt
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static int Interrupt(void* opaque);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Make the demuxer drop the packets of unselected streams
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ApplyDiscard(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Exchange every context with another decoder
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Swap(Decoder& other) noexcept;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the file and the codec of its best video stream
+    ///
+    /// \param filePath Path of the media file
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(const Path& filePath);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the file and the codec of its best video stream
+    ///
+    /// \param filePath Path of the media file
+    /// \param options Codec options
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(const Path& filePath, const Options& options);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open and probe the file without opening a codec
+    ///
+    /// Either OpenCodec or AdoptCodec must follow before decoding.
+    ///
+    /// \param filePath Path of the media file
+    /// \param options Codec options
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool OpenInput(const Path& filePath, const Options& options);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the codec of the selected video stream
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool OpenCodec(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Reuse the codec of another decoder instead of opening one
+    ///
+    /// Saves the codec initialization, and its threads, when consecutive
+    /// files are encoded alike. The other decoder is left without a codec.
+    ///
+    /// \param previous Decoder whose codec is taken, usually at its end
+    ///
+    /// \return False if the codec parameters differ
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool AdoptCodec(Decoder& previous);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether a codec opened for some parameters can decode others
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static bool IsCompatible(
+        const AVCodecParameters* first,
+        const AVCodecParameters* second
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Change the streams read from the file
+    ///
+    /// Every other stream is discarded by the demuxer, which skips parsing
+    /// their packets altogether. Changing the video stream reopens the codec
+    /// only, seek afterwards to resume from a keyframe of the new stream.
+    ///
+    /// \param video Index of the video stream to decode
+    /// \param audio Index of the audio stream to keep, -1 for none
+    /// \param subtitle Index of the subtitle stream to keep, -1 for none
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool SelectStreams(int video, int audio, int subtitle);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Release every FFmpeg context
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Close(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if the decoder is ready to decode
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsOpen(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode the next frame in presentation order
+    ///
+    /// \param frame Frame receiving the picture, to be unreferenced by the
+    ///              caller
+    ///
+    /// \return Status::Frame when a picture was written in `frame`
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Status Decode(AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Seek to the keyframe at or before a position
+    ///
+    /// \param seconds Position from the start of the stream
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Seek(double seconds);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Seek to the keyframe at or before a stream timestamp
+    ///
+    /// \param pts Timestamp in the stream time base
+    ///
+    /// \return True on success
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool SeekToPts(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Use a keyframe index to seek, for files the demuxer cannot
+    ///        seek accurately
+    ///
+    /// The index is shared, it may still be filling up and is only used for
+    /// the positions it already covers.
+    ///
+    /// \param index Index of the decoded stream, nullptr to detach
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetKeyframeIndex(const SharedPtr<KeyframeIndex>& index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Find the last keyframe strictly before a timestamp
+    ///
+    /// Only the demuxer is used, the codec is flushed and the read position
+    /// is left undefined: seek again before decoding.
+    ///
+    /// \param pts Timestamp in the stream time base
+    ///
+    /// \return Keyframe timestamp, or AV_NOPTS_VALUE if there is none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Int64 FindKeyframeBefore(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode every frame whose timestamp is in [startPts, endPts)
+    ///
+    /// \param startPts First timestamp, usually a keyframe
+    /// \param endPts Timestamp where decoding stops
+    /// \param frame Scratch frame used for decoding
+    /// \param callback Called for each frame, return false to stop early
+    ///
+    /// \return False if the range could not be decoded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool DecodeRange(
+        Int64 startPts,
+        Int64 endPts,
+        AVFrame* frame,
+        const Function<bool(AVFrame*)>& callback
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Best timestamp available for a decoded frame
+    ///
+    /// \param frame Decoded frame
+    ///
+    /// \return Timestamp in the stream time base
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static Int64 GetFramePts(const AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert a stream timestamp to seconds from the stream start
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double ToSeconds(Int64 pts) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert seconds from the stream start to a stream timestamp
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Int64 ToPts(double seconds) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Duration of the file in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetDuration(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Nominal frame rate of the video stream, 0/1 if unknown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AVRational GetFrameRate(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Nominal duration of a frame in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetFrameDuration(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Width of the decoded pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetWidth(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Height of the decoded pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetHeight(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the decoded stream, -1 if closed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetStreamIndex(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the kept audio stream, -1 if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetAudioStreamIndex(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pick an audio stream of the file
+    ///
+    /// \param rank Position among the audio streams, negative or past the
+    ///             last one for the best stream
+    ///
+    /// \return Index of the audio stream, -1 if the file has none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int FindAudioStream(int rank) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the kept subtitle stream, -1 if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetSubtitleStreamIndex(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Decoded stream, nullptr if closed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AVStream* GetStream(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Keyframe index in use, nullptr if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<KeyframeIndex>& GetKeyframeIndex(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Underlying format context
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AVFormatContext* GetFormatContext(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Underlying codec context
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AVCodecContext* GetCodecContext(void) const;
+};
+
+} // namespace Moon
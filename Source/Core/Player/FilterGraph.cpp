@@ -0,0 +1,333 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/FilterGraph.hpp"
+extern "C" {
+    #include <libavfilter/buffersink.h>
+    #include <libavfilter/buffersrc.h>
+    #include <libavutil/mathematics.h>
+}
+#include <chrono>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static String ErrorString(int error)
+{
+    char buffer[AV_ERROR_MAX_STRING_SIZE] = {0};
+
+    av_make_error_string(buffer, sizeof(buffer), error);
+    return (String(buffer));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+FilterGraph::FilterGraph(void)
+    : mTimeBase({1, AV_TIME_BASE})
+    , mFrameRate({0, 1})
+    , mGraph(nullptr)
+    , mSource(nullptr)
+    , mSink(nullptr)
+    , mFailed(false)
+    , mDeinterlace(Deinterlace::Auto)
+    , mInterlaced(false)
+    , mThreads(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+FilterGraph::~FilterGraph()
+{
+    avfilter_graph_free(&mGraph);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FilterGraph::Build(const AVFrame* frame)
+{
+    avfilter_graph_free(&mGraph);
+    mSource = nullptr;
+    mSink = nullptr;
+    mInput = {frame->width, frame->height, frame->format,
+        frame->sample_aspect_ratio};
+    mError.clear();
+    mFailed = true;
+
+    mGraph = avfilter_graph_alloc();
+    if (!mGraph) {
+        mError = "Could not allocate filter graph";
+        return (false);
+    }
+
+    // Zero lets libavfilter pick one slice thread per core
+    mGraph->nb_threads = mThreads;
+    mGraph->thread_type = AVFILTER_THREAD_SLICE;
+
+    String description = GetGraphDescription();
+
+    AVRational aspect = frame->sample_aspect_ratio.num > 0
+        ? frame->sample_aspect_ratio : AVRational{1, 1};
+    String arguments =
+        "video_size=" + std::to_string(frame->width) + "x" +
+        std::to_string(frame->height) +
+        ":pix_fmt=" + std::to_string(frame->format) +
+        ":time_base=" + std::to_string(mTimeBase.num) + "/" +
+        std::to_string(mTimeBase.den) +
+        ":pixel_aspect=" + std::to_string(aspect.num) + "/" +
+        std::to_string(aspect.den);
+
+    if (mFrameRate.num > 0 && mFrameRate.den > 0) {
+        arguments += ":frame_rate=" + std::to_string(mFrameRate.num) + "/" +
+            std::to_string(mFrameRate.den);
+    }
+
+    int error = avfilter_graph_create_filter(&mSource,
+        avfilter_get_by_name("buffer"), "in", arguments.c_str(),
+        nullptr, mGraph);
+
+    if (error >= 0) {
+        error = avfilter_graph_create_filter(&mSink,
+            avfilter_get_by_name("buffersink"), "out", nullptr,
+            nullptr, mGraph);
+    }
+
+    AVFilterInOut* outputs = avfilter_inout_alloc();
+    AVFilterInOut* inputs = avfilter_inout_alloc();
+
+    if (error >= 0 && (!outputs || !inputs)) {
+        error = AVERROR(ENOMEM);
+    }
+
+    if (error >= 0) {
+        // The open ends of the description connect to the source and sink
+        outputs->name = av_strdup("in");
+        outputs->filter_ctx = mSource;
+        outputs->pad_idx = 0;
+        outputs->next = nullptr;
+        inputs->name = av_strdup("out");
+        inputs->filter_ctx = mSink;
+        inputs->pad_idx = 0;
+        inputs->next = nullptr;
+
+        error = avfilter_graph_parse_ptr(mGraph, description.c_str(),
+            &inputs, &outputs, nullptr);
+    }
+
+    if (error >= 0) {
+        error = avfilter_graph_config(mGraph, nullptr);
+    }
+
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+
+    if (error < 0) {
+        mError = "Invalid filters \"" + description + "\": " +
+            ErrorString(error);
+        std::cerr << mError << std::endl;
+        avfilter_graph_free(&mGraph);
+        mSource = nullptr;
+        mSink = nullptr;
+        return (false);
+    }
+
+    mFailed = false;
+    mStats.deinterlacing = description != mDescription;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String FilterGraph::GetGraphDescription(void) const
+{
+    if (!IsDeinterlacing()) {
+        return (mDescription);
+    }
+    if (mDescription.empty()) {
+        return (DEINTERLACER);
+    }
+    return (String(DEINTERLACER) + "," + mDescription);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::SetDescription(const String& description)
+{
+    if (description == mDescription) {
+        return;
+    }
+
+    mDescription = description;
+    mError.clear();
+    mFailed = false;
+    Reset();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const String& FilterGraph::GetDescription(void) const
+{
+    return (mDescription);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FilterGraph::IsDeinterlacing(void) const
+{
+    return (mDeinterlace == Deinterlace::On ||
+        (mDeinterlace == Deinterlace::Auto && mInterlaced));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::SetDeinterlace(Deinterlace mode)
+{
+    if (mode != mDeinterlace) {
+        mDeinterlace = mode;
+        mFailed = false;
+        Reset();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::SetThreads(int threads)
+{
+    mThreads = std::max(threads, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::Detect(const AVFrame* frame)
+{
+    if (!(frame->flags & AV_FRAME_FLAG_INTERLACED)) {
+        return;
+    }
+
+    mStats.interlaced++;
+
+    if (!mInterlaced) {
+        mInterlaced = true;
+        if (mDeinterlace == Deinterlace::Auto) {
+            mFailed = false;
+            Reset();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::SetTimeBase(AVRational timeBase)
+{
+    if (av_cmp_q(timeBase, mTimeBase) != 0) {
+        mTimeBase = timeBase;
+        Reset();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::SetFrameRate(AVRational frameRate)
+{
+    if (av_cmp_q(frameRate, mFrameRate) != 0) {
+        mFrameRate = frameRate;
+        Reset();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FilterGraph::IsEnabled(void) const
+{
+    return (!mDescription.empty() || IsDeinterlacing());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FilterGraph::Reset(void)
+{
+    avfilter_graph_free(&mGraph);
+    mSource = nullptr;
+    mSink = nullptr;
+    mStats.deinterlacing = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FilterGraph::Push(AVFrame* frame)
+{
+    if (!frame) {
+        return (mGraph && av_buffersrc_add_frame(mSource, nullptr) >= 0);
+    }
+
+    bool changed = frame->width != mInput.width ||
+        frame->height != mInput.height || frame->format != mInput.format ||
+        av_cmp_q(frame->sample_aspect_ratio, mInput.aspect) != 0;
+
+    // A description that failed is only retried on other pictures
+    if ((!mGraph && !mFailed) || changed) {
+        Build(frame);
+    }
+
+    if (!mGraph) {
+        return (false);
+    }
+
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+        frame->pts = frame->best_effort_timestamp;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int error = av_buffersrc_add_frame_flags(
+        mSource, frame, AV_BUFFERSRC_FLAG_KEEP_REF);
+
+    mStats.seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    mStats.inputs++;
+
+    if (error < 0) {
+        std::cerr << "Could not feed the filter graph: "
+            << ErrorString(error) << std::endl;
+        return (false);
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FilterGraph::Pull(AVFrame* frame)
+{
+    if (!mGraph) {
+        return (false);
+    }
+
+    // The filters run when the sink asks for a picture
+    auto start = std::chrono::steady_clock::now();
+    int error = av_buffersink_get_frame(mSink, frame);
+
+    mStats.seconds += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    if (error < 0) {
+        return (false);
+    }
+    mStats.outputs++;
+
+    // Filters may change the time base, callers read the best effort one
+    if (frame->pts != AV_NOPTS_VALUE) {
+        frame->pts = av_rescale_q(frame->pts,
+            av_buffersink_get_time_base(mSink), mTimeBase);
+    }
+    frame->best_effort_timestamp = frame->pts;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+AVRational FilterGraph::GetFrameRate(void) const
+{
+    if (!mSink) {
+        return (AVRational{0, 1});
+    }
+    return (av_buffersink_get_frame_rate(mSink));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const String& FilterGraph::GetError(void) const
+{
+    return (mError);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const FilterGraph::Stats& FilterGraph::GetStats(void) const
+{
+    return (mStats);
+}
+
+} // namespace Moon
@@ -0,0 +1,260 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+extern "C" {
+    #include <libavfilter/avfilter.h>
+    #include <libavutil/frame.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief libavfilter graph applied to decoded pictures
+///
+/// Built from a filter description in the ffmpeg -vf syntax, for example
+/// "hqdn3d,crop=iw-16:ih-16,transpose=1". The graph is created lazily from
+/// the first picture and rebuilt whenever the description or the picture
+/// geometry or format changes, so the decoder keeps going.
+/// With an empty description it is disabled and pictures should bypass it.
+///
+/// Interlaced pictures can be deinterlaced by a bwdif filter put ahead of
+/// the description, one frame per field. In Auto mode it is only inserted
+/// once Detect has seen a picture flagged interlaced by the decoder, and
+/// it passes progressive pictures of mixed streams through untouched.
+///
+/// Filters split their work over the graph's own slice threads. Output
+/// timestamps are given back in the time base of the input pictures, and
+/// the output frame rate, which filters like fps or a deinterlacer change,
+/// is read from the sink.
+/// A graph is not thread safe, use one per decoding thread.
+///
+///////////////////////////////////////////////////////////////////////////////
+class FilterGraph
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr const char* DEINTERLACER =
+        "bwdif=mode=send_field:parity=auto:deint=interlaced";
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief When to deinterlace
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Deinterlace
+    {
+        Off,
+        Auto,
+        On
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Counters since construction
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Stats
+    {
+        Uint64 inputs = 0;              ///< Pictures pushed
+        Uint64 interlaced = 0;          ///< Pictures flagged interlaced
+        Uint64 outputs = 0;             ///< Pictures pulled
+        double seconds = 0.0;           ///< Time spent pushing and pulling
+        bool deinterlacing = false;     ///< Whether the graph deinterlaces
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Properties of the input pictures the graph was built for
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Input
+    {
+        int width = 0;
+        int height = 0;
+        int format = -1;
+        AVRational aspect = {0, 1};
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    String mDescription;
+    AVRational mTimeBase;
+    AVRational mFrameRate;
+    AVFilterGraph* mGraph;
+    AVFilterContext* mSource;
+    AVFilterContext* mSink;
+    Input mInput;
+    String mError;
+    bool mFailed;
+    Deinterlace mDeinterlace;
+    bool mInterlaced;
+    int mThreads;
+    Stats mStats;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    FilterGraph(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~FilterGraph();
+
+    FilterGraph(const FilterGraph&) = delete;
+    FilterGraph& operator=(const FilterGraph&) = delete;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Build the graph for pictures like the given one
+    ///
+    /// \return False if the description is invalid
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Build(const AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Description with the deinterlacer when it applies
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    String GetGraphDescription(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether the deinterlacer goes in the graph
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsDeinterlacing(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Change the filters, applied from the next picture
+    ///
+    /// \param description Filters in the ffmpeg -vf syntax, empty for none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetDescription(const String& description);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Current filter description
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const String& GetDescription(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param mode When to deinterlace, Auto by default
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetDeinterlace(Deinterlace mode);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param threads Slice threads of the next graphs, 0 for one per core
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetThreads(int threads);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Look at a decoded picture before IsEnabled
+    ///
+    /// Turns deinterlacing on in Auto mode at the first interlaced picture.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Detect(const AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set the time base of the input timestamps
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetTimeBase(AVRational timeBase);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set the frame rate of the input pictures
+    ///
+    /// Lets rate changing filters report their output rate, a deinterlacer
+    /// sending one frame per field doubles it.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetFrameRate(AVRational frameRate);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if pictures have to go through the graph
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsEnabled(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Drop the pictures held by temporal filters, after a seek
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Reset(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Feed a decoded picture
+    ///
+    /// \param frame Picture, its pts is set to the best effort timestamp,
+    ///              nullptr to flush the graph at the end of the stream
+    ///
+    /// \return False if the graph could not be built or fed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Push(AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take the next filtered picture
+    ///
+    /// \param frame Receives the picture, to unref by the caller
+    ///
+    /// \return False when no picture is ready
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Pull(AVFrame* frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Frame rate of the pulled pictures, 0/1 when the graph is not
+    ///         built or the rate is unknown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    AVRational GetFrameRate(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Why the last graph could not be built, empty if it was
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const String& GetError(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Counters, to compute the cost per picture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Stats& GetStats(void) const;
+};
+
+} // namespace Moon
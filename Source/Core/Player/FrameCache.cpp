@@ -0,0 +1,169 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/FrameCache.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+FrameCache::FrameCache(Uint64 budget)
+    : mBudget(budget)
+    , mSize(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::Insert(const SharedPtr<VideoFrame>& frame)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    InsertLocked(frame);
+    EvictLocked();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::Insert(const Vector<SharedPtr<VideoFrame>>& frames)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    for (const auto& frame : frames) {
+        InsertLocked(frame);
+    }
+    EvictLocked();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameCache::Find(Int64 pts)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    auto it = mFrames.find(pts);
+
+    if (it == mFrames.end()) {
+        return (nullptr);
+    }
+    return (TouchLocked(it));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FrameCache::Contains(Int64 pts) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mFrames.find(pts) != mFrames.end());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameCache::FindBefore(Int64 pts)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    auto it = mFrames.lower_bound(pts);
+
+    if (it == mFrames.begin()) {
+        return (nullptr);
+    }
+    return (TouchLocked(std::prev(it)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameCache::FindAfter(Int64 pts)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    auto it = mFrames.upper_bound(pts);
+
+    if (it == mFrames.end()) {
+        return (nullptr);
+    }
+    return (TouchLocked(it));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::Erase(Int64 first, Int64 last)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    auto it = mFrames.lower_bound(first);
+
+    while (it != mFrames.end() && it->first < last) {
+        mSize -= it->second.frame->GetSize();
+        mUsage.erase(it->second.usage);
+        it = mFrames.erase(it);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::Clear(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    mFrames.clear();
+    mUsage.clear();
+    mSize = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::SetBudget(Uint64 budget)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    mBudget = budget;
+    EvictLocked();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 FrameCache::GetBudget(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mBudget);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 FrameCache::GetSize(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t FrameCache::GetCount(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mFrames.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::InsertLocked(const SharedPtr<VideoFrame>& frame)
+{
+    if (!frame || !frame->data) {
+        return;
+    }
+
+    auto it = mFrames.find(frame->pts);
+
+    if (it != mFrames.end()) {
+        mSize -= it->second.frame->GetSize();
+        mUsage.erase(it->second.usage);
+        mFrames.erase(it);
+    }
+
+    mUsage.push_front(frame->pts);
+    mFrames[frame->pts] = {frame, mUsage.begin()};
+    mSize += frame->GetSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameCache::TouchLocked(Map<Int64, Entry>::iterator it)
+{
+    mUsage.splice(mUsage.begin(), mUsage, it->second.usage);
+    return (it->second.frame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameCache::EvictLocked(void)
+{
+    while (mSize > mBudget && !mUsage.empty()) {
+        auto it = mFrames.find(mUsage.back());
+
+        mSize -= it->second.frame->GetSize();
+        mFrames.erase(it);
+        mUsage.pop_back();
+    }
+}
+
+} // namespace Moon
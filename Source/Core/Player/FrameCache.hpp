@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Thread safe cache of decoded frames ordered by timestamp
+///
+/// The cache is bounded by a memory budget in bytes. When a new frame does
+/// not fit, the least recently used frames are evicted first.
+///
+///////////////////////////////////////////////////////////////////////////////
+class FrameCache
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        SharedPtr<VideoFrame> frame;
+        List<Int64>::iterator usage;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Map<Int64, Entry> mFrames;
+    List<Int64> mUsage;
+    Uint64 mBudget;
+    Uint64 mSize;
+    mutable Mutex mMutex;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param budget Maximum amount of pixel memory in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit FrameCache(Uint64 budget);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Insert a frame, replacing any frame with the same timestamp
+    ///
+    /// \param frame Frame to insert
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Insert(const SharedPtr<VideoFrame>& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Insert several frames at once
+    ///
+    /// Readers either see none or all of the frames.
+    ///
+    /// \param frames Frames to insert
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Insert(const Vector<SharedPtr<VideoFrame>>& frames);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param pts Timestamp of the frame
+    ///
+    /// \return The frame with this exact timestamp, nullptr otherwise
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> Find(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Check for a frame without refreshing its usage
+    ///
+    /// \param pts Timestamp of the frame
+    ///
+    /// \return True if a frame with this exact timestamp is cached
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Contains(Int64 pts) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param pts Timestamp
+    ///
+    /// \return The last frame strictly before `pts`, nullptr otherwise
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> FindBefore(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param pts Timestamp
+    ///
+    /// \return The first frame strictly after `pts`, nullptr otherwise
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> FindAfter(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Remove every frame in [first, last)
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Erase(Int64 first, Int64 last);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Remove every frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Clear(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Change the memory budget, evicting frames if needed
+    ///
+    /// \param budget Maximum amount of pixel memory in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetBudget(Uint64 budget);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Maximum amount of pixel memory in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetBudget(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Pixel memory currently used in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetSize(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of cached frames
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetCount(void) const;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Insert a frame, the mutex must be held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void InsertLocked(const SharedPtr<VideoFrame>& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Mark an entry as the most recently used, the mutex must be held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> TouchLocked(Map<Int64, Entry>::iterator it);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Evict frames until the budget is met, the mutex must be held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void EvictLocked(void);
+};
+
+} // namespace Moon
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/FrameConverter.hpp"
+extern "C" {
+    #include <libavutil/imgutils.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+FrameConverter::FrameConverter(int flags, TaskScheduler::Priority priority)
+    : mSwsContext(nullptr)
+    , mFlags(flags)
+    , mPriority(priority)
+    , mScaled(nullptr)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+FrameConverter::~FrameConverter()
+{
+    if (mSwsContext) {
+        sws_freeContext(mSwsContext);
+        mSwsContext = nullptr;
+    }
+    av_frame_free(&mScaled);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameConverter::ConvertHdr(
+    const AVFrame* frame,
+    Int64 pts,
+    double timestamp,
+    int width,
+    int height
+)
+{
+    const AVFrame* source = frame;
+
+    if (width != frame->width || height != frame->height) {
+        if (!mScaled) {
+            mScaled = av_frame_alloc();
+        }
+        if (!mScaled) {
+            return (nullptr);
+        }
+
+        if (mScaled->width != width || mScaled->height != height) {
+            av_frame_unref(mScaled);
+            mScaled->width = width;
+            mScaled->height = height;
+            mScaled->format = AV_PIX_FMT_YUV420P10LE;
+            if (av_frame_get_buffer(mScaled, 0) < 0) {
+                av_frame_unref(mScaled);
+                return (nullptr);
+            }
+        }
+
+        mSwsContext = sws_getCachedContext(
+            mSwsContext,
+            frame->width, frame->height,
+            static_cast<AVPixelFormat>(frame->format),
+            width, height, AV_PIX_FMT_YUV420P10LE,
+            mFlags, nullptr, nullptr, nullptr
+        );
+
+        if (!mSwsContext) {
+            std::cerr << "Could not initialize SWS context" << std::endl;
+            return (nullptr);
+        }
+
+        sws_scale(
+            mSwsContext, frame->data, frame->linesize, 0, frame->height,
+            mScaled->data, mScaled->linesize
+        );
+        source = mScaled;
+    }
+
+    Uint8* buffer = static_cast<Uint8*>(
+        av_malloc(static_cast<size_t>(width) * height * 4));
+
+    if (!buffer) {
+        return (nullptr);
+    }
+
+    mToneMap.Apply(source, buffer, true, mPriority);
+
+    return (std::make_shared<VideoFrame>(
+        buffer, pts, timestamp,
+        static_cast<Uint32>(width), static_cast<Uint32>(height)
+    ));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameConverter::SetToneMapping(ToneMap::Curve curve)
+{
+    mToneMap.SetCurve(curve);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ToneMap::Curve FrameConverter::GetToneMapping(void) const
+{
+    return (mToneMap.GetCurve());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameConverter::Convert(
+    const AVFrame* frame,
+    Int64 pts,
+    double timestamp,
+    Uint32 width,
+    Uint32 height
+)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        return (nullptr);
+    }
+
+    int dstWidth = width ? static_cast<int>(width) : frame->width;
+    int dstHeight = height ? static_cast<int>(height) : frame->height;
+
+    if (mToneMap.Prepare(frame)) {
+        return (ConvertHdr(frame, pts, timestamp, dstWidth, dstHeight));
+    }
+
+    mSwsContext = sws_getCachedContext(
+        mSwsContext,
+        frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+        dstWidth, dstHeight, AV_PIX_FMT_RGBA,
+        mFlags, nullptr, nullptr, nullptr
+    );
+
+    if (!mSwsContext) {
+        std::cerr << "Could not initialize SWS context" << std::endl;
+        return (nullptr);
+    }
+
+    int numBytes = av_image_get_buffer_size(
+        AV_PIX_FMT_RGBA, dstWidth, dstHeight, 1);
+    Uint8* buffer = (Uint8*)av_malloc(numBytes);
+
+    if (!buffer) {
+        return (nullptr);
+    }
+
+    Uint8* dstData[4] = {nullptr};
+    int dstLinesize[4] = {0};
+
+    av_image_fill_arrays(
+        dstData, dstLinesize, buffer, AV_PIX_FMT_RGBA, dstWidth, dstHeight, 1
+    );
+
+    sws_scale(
+        mSwsContext, frame->data, frame->linesize, 0, frame->height,
+        dstData, dstLinesize
+    );
+
+    return (std::make_shared<VideoFrame>(
+        buffer, pts, timestamp,
+        static_cast<Uint32>(dstWidth), static_cast<Uint32>(dstHeight)
+    ));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameConverter::ConvertToFit(
+    const AVFrame* frame,
+    Int64 pts,
+    double timestamp,
+    Uint32 maxWidth,
+    Uint32 maxHeight
+)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        return (nullptr);
+    }
+
+    double scale = 1.0;
+
+    if (maxWidth > 0) {
+        scale = std::min(scale, static_cast<double>(maxWidth) / frame->width);
+    }
+    if (maxHeight > 0) {
+        scale = std::min(scale, static_cast<double>(maxHeight) / frame->height);
+    }
+
+    if (scale >= 1.0) {
+        return (Convert(frame, pts, timestamp));
+    }
+
+    // Even sizes keep chroma subsampled sources aligned in the scaler
+    Uint32 width = std::max<Uint32>(2, static_cast<Uint32>(
+        frame->width * scale) & ~1U);
+    Uint32 height = std::max<Uint32>(2, static_cast<Uint32>(
+        frame->height * scale) & ~1U);
+
+    return (Convert(frame, pts, timestamp, width, height));
+}
+
+} // namespace Moon
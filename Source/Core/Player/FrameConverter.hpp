@@ -0,0 +1,141 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/ToneMap.hpp"
+#include "Core/Player/VideoFrame.hpp"
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libswscale/swscale.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Convert decoded pictures to RGBA VideoFrames
+///
+/// The scaler is cached and only rebuilt when the source or destination
+/// geometry changes. A converter is not thread safe, use one per thread.
+///
+/// 10 bit PQ and HLG pictures go through a ToneMap instead, scaled first
+/// when needed to 10 bit 4:2:0 so that no precision is lost on the way.
+///
+///////////////////////////////////////////////////////////////////////////////
+class FrameConverter
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct SwsContext* mSwsContext;
+    int mFlags;
+    TaskScheduler::Priority mPriority;
+    ToneMap mToneMap;
+    AVFrame* mScaled;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param flags Scaler flags, SWS_BILINEAR by default
+    /// \param priority Class of the tone mapping strips, RealTime for
+    ///                 playback
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit FrameConverter(
+        int flags = SWS_BILINEAR,
+        TaskScheduler::Priority priority = TaskScheduler::Priority::RealTime
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~FrameConverter();
+
+    FrameConverter(const FrameConverter&) = delete;
+    FrameConverter& operator=(const FrameConverter&) = delete;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Tone map a picture accepted by ToneMap::Prepare
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> ConvertHdr(
+        const AVFrame* frame,
+        Int64 pts,
+        double timestamp,
+        int width,
+        int height
+    );
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Choose how HDR pictures are brought to SDR
+    ///
+    /// \param curve Tone curve, Off to convert them like any picture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetToneMapping(ToneMap::Curve curve);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Tone curve of HDR pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ToneMap::Curve GetToneMapping(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert a decoded picture
+    ///
+    /// \param frame Decoded picture
+    /// \param pts Timestamp stored in the result
+    /// \param timestamp Position in seconds stored in the result
+    /// \param width Destination width, 0 to keep the source width
+    /// \param height Destination height, 0 to keep the source height
+    ///
+    /// \return The converted frame, nullptr on failure
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> Convert(
+        const AVFrame* frame,
+        Int64 pts,
+        double timestamp,
+        Uint32 width = 0,
+        Uint32 height = 0
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert a decoded picture, scaled down to fit a box
+    ///
+    /// The aspect ratio is kept and pictures are never scaled up.
+    ///
+    /// \param frame Decoded picture
+    /// \param pts Timestamp stored in the result
+    /// \param timestamp Position in seconds stored in the result
+    /// \param maxWidth Width of the box, 0 for no limit
+    /// \param maxHeight Height of the box, 0 for no limit
+    ///
+    /// \return The converted frame, nullptr on failure
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> ConvertToFit(
+        const AVFrame* frame,
+        Int64 pts,
+        double timestamp,
+        Uint32 maxWidth,
+        Uint32 maxHeight
+    );
+};
+
+} // namespace Moon
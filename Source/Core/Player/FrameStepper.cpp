@@ -0,0 +1,412 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/FrameStepper.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+FrameStepper::FrameStepper(
+    const Path& filePath,
+    int streamIndex,
+    const SharedPtr<KeyframeIndex>& index,
+    Uint64 budget
+)
+    : mFilePath(filePath)
+    , mStreamIndex(streamIndex)
+    , mKeyframeIndex(index)
+    , mCache(budget)
+    , mConverter(SWS_BILINEAR, TaskScheduler::Priority::Interactive)
+    , mFrame(nullptr)
+    , mOpened(false)
+    , mFailed(false)
+    , mCursor(AV_NOPTS_VALUE)
+    , mActive(false)
+    , mDirty(false)
+    , mRestart(false)
+    , mFrameSize(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+FrameStepper::~FrameStepper()
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mStop = true;
+    }
+    mTask.Stop();
+
+    av_frame_free(&mFrame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FrameStepper::Open(void)
+{
+    if (mOpened || mFailed) {
+        return (mOpened);
+    }
+
+    Decoder::Options options;
+
+    options.streamIndex = mStreamIndex;
+    mFrame = av_frame_alloc();
+
+    if (!mFrame || !mDecoder.Open(mFilePath, options)) {
+        std::cerr << "Could not start frame stepping decoder" << std::endl;
+        mFailed = true;
+        return (false);
+    }
+    mDecoder.SetKeyframeIndex(mKeyframeIndex);
+
+    mFrameSize = static_cast<Uint64>(mDecoder.GetWidth()) *
+        static_cast<Uint64>(mDecoder.GetHeight()) * 4;
+    mOpened = true;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameStepper::Work(void)
+{
+    if (!Open()) {
+        return;
+    }
+
+    size_t window = 1;
+
+    // Add the frames of a GOP on each side of the cursor to the counts,
+    // which stop at the window
+    auto count = [&](const Gop& gop, Int64 cursor, size_t& before,
+        size_t& after
+    ) {
+        size_t earlier = 0;
+        size_t later = 0;
+
+        for (Int64 pts : gop.frames) {
+            earlier += pts < cursor;
+            later += pts > cursor;
+        }
+        before = std::min(window, before + earlier);
+        after = std::min(window, after + later);
+    };
+
+    // Decode the GOP starting at `start` unless its part of the window is
+    // cached, keeping only that part, and count its frames around `cursor`
+    auto ensureGop = [&](Int64 start, Int64 cursor, size_t& before,
+        size_t& after, Int64& end
+    ) {
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            auto it = mGops.find(start);
+
+            // Half a window is enough to skip decoding, so a GOP is not
+            // decoded again on every step
+            if (it != mGops.end() && IsGopCachedLocked(
+                it->second, cursor, before, after, window / 2 + 1)
+            ) {
+                count(it->second, cursor, before, after);
+                end = it->second.end;
+                return (true);
+            }
+        }
+
+        size_t keepBefore = window - before;
+        size_t keepAfter = window - after;
+        size_t keptAfter = 0;
+        Gop gop = {INT64_MAX, {}};
+        Vector<SharedPtr<VideoFrame>> frames;
+        List<AVFrame*> pictures;
+
+        auto convert = [&](const AVFrame* picture) {
+            Int64 pts = Decoder::GetFramePts(picture);
+            auto converted = mConverter.Convert(
+                picture, pts, mDecoder.ToSeconds(pts));
+
+            if (converted) {
+                frames.push_back(std::move(converted));
+            }
+        };
+
+        bool decoded = mDecoder.DecodeRange(start, INT64_MAX, mFrame,
+            [&](AVFrame* picture) {
+                Int64 pts = Decoder::GetFramePts(picture);
+
+                if (pts > start && (picture->flags & AV_FRAME_FLAG_KEY)) {
+                    gop.end = pts;
+                    return (false);
+                }
+                gop.frames.push_back(pts);
+
+                // The last frames before the cursor are only known at the
+                // end, the latest ones are held meanwhile
+                if (pts < cursor && keepBefore > 0) {
+                    pictures.push_back(av_frame_clone(picture));
+                    if (pictures.size() > keepBefore) {
+                        av_frame_free(&pictures.front());
+                        pictures.pop_front();
+                    }
+                } else if (pts == cursor || (pts > cursor &&
+                    keptAfter++ < keepAfter)
+                ) {
+                    convert(picture);
+                }
+                return (!IsInterrupted());
+            }
+        );
+
+        for (AVFrame* picture : pictures) {
+            if (picture && decoded && !IsInterrupted()) {
+                convert(picture);
+            }
+            av_frame_free(&picture);
+        }
+
+        if (!decoded || IsInterrupted()) {
+            return (false);
+        }
+
+        count(gop, cursor, before, after);
+        end = gop.end;
+
+        mCache.Insert(frames);
+        std::unique_lock<Mutex> lock(mMutex);
+        mGops[start] = std::move(gop);
+        PruneGopsLocked();
+        return (true);
+    };
+
+    while (true) {
+        Int64 cursor = AV_NOPTS_VALUE;
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            if (mStop || !(mActive && mDirty)) {
+                return;
+            }
+            mDirty = false;
+            mRestart = false;
+            cursor = mCursor;
+        }
+
+        if (cursor == AV_NOPTS_VALUE || mFrameSize == 0) {
+            continue;
+        }
+
+        // Both sides of the window fit in the budget with some slack
+        window = std::max<Uint64>(
+            1, mCache.GetBudget() * 2 / 5 / mFrameSize);
+        size_t before = 0;
+        size_t after = 0;
+        Int64 forward = INT64_MAX;
+        Int64 backward = mDecoder.FindKeyframeBefore(cursor + 1);
+
+        if (backward == AV_NOPTS_VALUE ||
+            !ensureGop(backward, cursor, before, after, forward)
+        ) {
+            continue;
+        }
+
+        bool forwardDone = false;
+        bool backwardDone = false;
+
+        while (!(forwardDone && backwardDone) && !IsInterrupted()) {
+            if (!forwardDone) {
+                if (after >= window || forward == INT64_MAX) {
+                    forwardDone = true;
+                } else if (!ensureGop(forward, cursor, before, after, forward)) {
+                    break;
+                }
+            }
+
+            if (!backwardDone) {
+                Int64 previous = AV_NOPTS_VALUE;
+                Int64 end = INT64_MAX;
+
+                if (before < window) {
+                    previous = mDecoder.FindKeyframeBefore(backward);
+                }
+
+                if (previous == AV_NOPTS_VALUE) {
+                    backwardDone = true;
+                } else if (!ensureGop(previous, cursor, before, after, end)) {
+                    break;
+                } else {
+                    backward = previous;
+                }
+            }
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FrameStepper::IsInterrupted(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mStop || mRestart || !mActive);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool FrameStepper::IsGopCachedLocked(
+    const Gop& gop,
+    Int64 cursor,
+    size_t before,
+    size_t after,
+    size_t window
+) const
+{
+    const Vector<Int64>& frames = gop.frames;
+    auto first = std::lower_bound(frames.begin(), frames.end(), cursor);
+    auto last = first;
+
+    if (last != frames.end() && *last == cursor) {
+        ++last;
+    }
+
+    first -= std::min<ptrdiff_t>(first - frames.begin(),
+        static_cast<ptrdiff_t>(window - std::min(window, before)));
+    last += std::min<ptrdiff_t>(frames.end() - last,
+        static_cast<ptrdiff_t>(window - std::min(window, after)));
+
+    for (auto it = first; it != last; ++it) {
+        if (!mCache.Contains(*it)) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameStepper::PruneGopsLocked(void)
+{
+    // GOPs that decoded to nothing are kept, they would only decode again
+    for (auto it = mGops.begin(); it != mGops.end();) {
+        const Vector<Int64>& frames = it->second.frames;
+
+        if (!frames.empty() && std::none_of(frames.begin(), frames.end(),
+            [this](Int64 pts){ return (mCache.Contains(pts)); })
+        ) {
+            it = mGops.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameStepper::SetCursor(Int64 pts)
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        if (pts == mCursor) {
+            return;
+        }
+        mCursor = pts;
+        mDirty = true;
+        mRestart = true;
+    }
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameStepper::SetActive(bool active)
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mActive = active;
+        mDirty = mDirty || active;
+        mRestart = mRestart || !active;
+    }
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> FrameStepper::Step(int direction)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    Int64 target = AV_NOPTS_VALUE;
+    auto gop = mGops.upper_bound(mCursor);
+
+    if (gop != mGops.begin() && mCursor < std::prev(gop)->second.end) {
+        --gop;
+        const Vector<Int64>& frames = gop->second.frames;
+
+        if (direction > 0) {
+            auto it = std::upper_bound(frames.begin(), frames.end(), mCursor);
+
+            if (it != frames.end()) {
+                target = *it;
+            } else if (gop->second.end == INT64_MAX) {
+                return (nullptr);
+            } else {
+                auto next = mGops.find(gop->second.end);
+
+                if (next != mGops.end() && !next->second.frames.empty()) {
+                    target = next->second.frames.front();
+                }
+            }
+        } else {
+            auto it = std::lower_bound(frames.begin(), frames.end(), mCursor);
+
+            if (it != frames.begin()) {
+                target = *std::prev(it);
+            } else if (gop != mGops.begin()) {
+                auto previous = std::prev(gop);
+
+                if (previous->second.end == gop->first &&
+                    !previous->second.frames.empty()
+                ) {
+                    target = previous->second.frames.back();
+                }
+            }
+        }
+    }
+
+    SharedPtr<VideoFrame> frame = nullptr;
+
+    if (target != AV_NOPTS_VALUE) {
+        frame = mCache.Find(target);
+    }
+
+    // A step only slides the window, the GOP being decoded is still useful;
+    // a miss means the worker is busy elsewhere and must start over
+    if (frame) {
+        mCursor = target;
+    } else {
+        mRestart = true;
+    }
+    mDirty = true;
+    lock.unlock();
+    mTask.Wake();
+
+    return (frame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void FrameStepper::SetBudget(Uint64 budget)
+{
+    mCache.SetBudget(budget);
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mDirty = true;
+    }
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 FrameStepper::GetBudget(void) const
+{
+    return (mCache.GetBudget());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 FrameStepper::GetSize(void) const
+{
+    return (mCache.GetSize());
+}
+
+} // namespace Moon
@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/FrameCache.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/SerialTask.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Frame by frame navigation around a cursor
+///
+/// While active, a scheduler task decodes whole GOPs on both sides of the
+/// cursor into an LRU FrameCache sized by a memory budget, so that stepping
+/// only costs a cache lookup and a texture upload.
+///
+/// Only the frames of a window around the cursor are converted and cached,
+/// the others are dropped while decoding, so a GOP longer than the budget
+/// never evicts the frames next to the cursor. A GOP is decoded again once
+/// the cursor has moved half a window and its part of the window is missing.
+///
+///////////////////////////////////////////////////////////////////////////////
+class FrameStepper
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr Uint64 DEFAULT_BUDGET = 512ULL * 1024 * 1024;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decoded GOP, [start, end) with the timestamps of its frames,
+    ///        cached or not
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Gop
+    {
+        Int64 end;
+        Vector<Int64> frames;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    int mStreamIndex;
+    SharedPtr<KeyframeIndex> mKeyframeIndex;
+    FrameCache mCache;
+
+    Decoder mDecoder;
+    FrameConverter mConverter;
+    AVFrame* mFrame;
+    bool mOpened;
+    bool mFailed;
+
+    Mutex mMutex;
+    Map<Int64, Gop> mGops;
+    Int64 mCursor;
+    bool mActive;
+    bool mDirty;
+    bool mRestart;
+    Uint64 mFrameSize;
+
+    Atomic<bool> mStop{false};
+
+    SerialTask mTask{
+        TaskScheduler::Priority::Interactive, [this]{ Work(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param filePath Path of the media file
+    /// \param streamIndex Video stream to decode, -1 for the best one
+    /// \param index Keyframe index of the file, may be nullptr
+    /// \param budget Memory budget of the decoded frame cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    FrameStepper(
+        const Path& filePath,
+        int streamIndex,
+        const SharedPtr<KeyframeIndex>& index,
+        Uint64 budget = DEFAULT_BUDGET
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~FrameStepper();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the decoder on first use
+    ///
+    /// \return True if the decoder is usable
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, refills the cache around the cursor
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether the current refill should be abandoned
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsInterrupted(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether the frames of a GOP within a window of the cursor are
+    ///        cached, the mutex must be held
+    ///
+    /// \param gop GOP to check
+    /// \param cursor Timestamp of the cursor
+    /// \param before Frames before the cursor held by nearer GOPs
+    /// \param after Frames after the cursor held by nearer GOPs
+    /// \param window Frames wanted on each side of the cursor
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsGopCachedLocked(const Gop& gop, Int64 cursor, size_t before,
+        size_t after, size_t window) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Forget the GOPs whose frames all left the cache, the mutex
+    ///        must be held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void PruneGopsLocked(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Move the cursor, usually to the frame currently shown
+    ///
+    /// \param pts Timestamp of the frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetCursor(Int64 pts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Enable or disable speculative decoding
+    ///
+    /// \param active True while paused, false during playback
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetActive(bool active);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Step one frame from the cursor and move the cursor there
+    ///
+    /// \param direction Positive to step forward, negative to step backward
+    ///
+    /// \return The frame, or nullptr if it is not decoded yet or the cursor
+    ///         is at either end of the file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> Step(int direction);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param budget Memory budget of the decoded frame cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetBudget(Uint64 budget);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Memory budget of the decoded frame cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetBudget(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Memory used by the decoded frame cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetSize(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,271 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/System/CacheDirectory.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+KeyframeIndex::KeyframeIndex(const Path& filePath, int streamIndex)
+    : mFilePath(filePath)
+    , mStreamIndex(streamIndex)
+    , mCoveredPts(AV_NOPTS_VALUE)
+    , mComplete(false)
+{
+    mTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ Work(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+KeyframeIndex::~KeyframeIndex()
+{
+    mStop = true;
+
+    if (mTask.valid()) {
+        mTask.wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool KeyframeIndex::IsNeeded(
+    const AVFormatContext* context,
+    const AVStream* stream
+)
+{
+    if (!context || !stream) {
+        return (false);
+    }
+
+    // Demuxers with timestamp discontinuities (MPEG-TS, MPEG-PS) seek by
+    // bisecting the file even when they expose a few index entries
+    return (
+        avformat_index_get_entries_count(stream) == 0 ||
+        (context->iformat->flags & AVFMT_TS_DISCONT)
+    );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int KeyframeIndex::Interrupt(void* opaque)
+{
+    return (static_cast<KeyframeIndex*>(opaque)->mStop ? 1 : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void KeyframeIndex::Work(void)
+{
+    if (Load()) {
+        return;
+    }
+
+    AVFormatContext* context = avformat_alloc_context();
+
+    if (!context) {
+        return;
+    }
+
+    context->interrupt_callback.callback = &KeyframeIndex::Interrupt;
+    context->interrupt_callback.opaque = this;
+
+    if (avformat_open_input(
+        &context, mFilePath.string().c_str(), nullptr, nullptr) < 0
+    ) {
+        std::cerr << "Could not open file for indexing" << std::endl;
+        return;
+    }
+
+    if (avformat_find_stream_info(context, nullptr) < 0 ||
+        mStreamIndex < 0 ||
+        mStreamIndex >= static_cast<int>(context->nb_streams)
+    ) {
+        avformat_close_input(&context);
+        return;
+    }
+
+    // Only the packets of the indexed stream are of interest
+    for (unsigned int i = 0; i < context->nb_streams; i++) {
+        context->streams[i]->discard = static_cast<int>(i) == mStreamIndex
+            ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+
+    AVPacket* packet = av_packet_alloc();
+    Vector<Entry> entries;
+    Int64 covered = AV_NOPTS_VALUE;
+    size_t count = 0;
+    int ret = 0;
+
+    while (packet && !mStop && (ret = av_read_frame(context, packet)) >= 0) {
+        if (packet->stream_index == mStreamIndex) {
+            Int64 dts = packet->dts != AV_NOPTS_VALUE
+                ? packet->dts : packet->pts;
+
+            // Packets come in decoding order, every keyframe decoded before
+            // `covered` has been seen
+            if (dts != AV_NOPTS_VALUE) {
+                covered = covered == AV_NOPTS_VALUE
+                    ? dts : std::max(covered, dts);
+            }
+
+            if ((packet->flags & AV_PKT_FLAG_KEY) && dts != AV_NOPTS_VALUE) {
+                entries.push_back({
+                    packet->pts != AV_NOPTS_VALUE ? packet->pts : dts,
+                    packet->pos
+                });
+            }
+        }
+        av_packet_unref(packet);
+
+        if (++count % PUBLISH_INTERVAL == 0) {
+            Publish(entries, covered);
+        }
+    }
+
+    Publish(entries, covered);
+
+    av_packet_free(&packet);
+    avformat_close_input(&context);
+
+    if (ret == AVERROR_EOF) {
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            mComplete = true;
+        }
+        Save();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void KeyframeIndex::Publish(Vector<Entry>& entries, Int64 coveredPts)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    for (const Entry& entry : entries) {
+        mEntries[entry.pts] = entry.position;
+    }
+    mCoveredPts = coveredPts;
+    entries.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Path KeyframeIndex::GetCachePath(void) const
+{
+    Path directory = GetCacheDirectory(mFilePath);
+
+    if (directory.empty()) {
+        return (Path());
+    }
+    return (directory /
+        ("keyframes-" + std::to_string(mStreamIndex) + ".txt"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool KeyframeIndex::Load(void)
+{
+    Path path = GetCachePath();
+    IfStream file(path);
+    String magic;
+    int version = 0;
+    size_t count = 0;
+
+    if (path.empty() || !file ||
+        !(file >> magic >> version >> count) ||
+        magic != CACHE_MAGIC || version != CACHE_VERSION
+    ) {
+        return (false);
+    }
+
+    Map<Int64, Int64> entries;
+    Int64 pts = 0;
+    Int64 position = 0;
+
+    while (entries.size() < count && file >> pts >> position) {
+        entries[pts] = position;
+    }
+
+    // A truncated file is rebuilt
+    if (entries.size() != count) {
+        return (false);
+    }
+
+    std::unique_lock<Mutex> lock(mMutex);
+    mEntries = std::move(entries);
+    mComplete = true;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void KeyframeIndex::Save(void) const
+{
+    Path path = GetCachePath();
+
+    if (path.empty()) {
+        return;
+    }
+
+    // Written aside then renamed, a reader never sees half a file
+    Path temporary = path;
+    temporary += ".tmp";
+
+    {
+        OfStream file(temporary);
+        std::unique_lock<Mutex> lock(mMutex);
+
+        file << CACHE_MAGIC << ' ' << CACHE_VERSION << ' '
+            << mEntries.size() << '\n';
+        for (const auto& [pts, position] : mEntries) {
+            file << pts << ' ' << position << '\n';
+        }
+
+        if (!file) {
+            std::cerr << "Could not write " << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<KeyframeIndex::Entry> KeyframeIndex::Find(Int64 pts) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    if (!mComplete && (mCoveredPts == AV_NOPTS_VALUE || pts > mCoveredPts)) {
+        return (std::nullopt);
+    }
+
+    auto it = mEntries.upper_bound(pts);
+
+    if (it == mEntries.begin()) {
+        return (std::nullopt);
+    }
+    --it;
+    return (Entry{it->first, it->second});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool KeyframeIndex::IsComplete(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mComplete);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t KeyframeIndex::GetCount(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mEntries.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int KeyframeIndex::GetStreamIndex(void) const
+{
+    return (mStreamIndex);
+}
+
+} // namespace Moon
@@ -0,0 +1,173 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+extern "C" {
+    #include <libavformat/avformat.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Keyframe positions of a video stream, built in the background
+///
+/// Containers such as MPEG-TS or raw elementary streams carry no seek index,
+/// and the demuxer has to guess by bisecting the file. A background task
+/// reads the packets of the file once, without decoding, and records where
+/// every keyframe starts. Lookups only answer for the part of the file that
+/// has been read, so decoders can rely on the index as it grows.
+///
+/// A complete index is saved in the cache directory of the file and loaded
+/// back the next time the file is opened, instead of reading it again.
+///
+///////////////////////////////////////////////////////////////////////////////
+class KeyframeIndex
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t PUBLISH_INTERVAL = 256;
+    static constexpr const char* CACHE_MAGIC = "moon-keyframes";
+    static constexpr int CACHE_VERSION = 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Indexed keyframe
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Entry
+    {
+        Int64 pts;                  ///< Timestamp in the stream time base
+        Int64 position;             ///< Byte offset of the packet, or -1
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    int mStreamIndex;
+    std::future<void> mTask;
+
+    mutable Mutex mMutex;
+    Map<Int64, Int64> mEntries;
+    Int64 mCoveredPts;
+    bool mComplete;
+
+    Atomic<bool> mStop{false};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start indexing a stream
+    ///
+    /// \param filePath Path of the media file
+    /// \param streamIndex Index of the video stream in the file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    KeyframeIndex(const Path& filePath, int streamIndex);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~KeyframeIndex();
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether the demuxer lacks a usable index for a stream
+    ///
+    /// \param context Opened format context
+    /// \param stream Stream to seek in
+    ///
+    /// \return True if building an index is worth it
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static bool IsNeeded(const AVFormatContext* context, const AVStream* stream);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Indexing task body
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Publish entries read so far
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Publish(Vector<Entry>& entries, Int64 coveredPts);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Path of the saved index in the cache directory
+    ///
+    /// \return The path, empty when there is no cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Path GetCachePath(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Load a complete index saved by an earlier run
+    ///
+    /// \return True if the index was loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Load(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Save the complete index to the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Save(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief AVIOInterruptCB callback aborting blocking reads on shutdown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static int Interrupt(void* opaque);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Find the last keyframe at or before a timestamp
+    ///
+    /// \param pts Timestamp in the stream time base
+    ///
+    /// \return The keyframe, nothing if it is not known yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<Entry> Find(Int64 pts) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once the whole file has been read
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsComplete(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of keyframes indexed so far
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetCount(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the indexed stream in the file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetStreamIndex(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,118 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/Loader.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+Loader::Loader(const Path& filePath, Callback callback)
+    : mFilePath(filePath)
+    , mCallback(std::move(callback))
+    , mInterrupt(std::make_shared<Atomic<bool>>(false))
+    , mFuture(mPromise.get_future())
+{
+    mTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Interactive, [this]{ Work(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Loader::~Loader()
+{
+    Cancel();
+
+    if (mTask.valid()) {
+        mTask.wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Loader::Work(void)
+{
+    auto source = std::make_unique<Source>(mFilePath);
+
+    source->options.interrupt = mInterrupt;
+
+    // Each stage takes a share of the overall progress, decoding the first
+    // frames being the longest one
+    bool opened = source->Open(nullptr, PREDECODED_FRAMES,
+        [this](Source::Stage stage, double completion) {
+            static constexpr double STARTS[] = {0.0, 0.4, 0.5, 1.0};
+
+            size_t step = static_cast<size_t>(stage);
+
+            mStage = stage;
+            mProgress = STARTS[step] + completion *
+                ((step + 1 < std::size(STARTS) ? STARTS[step + 1] : 1.0) -
+                STARTS[step]);
+        }
+    );
+
+    if (!opened) {
+        mStage = source->IsInterrupted()
+            ? Source::Stage::Cancelled : Source::Stage::Failed;
+        source.reset();
+    }
+
+    mPromise.set_value(std::move(source));
+
+    if (mCallback) {
+        mCallback(*this);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Loader::Cancel(void)
+{
+    if (!mTaken) {
+        *mInterrupt = true;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Loader::IsDone(void) const
+{
+    return (mTaken || mFuture.wait_for(std::chrono::seconds(0)) ==
+        std::future_status::ready);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+UniquePtr<Source> Loader::Take(void)
+{
+    if (mTaken.exchange(true)) {
+        return (nullptr);
+    }
+
+    UniquePtr<Source> source = mFuture.get();
+
+    // Cancelled after loading completed, the source would stay interrupted
+    if (*mInterrupt) {
+        mStage = Source::Stage::Cancelled;
+        return (nullptr);
+    }
+    return (source);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Source::Stage Loader::GetStage(void) const
+{
+    return (mStage);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double Loader::GetProgress(void) const
+{
+    return (mProgress);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Path& Loader::GetFilePath(void) const
+{
+    return (mFilePath);
+}
+
+} // namespace Moon
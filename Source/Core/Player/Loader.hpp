@@ -0,0 +1,132 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Source.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Open a Source on a scheduler task
+///
+/// Probing and decoder setup can take seconds on slow storage; the loader
+/// does them in the background and reports its progress, so the caller
+/// keeps rendering. Cancelling interrupts any blocking I/O.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Loader
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Called from the loading task once loading is over
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    using Callback = Function<void(Loader&)>;
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t PREDECODED_FRAMES = 8;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    Callback mCallback;
+    SharedPtr<Atomic<bool>> mInterrupt;
+    std::promise<UniquePtr<Source>> mPromise;
+    std::future<UniquePtr<Source>> mFuture;
+    std::future<void> mTask;
+
+    Atomic<Source::Stage> mStage{Source::Stage::Opening};
+    Atomic<double> mProgress{0.0};
+    Atomic<bool> mTaken{false};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start loading
+    ///
+    /// \param filePath Path of the media file
+    /// \param callback Called when the source is ready, failed or was
+    ///                 cancelled, may be nullptr
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit Loader(const Path& filePath, Callback callback = nullptr);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Cancel loading if needed and wait for the task
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~Loader();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Loading task body
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Abort loading, has no effect once the source is taken
+    ///
+    /// A source already loaded but not taken yet is dropped.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Cancel(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once Take no longer blocks
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsDone(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Get the loaded source, waiting for it if needed
+    ///
+    /// Can only be called once.
+    ///
+    /// \return The source, nullptr if loading failed or was cancelled
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    UniquePtr<Source> Take(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Current step of loading
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Source::Stage GetStage(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Overall completion between 0 and 1
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetProgress(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Path of the file being loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Path& GetFilePath(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,604 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/LoudnessScan.hpp"
+#include "Core/System/CacheDirectory.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Second order section, normalized so that a0 is 1
+///
+///////////////////////////////////////////////////////////////////////////////
+struct Biquad
+{
+    double b0;
+    double b1;
+    double b2;
+    double a1;
+    double a2;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Oversampling filter, one kernel per phase, oldest sample first
+///
+///////////////////////////////////////////////////////////////////////////////
+using Kernels = Array<
+    Array<float, LoudnessScan::OVERSAMPLING_TAPS>,
+    LoudnessScan::OVERSAMPLING
+>;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief BS.1770 pre-filter (high shelf) and RLB filter (high pass),
+///        derived for any sample rate as in libebur128
+///
+///////////////////////////////////////////////////////////////////////////////
+static Array<Biquad, 2> GetKWeighting(double rate)
+{
+    double k = std::tan(M_PI * 1681.974450955533 / rate);
+    double q = 0.7071752369554196;
+    double vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    Biquad shelf = {
+        (vh + vb * k / q + k * k) / a0,
+        2.0 * (k * k - vh) / a0,
+        (vh - vb * k / q + k * k) / a0,
+        2.0 * (k * k - 1.0) / a0,
+        (1.0 - k / q + k * k) / a0
+    };
+
+    k = std::tan(M_PI * 38.13547087602444 / rate);
+    q = 0.5003270373238773;
+    a0 = 1.0 + k / q + k * k;
+
+    Biquad highPass = {
+        1.0, -2.0, 1.0,
+        2.0 * (k * k - 1.0) / a0,
+        (1.0 - k / q + k * k) / a0
+    };
+    return (Array<Biquad, 2>{shelf, highPass});
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static Kernels GetOversamplingKernels(void)
+{
+    constexpr int taps = LoudnessScan::OVERSAMPLING_TAPS;
+    Kernels kernels;
+
+    // Hann windowed sinc, the output of phase p lies p / OVERSAMPLING after
+    // the sample in the middle of the window
+    for (int phase = 0; phase < LoudnessScan::OVERSAMPLING; phase++) {
+        double sum = 0.0;
+        double values[taps];
+
+        for (int t = 0; t < taps; t++) {
+            double d = t - taps / 2 + 1 -
+                static_cast<double>(phase) / LoudnessScan::OVERSAMPLING;
+            double sinc = d == 0.0 ? 1.0 : std::sin(M_PI * d) / (M_PI * d);
+            double window = 0.5 * (1.0 + std::cos(M_PI * d / (taps / 2)));
+
+            values[t] = std::abs(d) < taps / 2 ? sinc * window : 0.0;
+            sum += values[t];
+        }
+        for (int t = 0; t < taps; t++) {
+            kernels[phase][t] = static_cast<float>(values[t] / sum);
+        }
+    }
+    return (kernels);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Filter interleaved samples and add the squared outputs to `sums`
+///
+/// `state` holds the four delays of every channel, delay after delay.
+///
+///////////////////////////////////////////////////////////////////////////////
+static void FilterScalar(
+    const Array<Biquad, 2>& filters,
+    const float* samples,
+    size_t frames,
+    size_t channels,
+    double* state,
+    double* sums
+)
+{
+    const Biquad& f = filters[0];
+    const Biquad& g = filters[1];
+
+    for (size_t c = 0; c < channels; c++) {
+        double z0 = state[c];
+        double z1 = state[channels + c];
+        double z2 = state[2 * channels + c];
+        double z3 = state[3 * channels + c];
+        double sum = 0.0;
+
+        for (size_t i = 0; i < frames; i++) {
+            double x = samples[i * channels + c];
+            double y = f.b0 * x + z0;
+
+            z0 = f.b1 * x - f.a1 * y + z1;
+            z1 = f.b2 * x - f.a2 * y;
+
+            double w = g.b0 * y + z2;
+
+            z2 = g.b1 * y - g.a1 * w + z3;
+            z3 = g.b2 * y - g.a2 * w;
+            sum += w * w;
+        }
+
+        state[c] = z0;
+        state[channels + c] = z1;
+        state[2 * channels + c] = z2;
+        state[3 * channels + c] = z3;
+        sums[c] += sum;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Largest absolute value of the samples and of the interpolated
+///        points between them
+///
+/// `line` starts with OVERSAMPLING_TAPS - 1 samples of history.
+///
+///////////////////////////////////////////////////////////////////////////////
+static float PeakScalar(const float* line, size_t count, const Kernels& kernels)
+{
+    constexpr int taps = LoudnessScan::OVERSAMPLING_TAPS;
+    float peak = 0.f;
+
+    for (size_t i = 0; i < count; i++) {
+        peak = std::max(peak, std::fabs(line[i + taps - 1]));
+
+        for (int phase = 1; phase < LoudnessScan::OVERSAMPLING; phase++) {
+            float value = 0.f;
+
+            for (int t = 0; t < taps; t++) {
+                value += kernels[phase][t] * line[i + t];
+            }
+            peak = std::max(peak, std::fabs(value));
+        }
+    }
+    return (peak);
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static void FilterAvx2(
+    const Array<Biquad, 2>& filters,
+    const float* samples,
+    size_t frames,
+    size_t channels,
+    double* state,
+    double* sums
+)
+{
+    const Biquad& f = filters[0];
+    const Biquad& g = filters[1];
+    __m256d fb0 = _mm256_set1_pd(f.b0);
+    __m256d fb1 = _mm256_set1_pd(f.b1);
+    __m256d fb2 = _mm256_set1_pd(f.b2);
+    __m256d fa1 = _mm256_set1_pd(f.a1);
+    __m256d fa2 = _mm256_set1_pd(f.a2);
+    __m256d gb0 = _mm256_set1_pd(g.b0);
+    __m256d gb1 = _mm256_set1_pd(g.b1);
+    __m256d gb2 = _mm256_set1_pd(g.b2);
+    __m256d ga1 = _mm256_set1_pd(g.a1);
+    __m256d ga2 = _mm256_set1_pd(g.a2);
+
+    // The recursion is serial in time, so the lanes are channels
+    for (size_t c = 0; c < channels; c += 4) {
+        size_t lanes = std::min<size_t>(channels - c, 4);
+        __m128i mask32 = _mm_setr_epi32(
+            -1, lanes > 1 ? -1 : 0, lanes > 2 ? -1 : 0, lanes > 3 ? -1 : 0);
+        __m256i mask64 = _mm256_cvtepi32_epi64(mask32);
+        __m256d z0 = _mm256_maskload_pd(state + c, mask64);
+        __m256d z1 = _mm256_maskload_pd(state + channels + c, mask64);
+        __m256d z2 = _mm256_maskload_pd(state + 2 * channels + c, mask64);
+        __m256d z3 = _mm256_maskload_pd(state + 3 * channels + c, mask64);
+        __m256d sum = _mm256_setzero_pd();
+
+        for (size_t i = 0; i < frames; i++) {
+            __m256d x = _mm256_cvtps_pd(
+                _mm_maskload_ps(samples + i * channels + c, mask32));
+            __m256d y = _mm256_fmadd_pd(fb0, x, z0);
+
+            z0 = _mm256_fnmadd_pd(fa1, y, _mm256_fmadd_pd(fb1, x, z1));
+            z1 = _mm256_fnmadd_pd(fa2, y, _mm256_mul_pd(fb2, x));
+
+            __m256d w = _mm256_fmadd_pd(gb0, y, z2);
+
+            z2 = _mm256_fnmadd_pd(ga1, w, _mm256_fmadd_pd(gb1, y, z3));
+            z3 = _mm256_fnmadd_pd(ga2, w, _mm256_mul_pd(gb2, y));
+            sum = _mm256_fmadd_pd(w, w, sum);
+        }
+
+        alignas(32) double totals[4];
+
+        _mm256_maskstore_pd(state + c, mask64, z0);
+        _mm256_maskstore_pd(state + channels + c, mask64, z1);
+        _mm256_maskstore_pd(state + 2 * channels + c, mask64, z2);
+        _mm256_maskstore_pd(state + 3 * channels + c, mask64, z3);
+        _mm256_store_pd(totals, sum);
+        for (size_t lane = 0; lane < lanes; lane++) {
+            sums[c + lane] += totals[lane];
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static float PeakAvx2(
+    const float* line,
+    size_t count,
+    const Kernels& kernels
+)
+{
+    constexpr int taps = LoudnessScan::OVERSAMPLING_TAPS;
+    __m256 sign = _mm256_set1_ps(-0.f);
+    __m256 peak = _mm256_setzero_ps();
+    size_t i = 0;
+
+    // Eight consecutive outputs of a phase at once
+    for (; i + 8 <= count; i += 8) {
+        peak = _mm256_max_ps(peak, _mm256_andnot_ps(sign,
+            _mm256_loadu_ps(line + i + taps - 1)));
+
+        for (int phase = 1; phase < LoudnessScan::OVERSAMPLING; phase++) {
+            __m256 value = _mm256_setzero_ps();
+
+            for (int t = 0; t < taps; t++) {
+                value = _mm256_fmadd_ps(_mm256_set1_ps(kernels[phase][t]),
+                    _mm256_loadu_ps(line + i + t), value);
+            }
+            peak = _mm256_max_ps(peak, _mm256_andnot_ps(sign, value));
+        }
+    }
+
+    alignas(32) float lanes[8];
+    float result = PeakScalar(line + i, count - i, kernels);
+
+    _mm256_store_ps(lanes, peak);
+    for (float lane : lanes) {
+        result = std::max(result, lane);
+    }
+    return (result);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+static void Filter(
+    const Array<Biquad, 2>& filters,
+    const float* samples,
+    size_t frames,
+    size_t channels,
+    double* state,
+    double* sums
+)
+{
+#if MOON_X86
+    if (HasAvx2()) {
+        FilterAvx2(filters, samples, frames, channels, state, sums);
+        return;
+    }
+#endif
+    FilterScalar(filters, samples, frames, channels, state, sums);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static float Peak(const float* line, size_t count, const Kernels& kernels)
+{
+#if MOON_X86
+    if (HasAvx2()) {
+        return (PeakAvx2(line, count, kernels));
+    }
+#endif
+    return (PeakScalar(line, count, kernels));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double ToLoudness(double energy)
+{
+    return (-0.691 + 10.0 * std::log10(energy));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+LoudnessScan::LoudnessScan(const Path& filePath, int streamIndex)
+    : mFilePath(filePath)
+    , mStreamIndex(streamIndex)
+    , mComplete(false)
+{
+    mTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ Work(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+LoudnessScan::~LoudnessScan()
+{
+    mStop = true;
+
+    if (mTask.valid()) {
+        mTask.wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoudnessScan::Work(void)
+{
+    if (Load()) {
+        return;
+    }
+
+    AudioDecoder decoder;
+    AudioDecoder::Options options;
+
+    options.streamIndex = mStreamIndex;
+
+    if (!decoder.Open(mFilePath, options)) {
+        std::unique_lock<Mutex> lock(mMutex);
+        mComplete = true;
+        return;
+    }
+
+    size_t channels = static_cast<size_t>(decoder.GetChannels());
+    double rate = static_cast<double>(decoder.GetSampleRate());
+    double duration = decoder.GetDuration();
+    Array<Biquad, 2> filters = GetKWeighting(rate);
+    Kernels kernels = GetOversamplingKernels();
+
+    // Surround channels count 1.41 times, the LFE channel not at all
+    Vector<double> weights(channels, 1.0);
+    const AVChannelLayout& layout = decoder.GetChannelLayout();
+
+    for (size_t c = 0; c < channels; c++) {
+        AVChannel channel = av_channel_layout_channel_from_index(
+            &layout, static_cast<unsigned int>(c));
+
+        if (channel == AV_CHAN_LOW_FREQUENCY) {
+            weights[c] = 0.0;
+        } else if (channel == AV_CHAN_SIDE_LEFT ||
+            channel == AV_CHAN_SIDE_RIGHT ||
+            channel == AV_CHAN_BACK_LEFT ||
+            channel == AV_CHAN_BACK_RIGHT
+        ) {
+            weights[c] = 1.41;
+        }
+    }
+
+    size_t blockFrames = std::max<size_t>(1,
+        static_cast<size_t>(std::lround(rate / 10.0)));
+    size_t filled = 0;
+    Vector<double> state(4 * channels, 0.0);
+    Vector<double> sums(channels, 0.0);
+    Vector<double> energies;
+    Vector<Vector<float>> histories(channels,
+        Vector<float>(OVERSAMPLING_TAPS - 1, 0.f));
+    Vector<float> line;
+    Vector<float> samples;
+    float peak = 0.f;
+    AudioDecoder::Status status = AudioDecoder::Status::Frame;
+
+    while (!mStop &&
+        (status = decoder.Decode(samples)) == AudioDecoder::Status::Frame
+    ) {
+        size_t frames = samples.size() / channels;
+
+        for (size_t offset = 0; offset < frames;) {
+            size_t count = std::min(frames - offset, blockFrames - filled);
+
+            Filter(filters, samples.data() + offset * channels, count,
+                channels, state.data(), sums.data());
+            filled += count;
+            offset += count;
+
+            if (filled == blockFrames) {
+                double energy = 0.0;
+
+                for (size_t c = 0; c < channels; c++) {
+                    energy += weights[c] * sums[c];
+                }
+                energies.push_back(energy / blockFrames);
+                std::fill(sums.begin(), sums.end(), 0.0);
+                filled = 0;
+            }
+        }
+
+        for (size_t c = 0; c < channels; c++) {
+            Vector<float>& history = histories[c];
+
+            line.assign(history.begin(), history.end());
+            for (size_t i = 0; i < frames; i++) {
+                line.push_back(samples[i * channels + c]);
+            }
+            peak = std::max(peak, Peak(line.data(), frames, kernels));
+            history.assign(line.end() - (OVERSAMPLING_TAPS - 1), line.end());
+        }
+
+        if (duration > 0.0) {
+            mProgress = std::min(decoder.GetTimestamp() / duration, 1.0);
+        }
+    }
+
+    if (mStop) {
+        return;
+    }
+
+    Optional<double> integrated = Integrate(energies);
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+
+        if (integrated) {
+            mResult = Result{*integrated, 20.0 * std::log10(peak)};
+        }
+        mComplete = true;
+    }
+
+    // A decoding error would save the loudness of part of the file
+    if (status == AudioDecoder::Status::EndOfFile) {
+        Save();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<double> LoudnessScan::Integrate(const Vector<double>& energies)
+{
+    if (energies.empty()) {
+        return (std::nullopt);
+    }
+
+    // 400 ms blocks every 100 ms, or a single shorter one
+    Vector<double> blocks;
+
+    for (size_t i = 0; i + 4 <= energies.size(); i++) {
+        blocks.push_back((energies[i] + energies[i + 1] +
+            energies[i + 2] + energies[i + 3]) / 4.0);
+    }
+    if (blocks.empty()) {
+        double sum = 0.0;
+
+        for (double energy : energies) {
+            sum += energy;
+        }
+        blocks.push_back(sum / energies.size());
+    }
+
+    auto gatedMean = [&](double gate) -> Optional<double> {
+        double sum = 0.0;
+        size_t count = 0;
+
+        for (double block : blocks) {
+            if (block > 0.0 && ToLoudness(block) > gate) {
+                sum += block;
+                count++;
+            }
+        }
+        if (count == 0) {
+            return (std::nullopt);
+        }
+        return (sum / count);
+    };
+
+    Optional<double> absolute = gatedMean(ABSOLUTE_GATE);
+
+    if (!absolute) {
+        return (std::nullopt);
+    }
+
+    Optional<double> relative = gatedMean(
+        std::max(ABSOLUTE_GATE, ToLoudness(*absolute) + RELATIVE_GATE));
+
+    return (ToLoudness(relative ? *relative : *absolute));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Path LoudnessScan::GetCachePath(void) const
+{
+    Path directory = GetCacheDirectory(mFilePath);
+
+    if (directory.empty()) {
+        return (Path());
+    }
+    return (directory /
+        ("loudness-" + std::to_string(mStreamIndex) + ".txt"));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool LoudnessScan::Load(void)
+{
+    Path path = GetCachePath();
+    IfStream file(path);
+    String magic;
+    int version = 0;
+    int measured = 0;
+    Result result = {0.0, 0.0};
+
+    if (path.empty() || !file ||
+        !(file >> magic >> version >> measured) ||
+        magic != CACHE_MAGIC || version != CACHE_VERSION ||
+        (measured && !(file >> result.integrated >> result.truePeak))
+    ) {
+        return (false);
+    }
+
+    std::unique_lock<Mutex> lock(mMutex);
+    if (measured) {
+        mResult = result;
+    }
+    mComplete = true;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void LoudnessScan::Save(void) const
+{
+    Path path = GetCachePath();
+
+    if (path.empty()) {
+        return;
+    }
+
+    // Written aside then renamed, a reader never sees half a file
+    Path temporary = path;
+    temporary += ".tmp";
+
+    {
+        OfStream file(temporary);
+        std::unique_lock<Mutex> lock(mMutex);
+
+        // Silent files are saved too, they are as slow to scan
+        file << CACHE_MAGIC << ' ' << CACHE_VERSION << ' '
+            << (mResult ? 1 : 0);
+        if (mResult) {
+            file << ' ' << mResult->integrated << ' ' << mResult->truePeak;
+        }
+        file << '\n';
+
+        if (!file) {
+            std::cerr << "Could not write " << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<LoudnessScan::Result> LoudnessScan::GetResult(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mResult);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<double> LoudnessScan::GetNormalizationGain(void) const
+{
+    Optional<Result> result = GetResult();
+
+    if (!result) {
+        return (std::nullopt);
+    }
+    return (std::min(TARGET_LOUDNESS - result->integrated,
+        TRUE_PEAK_CEILING - result->truePeak));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double LoudnessScan::GetProgress(void) const
+{
+    return (IsComplete() ? 1.0 : mProgress.load());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool LoudnessScan::IsComplete(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mComplete);
+}
+
+} // namespace Moon
@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/AudioDecoder.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Integrated loudness and true peak of a file, EBU R128 style
+///
+/// A background task decodes the audio, applies the K-weighting filters of
+/// ITU-R BS.1770 and keeps the weighted energy of every 100 ms. Blocks of
+/// 400 ms overlapping by 75% are then gated at -70 LUFS and 10 LU under
+/// their mean. The true peak is found on a 4x oversampled signal.
+///
+/// The filters run on up to four channels at once and the oversampling on
+/// eight outputs at once when the CPU has AVX2. The result is saved in the
+/// cache directory of the file.
+///
+///////////////////////////////////////////////////////////////////////////////
+class LoudnessScan
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr double TARGET_LOUDNESS = -23.0;
+    static constexpr double TRUE_PEAK_CEILING = -1.0;
+    static constexpr double ABSOLUTE_GATE = -70.0;
+    static constexpr double RELATIVE_GATE = -10.0;
+    static constexpr int OVERSAMPLING = 4;
+    static constexpr int OVERSAMPLING_TAPS = 12;
+    static constexpr const char* CACHE_MAGIC = "moon-loudness";
+    static constexpr int CACHE_VERSION = 2;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Measures of a file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Result
+    {
+        double integrated;          ///< Gated loudness in LUFS
+        double truePeak;            ///< Oversampled peak in dBTP
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    int mStreamIndex;
+    std::future<void> mTask;
+
+    mutable Mutex mMutex;
+    Optional<Result> mResult;
+    bool mComplete;
+
+    Atomic<bool> mStop{false};
+    Atomic<double> mProgress{0.0};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start measuring an audio stream, or load the saved result
+    ///
+    /// \param filePath Path of the media file
+    /// \param streamIndex Audio stream, -1 for the best one
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    LoudnessScan(const Path& filePath, int streamIndex);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~LoudnessScan();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Gated loudness of 100 ms energies
+    ///
+    /// \return The loudness, nothing if every block is under the gates
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static Optional<double> Integrate(const Vector<double>& energies);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Path of the saved result in the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Path GetCachePath(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Load a result saved by an earlier run
+    ///
+    /// \return True if a result was loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Load(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Save the result to the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Save(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return The measures, nothing until complete or for silent files
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<Result> GetResult(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Gain bringing the file to TARGET_LOUDNESS
+    ///
+    /// The gain is lowered so that the true peak stays under
+    /// TRUE_PEAK_CEILING.
+    ///
+    /// \return Gain in dB, nothing until the result is known
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<double> GetNormalizationGain(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Fraction of the file measured, between 0 and 1
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetProgress(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once the whole file was measured or loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsComplete(void) const;
+};
+
+} // namespace Moon
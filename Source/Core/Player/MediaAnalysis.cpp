@@ -0,0 +1,521 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/MediaAnalysis.hpp"
+#include "Core/System/CacheDirectory.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <cmath>
+extern "C" {
+    #include <libswscale/swscale.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static Uint64 SumAbsoluteDifferenceScalar(
+    const Uint8* a,
+    const Uint8* b,
+    size_t count
+)
+{
+    Uint64 sum = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        sum += static_cast<Uint64>(std::abs(a[i] - b[i]));
+    }
+    return (sum);
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static Uint64 SumAbsoluteDifferenceAvx2(
+    const Uint8* a,
+    const Uint8* b,
+    size_t count
+)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+
+    // psadbw sums 8 differences into each 64 bit lane
+    for (; i + 32 <= count; i += 32) {
+        __m256i pa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i pb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(pa, pb));
+    }
+
+    alignas(32) Uint64 lanes[4];
+    Uint64 total = 0;
+
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    for (Uint64 lane : lanes) {
+        total += lane;
+    }
+    return (total + SumAbsoluteDifferenceScalar(a + i, b + i, count - i));
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+static Uint64 SumAbsoluteDifference(const Uint8* a, const Uint8* b, size_t count)
+{
+#if MOON_X86
+    if (HasAvx2()) {
+        return (SumAbsoluteDifferenceAvx2(a, b, count));
+    }
+#endif
+    return (SumAbsoluteDifferenceScalar(a, b, count));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static bool ReadRanges(
+    IfStream& file,
+    const char* label,
+    Vector<MediaAnalysis::Range>& ranges
+)
+{
+    String name;
+    size_t count = 0;
+
+    if (!(file >> name >> count) || name != label) {
+        return (false);
+    }
+
+    ranges.resize(count);
+    for (MediaAnalysis::Range& range : ranges) {
+        if (!(file >> range.start >> range.end)) {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void WriteRanges(
+    OfStream& file,
+    const char* label,
+    const Vector<MediaAnalysis::Range>& ranges
+)
+{
+    file << label << ' ' << ranges.size() << '\n';
+    for (const MediaAnalysis::Range& range : ranges) {
+        file << range.start << ' ' << range.end << '\n';
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+MediaAnalysis::MediaAnalysis(const Path& filePath, double duration)
+    : mFilePath(filePath)
+    , mDuration(duration)
+    , mComplete(false)
+    , mInterrupt(std::make_shared<Atomic<bool>>(false))
+{
+    mTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ Start(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+MediaAnalysis::~MediaAnalysis()
+{
+    *mInterrupt = true;
+
+    // The scans are submitted by the start task, wait for it first
+    if (mTask.valid()) {
+        mTask.wait();
+    }
+    if (mVideoTask.valid()) {
+        mVideoTask.wait();
+    }
+    if (mAudioTask.valid()) {
+        mAudioTask.wait();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MediaAnalysis::Start(void)
+{
+    if (*mInterrupt || Load()) {
+        return;
+    }
+
+    mRunning = 2;
+    mVideoTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ ScanVideo(); });
+    mAudioTask = TaskScheduler::GetInstance().Submit(
+        TaskScheduler::Priority::Background, [this]{ ScanAudio(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MediaAnalysis::ScanVideo(void)
+{
+    Decoder decoder;
+    Decoder::Options options;
+
+    options.minWidth = SCAN_MIN_WIDTH;
+    options.interrupt = mInterrupt;
+
+    AVFrame* frame = av_frame_alloc();
+
+    if (!frame || !decoder.Open(mFilePath, options)) {
+        av_frame_free(&frame);
+        Finish();
+        return;
+    }
+
+    // Deblocking is a large share of the decoding time and barely changes
+    // the tiny pictures compared here
+    decoder.GetCodecContext()->skip_loop_filter = AVDISCARD_ALL;
+
+    constexpr size_t pixels = SCAN_WIDTH * SCAN_HEIGHT;
+    SwsContext* scaler = nullptr;
+    int scalerRange = -1;
+    Vector<Uint8> pictures[2] = {Vector<Uint8>(pixels), Vector<Uint8>(pixels)};
+    Array<Uint32, HISTOGRAM_BINS> histograms[2] = {};
+    int current = 0;
+    bool hasPrevious = false;
+    double previousDifference = 0.0;
+    double lastCut = -MIN_SCENE_LENGTH;
+    double end = 0.0;
+    Optional<double> blackStart;
+    Decoder::Status status = Decoder::Status::Frame;
+
+    while (!*mInterrupt &&
+        (status = decoder.Decode(frame)) == Decoder::Status::Frame
+    ) {
+        double timestamp = decoder.ToSeconds(Decoder::GetFramePts(frame));
+        int range = frame->color_range == AVCOL_RANGE_JPEG ? 1 : 0;
+
+        scaler = sws_getCachedContext(scaler, frame->width, frame->height,
+            static_cast<AVPixelFormat>(frame->format), SCAN_WIDTH, SCAN_HEIGHT,
+            AV_PIX_FMT_GRAY8, SWS_AREA, nullptr, nullptr, nullptr);
+
+        if (!scaler) {
+            std::cerr << "Could not create analysis scaler" << std::endl;
+            av_frame_unref(frame);
+            mFailed = true;
+            break;
+        }
+
+        // Full range grey, the black level then holds for every source
+        if (range != scalerRange) {
+            const int* coefficients = sws_getCoefficients(SWS_CS_DEFAULT);
+
+            sws_setColorspaceDetails(scaler, coefficients, range,
+                coefficients, 1, 0, 1 << 16, 1 << 16);
+            scalerRange = range;
+        }
+
+        Uint8* data[1] = {pictures[current].data()};
+        int stride[1] = {SCAN_WIDTH};
+
+        sws_scale(scaler, frame->data, frame->linesize, 0, frame->height,
+            data, stride);
+        av_frame_unref(frame);
+
+        const Uint8* picture = pictures[current].data();
+        Array<Uint32, HISTOGRAM_BINS>& histogram = histograms[current];
+        size_t black = 0;
+
+        histogram.fill(0);
+        for (size_t i = 0; i < pixels; i++) {
+            histogram[picture[i] * HISTOGRAM_BINS / 256]++;
+            black += picture[i] <= BLACK_LEVEL * 255.0 ? 1 : 0;
+        }
+
+        if (hasPrevious) {
+            const Uint8* previous = pictures[current ^ 1].data();
+            const Array<Uint32, HISTOGRAM_BINS>& other = histograms[current ^ 1];
+
+            // Mean absolute difference in percent, a cut is a jump of it
+            // rather than a high value, which continuous motion also has
+            double difference = 100.0 * static_cast<double>(
+                SumAbsoluteDifference(picture, previous, pixels)) /
+                (pixels * 255.0);
+            double score = std::min(difference,
+                std::abs(difference - previousDifference));
+            Uint32 moved = 0;
+
+            for (size_t i = 0; i < HISTOGRAM_BINS; i++) {
+                moved += histogram[i] > other[i]
+                    ? histogram[i] - other[i] : other[i] - histogram[i];
+            }
+
+            double change = static_cast<double>(moved) / (2.0 * pixels);
+
+            if (score > SCENE_THRESHOLD &&
+                change > SCENE_HISTOGRAM_THRESHOLD &&
+                timestamp - lastCut >= MIN_SCENE_LENGTH
+            ) {
+                std::unique_lock<Mutex> lock(mMutex);
+                mResults.scenes.push_back(timestamp);
+                lastCut = timestamp;
+            }
+            previousDifference = difference;
+        }
+
+        bool isBlack = black >= BLACK_RATIO * pixels;
+
+        if (isBlack && !blackStart) {
+            blackStart = timestamp;
+        } else if (!isBlack && blackStart) {
+            if (timestamp - *blackStart >= MIN_BLACK_DURATION) {
+                std::unique_lock<Mutex> lock(mMutex);
+                mResults.blacks.push_back({*blackStart, timestamp});
+            }
+            blackStart.reset();
+        }
+
+        end = timestamp + decoder.GetFrameDuration();
+        hasPrevious = true;
+        current ^= 1;
+        mVideoPosition = timestamp;
+    }
+
+    if (blackStart && end - *blackStart >= MIN_BLACK_DURATION) {
+        std::unique_lock<Mutex> lock(mMutex);
+        mResults.blacks.push_back({*blackStart, end});
+    }
+
+    if (status == Decoder::Status::Error) {
+        mFailed = true;
+    }
+
+    sws_freeContext(scaler);
+    av_frame_free(&frame);
+    Finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MediaAnalysis::ScanAudio(void)
+{
+    AudioDecoder decoder;
+
+    if (!decoder.Open(mFilePath)) {
+        Finish();
+        return;
+    }
+
+    mHasAudio = true;
+
+    size_t channels = static_cast<size_t>(decoder.GetChannels());
+    double rate = static_cast<double>(decoder.GetSampleRate());
+    Vector<float> samples;
+    Optional<double> silenceStart;
+    double end = 0.0;
+    AudioDecoder::Status status = AudioDecoder::Status::Frame;
+
+    while (!*mInterrupt &&
+        (status = decoder.Decode(samples)) == AudioDecoder::Status::Frame
+    ) {
+        double timestamp = decoder.GetTimestamp();
+        size_t count = samples.size() / channels;
+
+        for (size_t i = 0; i < count; i++) {
+            const float* sample = samples.data() + i * channels;
+            bool isSilent = true;
+
+            for (size_t c = 0; c < channels && isSilent; c++) {
+                isSilent = std::fabs(sample[c]) < SILENCE_LEVEL;
+            }
+
+            if (isSilent == silenceStart.has_value()) {
+                continue;
+            }
+
+            double position = timestamp + static_cast<double>(i) / rate;
+
+            if (isSilent) {
+                silenceStart = position;
+            } else {
+                if (position - *silenceStart >= MIN_SILENCE_DURATION) {
+                    std::unique_lock<Mutex> lock(mMutex);
+                    mResults.silences.push_back({*silenceStart, position});
+                }
+                silenceStart.reset();
+            }
+        }
+
+        end = timestamp + static_cast<double>(count) / rate;
+        mAudioPosition = end;
+    }
+
+    if (silenceStart && end - *silenceStart >= MIN_SILENCE_DURATION) {
+        std::unique_lock<Mutex> lock(mMutex);
+        mResults.silences.push_back({*silenceStart, end});
+    }
+
+    if (status == AudioDecoder::Status::Error) {
+        mFailed = true;
+    }
+    Finish();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MediaAnalysis::Finish(void)
+{
+    if (mRunning.fetch_sub(1) != 1 || *mInterrupt) {
+        return;
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mComplete = true;
+    }
+
+    // Partial results would hide the rest of the file on the next run
+    if (!mFailed) {
+        Save();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Path MediaAnalysis::GetCachePath(void) const
+{
+    Path directory = GetCacheDirectory(mFilePath);
+
+    if (directory.empty()) {
+        return (Path());
+    }
+    return (directory / "analysis.txt");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool MediaAnalysis::Load(void)
+{
+    Path path = GetCachePath();
+    IfStream file(path);
+    String magic;
+    int version = 0;
+    String name;
+    size_t count = 0;
+    Results results;
+
+    if (path.empty() || !file ||
+        !(file >> magic >> version) ||
+        magic != CACHE_MAGIC || version != CACHE_VERSION ||
+        !(file >> name >> count) || name != "scenes"
+    ) {
+        return (false);
+    }
+
+    results.scenes.resize(count);
+    for (double& scene : results.scenes) {
+        if (!(file >> scene)) {
+            return (false);
+        }
+    }
+
+    if (!ReadRanges(file, "blacks", results.blacks) ||
+        !ReadRanges(file, "silences", results.silences)
+    ) {
+        return (false);
+    }
+
+    std::unique_lock<Mutex> lock(mMutex);
+    mResults = std::move(results);
+    mComplete = true;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void MediaAnalysis::Save(void) const
+{
+    Path path = GetCachePath();
+
+    if (path.empty()) {
+        return;
+    }
+
+    // Written aside then renamed, a reader never sees half a file
+    Path temporary = path;
+    temporary += ".tmp";
+
+    {
+        OfStream file(temporary);
+        std::unique_lock<Mutex> lock(mMutex);
+
+        file.precision(17);
+        file << CACHE_MAGIC << ' ' << CACHE_VERSION << '\n';
+        file << "scenes " << mResults.scenes.size() << '\n';
+        for (double scene : mResults.scenes) {
+            file << scene << '\n';
+        }
+        WriteRanges(file, "blacks", mResults.blacks);
+        WriteRanges(file, "silences", mResults.silences);
+
+        if (!file) {
+            std::cerr << "Could not write " << temporary << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, path, error);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+MediaAnalysis::Results MediaAnalysis::GetResults(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mResults);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<double> MediaAnalysis::FindNextScene(double seconds) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    // A small slack so that the cut just seeked to is not found again
+    auto it = std::upper_bound(mResults.scenes.begin(), mResults.scenes.end(),
+        seconds + 0.001);
+
+    if (it == mResults.scenes.end()) {
+        return (std::nullopt);
+    }
+    return (*it);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double MediaAnalysis::FindPreviousScene(double seconds) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    auto it = std::lower_bound(mResults.scenes.begin(), mResults.scenes.end(),
+        seconds - PREVIOUS_SCENE_MARGIN);
+
+    if (it == mResults.scenes.begin()) {
+        return (0.0);
+    }
+    return (*std::prev(it));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double MediaAnalysis::GetProgress(void) const
+{
+    if (IsComplete()) {
+        return (1.0);
+    }
+
+    if (mDuration <= 0.0) {
+        return (0.0);
+    }
+
+    double position = mHasAudio
+        ? std::min(mVideoPosition.load(), mAudioPosition.load())
+        : mVideoPosition.load();
+
+    return (std::clamp(position / mDuration, 0.0, 1.0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool MediaAnalysis::IsComplete(void) const
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mComplete);
+}
+
+} // namespace Moon
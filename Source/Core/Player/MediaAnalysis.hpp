@@ -0,0 +1,209 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/AudioDecoder.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Scene cuts, black frames and silences of a file, found in the
+///        background
+///
+/// The video is decoded at reduced resolution (codec lowres and no loop
+/// filter), scaled down to a small grey picture and compared with the
+/// previous one: a cut needs both a jump of the mean absolute difference,
+/// as in FFmpeg's scdet, and a change of the luma histogram, which keeps
+/// fast motion and flashes out. The audio is decoded in a parallel task
+/// and scanned for runs of quiet samples.
+///
+/// Results are published as the scan goes and saved in the cache directory
+/// of the file, next to its keyframe index, once both scans are complete.
+///
+///////////////////////////////////////////////////////////////////////////////
+class MediaAnalysis
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int SCAN_WIDTH = 128;
+    static constexpr int SCAN_HEIGHT = 72;
+    static constexpr int SCAN_MIN_WIDTH = 160;
+    static constexpr size_t HISTOGRAM_BINS = 64;
+    static constexpr double SCENE_THRESHOLD = 10.0;
+    static constexpr double SCENE_HISTOGRAM_THRESHOLD = 0.25;
+    static constexpr double MIN_SCENE_LENGTH = 0.5;
+    static constexpr double PREVIOUS_SCENE_MARGIN = 0.5;
+    static constexpr double BLACK_LEVEL = 0.1;
+    static constexpr double BLACK_RATIO = 0.98;
+    static constexpr double MIN_BLACK_DURATION = 0.5;
+    static constexpr float SILENCE_LEVEL = 0.001f;
+    static constexpr double MIN_SILENCE_DURATION = 1.0;
+    static constexpr const char* CACHE_MAGIC = "moon-analysis";
+    static constexpr int CACHE_VERSION = 1;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Interval of the file, in seconds
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Range
+    {
+        double start;
+        double end;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Everything found so far, in increasing order
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Results
+    {
+        Vector<double> scenes;      ///< Timestamps of the first frame of a shot
+        Vector<Range> blacks;       ///< Runs of black frames
+        Vector<Range> silences;     ///< Runs of quiet audio
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    double mDuration;
+    std::future<void> mTask;
+    std::future<void> mVideoTask;
+    std::future<void> mAudioTask;
+
+    mutable Mutex mMutex;
+    Results mResults;
+    bool mComplete;
+
+    SharedPtr<Atomic<bool>> mInterrupt;
+    Atomic<int> mRunning{0};
+    Atomic<bool> mFailed{false};
+    Atomic<double> mVideoPosition{0.0};
+    Atomic<double> mAudioPosition{0.0};
+    Atomic<bool> mHasAudio{false};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start analyzing a file, or load the saved results
+    ///
+    /// \param filePath Path of the media file
+    /// \param duration Duration of the file in seconds, for the progress
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    MediaAnalysis(const Path& filePath, double duration);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~MediaAnalysis();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Load the saved results or start both scans
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Start(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Video task body, scene cuts and black frames
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ScanVideo(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Audio task body, silences
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ScanAudio(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Called by each scan when done, the last one saves
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Finish(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Path of the saved results in the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Path GetCachePath(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Load results saved by an earlier run
+    ///
+    /// \return True if the results were loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Load(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Save the complete results to the cache directory
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Save(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Copy of the results found so far
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Results GetResults(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief First scene cut after a position
+    ///
+    /// \param seconds Current position
+    ///
+    /// \return The cut, nothing if none is known
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<double> FindNextScene(double seconds) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start of the scene before a position
+    ///
+    /// Positions shortly after a cut go to the scene before, so that
+    /// repeated calls walk back through the scenes.
+    ///
+    /// \param seconds Current position
+    ///
+    /// \return The cut, or the start of the file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double FindPreviousScene(double seconds) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Fraction of the file scanned, between 0 and 1
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetProgress(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once both scans finished or the results were loaded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsComplete(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/Playlist.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+Playlist::Playlist(const Vector<Path>& items, bool loop)
+    : mItems(items)
+    , mLoop(loop)
+    , mPrevious(nullptr)
+    , mStop(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+Playlist::~Playlist()
+{
+    Stop();
+    mTask.Stop();
+
+    avcodec_parameters_free(&mPrevious);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Playlist::Work(void)
+{
+    while (true) {
+        size_t index = 0;
+        AVCodecParameters* previous = nullptr;
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            if (mStop || !mRequested) {
+                return;
+            }
+
+            index = *mRequested;
+            mRequested.reset();
+            mWorking = index;
+            std::swap(previous, mPrevious);
+        }
+
+        auto source = std::make_unique<Source>(mItems[index]);
+
+        if (!source->Open(previous, PREDECODED_FRAMES)) {
+            std::cerr << "Could not prepare " << mItems[index] << std::endl;
+            source.reset();
+        }
+        avcodec_parameters_free(&previous);
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            mWorking.reset();
+
+            // A newer request supersedes this one
+            if (!mRequested) {
+                mReady = index;
+                mPrepared = std::move(source);
+            }
+        }
+        mCV.notify_all();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Playlist::Prepare(size_t index, const AVCodecParameters* previous)
+{
+    if (index >= mItems.size()) {
+        return;
+    }
+
+    AVCodecParameters* copy = nullptr;
+
+    if (previous) {
+        copy = avcodec_parameters_alloc();
+        if (copy && avcodec_parameters_copy(copy, previous) < 0) {
+            avcodec_parameters_free(&copy);
+        }
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mRequested = index;
+        mReady.reset();
+        mPrepared.reset();
+        avcodec_parameters_free(&mPrevious);
+        mPrevious = copy;
+    }
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+UniquePtr<Source> Playlist::Take(size_t index)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    bool pending = mReady == index || mWorking == index || mRequested == index;
+
+    if (!pending) {
+        lock.unlock();
+        Prepare(index, nullptr);
+        lock.lock();
+    }
+
+    mCV.wait(lock, [this, index]{
+        return (mStop || (mReady == index && !mRequested));
+    });
+
+    if (mStop) {
+        return (nullptr);
+    }
+
+    mReady.reset();
+    return (std::move(mPrepared));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Playlist::Stop(void)
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCV.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<size_t> Playlist::GetNext(size_t index) const
+{
+    if (index + 1 < mItems.size()) {
+        return (index + 1);
+    } else if (mLoop && !mItems.empty()) {
+        return (0);
+    }
+    return (std::nullopt);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t Playlist::GetCount(void) const
+{
+    return (mItems.size());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const Path& Playlist::GetItem(size_t index) const
+{
+    return (mItems[index]);
+}
+
+} // namespace Moon
@@ -0,0 +1,136 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Source.hpp"
+#include "Core/System/SerialTask.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Ordered list of files played back to back
+///
+/// A scheduler task prepares the next Source while the current one
+/// plays, so a VideoPlayer can continue into it without any gap.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Playlist
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t PREDECODED_FRAMES = 4;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Vector<Path> mItems;
+    bool mLoop;
+
+    Mutex mMutex;
+    ConditionVariable mCV;
+    Optional<size_t> mRequested;
+    Optional<size_t> mWorking;
+    Optional<size_t> mReady;
+    AVCodecParameters* mPrevious;
+    UniquePtr<Source> mPrepared;
+    bool mStop;
+
+    SerialTask mTask{
+        TaskScheduler::Priority::Interactive, [this]{ Work(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param items Files to play, in order
+    /// \param loop Start over after the last file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Playlist(const Vector<Path>& items, bool loop);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~Playlist();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, prepares the requested item
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start preparing an item in the background
+    ///
+    /// Replaces any item prepared but not taken yet.
+    ///
+    /// \param index Index of the item
+    /// \param previous Codec parameters of the source it follows, nullptr
+    ///                 if none, copied
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Prepare(size_t index, const AVCodecParameters* previous);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Get a prepared item, waiting for it if needed
+    ///
+    /// \param index Index of the item
+    ///
+    /// \return The source, nullptr if it could not be opened or the
+    ///         playlist is stopping
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    UniquePtr<Source> Take(size_t index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Abort pending and future waits in Take
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Stop(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param index Index of an item
+    ///
+    /// \return Index of the item played after it, nothing at the end
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<size_t> GetNext(size_t index) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of items
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetCount(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param index Index of an item
+    ///
+    /// \return Path of the item
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const Path& GetItem(size_t index) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,272 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/ReversePlayback.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+ReversePlayback::ReversePlayback(
+    const Path& filePath,
+    int streamIndex,
+    const SharedPtr<KeyframeIndex>& index,
+    Int64 cursorPts,
+    Uint64 budget
+)
+    : mFilePath(filePath)
+    , mStreamIndex(streamIndex)
+    , mKeyframeIndex(index)
+    , mCache(budget)
+    , mCursor(cursorPts)
+    , mNextEnd(cursorPts)
+    , mInFlight(0)
+    , mGopSize(0)
+    , mReachedStart(false)
+{
+    for (size_t i = 0; i < WORKER_COUNT; i++) {
+        auto worker = std::make_unique<Worker>();
+        Worker* state = worker.get();
+
+        worker->task = std::make_unique<SerialTask>(
+            TaskScheduler::Priority::RealTime, [this, state]{ Work(*state); });
+        mWorkers.push_back(std::move(worker));
+    }
+    WakeWorkers();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ReversePlayback::~ReversePlayback()
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    for (auto& worker : mWorkers) {
+        worker->task->Stop();
+        av_frame_free(&worker->frame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ReversePlayback::Work(Worker& worker)
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        if (mStop || IsDrainedLocked()) {
+            return;
+        }
+    }
+
+    if (!worker.opened) {
+        Decoder::Options options;
+
+        options.streamIndex = mStreamIndex;
+        worker.frame = av_frame_alloc();
+
+        if (!worker.frame ||
+            !worker.decoder.Open(mFilePath, options)
+        ) {
+            std::cerr << "Could not start reverse playback worker" << std::endl;
+            std::unique_lock<Mutex> lock(mMutex);
+            mReachedStart = true;
+            mRemainders.clear();
+            return;
+        }
+        worker.decoder.SetKeyframeIndex(mKeyframeIndex);
+        worker.opened = true;
+    }
+
+    // A share of the budget per GOP, the ready and in flight ones plus the
+    // one being shown all fit
+    Uint64 frameSize = std::max<Uint64>(1,
+        static_cast<Uint64>(worker.decoder.GetWidth()) *
+        static_cast<Uint64>(worker.decoder.GetHeight()) * 4);
+    size_t maxFrames = static_cast<size_t>(std::max<Uint64>(1,
+        mCache.GetBudget() / (MAX_GOPS_AHEAD + 1) / frameSize));
+
+    while (true) {
+        Int64 start = AV_NOPTS_VALUE;
+        Int64 end = AV_NOPTS_VALUE;
+
+        {
+            // Keyframe discovery is serialized so every GOP is claimed once,
+            // but done outside of mMutex to never block the presenting thread
+            std::unique_lock<Mutex> schedule(mScheduleMutex);
+
+            {
+                std::unique_lock<Mutex> lock(mMutex);
+                if (mStop || IsDrainedLocked() || !HasRoomLocked()) {
+                    return;
+                }
+
+                // The rest of a split GOP is the closest to the cursor
+                if (!mRemainders.empty()) {
+                    auto remainder = std::prev(mRemainders.end());
+
+                    end = remainder->first;
+                    start = remainder->second;
+                    mRemainders.erase(remainder);
+                    mInFlight++;
+                } else {
+                    end = mNextEnd;
+                }
+            }
+
+            if (start == AV_NOPTS_VALUE) {
+                start = worker.decoder.FindKeyframeBefore(end);
+
+                std::unique_lock<Mutex> lock(mMutex);
+                if (start == AV_NOPTS_VALUE) {
+                    mReachedStart = true;
+                    return;
+                }
+                mNextEnd = start;
+                mInFlight++;
+            }
+        }
+
+        // Only the last frames are kept, the earlier ones are dropped while
+        // decoding and left for another pass
+        List<AVFrame*> pictures;
+        bool split = false;
+
+        worker.decoder.DecodeRange(start, end, worker.frame,
+            [&](AVFrame* decoded) {
+                AVFrame* picture = av_frame_clone(decoded);
+
+                if (picture) {
+                    pictures.push_back(picture);
+                }
+                if (pictures.size() > maxFrames) {
+                    av_frame_free(&pictures.front());
+                    pictures.pop_front();
+                    split = true;
+                }
+                return (!mStop);
+            }
+        );
+
+        Int64 first = split ? Decoder::GetFramePts(pictures.front()) : start;
+        Vector<SharedPtr<VideoFrame>> frames;
+        Uint64 size = 0;
+
+        for (AVFrame* picture : pictures) {
+            Int64 pts = Decoder::GetFramePts(picture);
+            auto converted = worker.converter.Convert(
+                picture, pts, worker.decoder.ToSeconds(pts));
+
+            if (converted) {
+                size += converted->GetSize();
+                frames.push_back(std::move(converted));
+            }
+            av_frame_free(&picture);
+        }
+
+        // The whole GOP becomes visible at once, so a partially decoded GOP
+        // is never mistaken for a complete one by NextFrame
+        mCache.Insert(frames);
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            mReadyGops[first] = end;
+            if (split && !mStop) {
+                mRemainders[first] = start;
+            }
+            mGopSize = std::max(mGopSize, size);
+            mInFlight--;
+        }
+        WakeWorkers();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ReversePlayback::WakeWorkers(void)
+{
+    for (auto& worker : mWorkers) {
+        worker->task->Wake();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ReversePlayback::HasRoomLocked(void) const
+{
+    if (mReadyGops.empty() && mInFlight == 0) {
+        return (true);
+    }
+    if (mReadyGops.size() + mInFlight >= MAX_GOPS_AHEAD) {
+        return (false);
+    }
+    return (mCache.GetSize() + (mInFlight + 1) * mGopSize <= mCache.GetBudget());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ReversePlayback::IsDrainedLocked(void) const
+{
+    return (mReachedStart && mRemainders.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<VideoFrame> ReversePlayback::NextFrame(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+
+    while (true) {
+        // The GOP holding the predecessor of the cursor has start < cursor
+        auto gop = mReadyGops.lower_bound(mCursor);
+
+        if (gop == mReadyGops.begin()) {
+            if (!(IsDrainedLocked() && mInFlight == 0)) {
+                mStallCount++;
+            }
+            return (nullptr);
+        }
+        --gop;
+
+        if (gop->second < mCursor) {
+            // A more distant GOP finished first, the one we need is pending
+            mStallCount++;
+            return (nullptr);
+        }
+
+        SharedPtr<VideoFrame> frame = mCache.FindBefore(mCursor);
+
+        if (!frame || frame->pts < gop->first) {
+            // Empty or evicted GOP, continue from the one before it
+            mCursor = gop->first;
+            mCache.Erase(mCursor, INT64_MAX);
+            mReadyGops.erase(gop);
+            WakeWorkers();
+            continue;
+        }
+
+        mCursor = frame->pts;
+        mCache.Erase(mCursor + 1, INT64_MAX);
+        mReadyGops.erase(mReadyGops.upper_bound(mCursor), mReadyGops.end());
+        WakeWorkers();
+
+        return (frame);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ReversePlayback::IsFinished(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (
+        IsDrainedLocked() && mInFlight == 0 &&
+        mReadyGops.lower_bound(mCursor) == mReadyGops.begin()
+    );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 ReversePlayback::GetStallCount(void) const
+{
+    return (mStallCount);
+}
+
+} // namespace Moon
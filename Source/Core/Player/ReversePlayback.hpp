@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/FrameCache.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/SerialTask.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Backward playback engine working one GOP at a time
+///
+/// Worker tasks walk the file backwards keyframe by keyframe, each one
+/// decoding a whole GOP with its own Decoder. Finished GOPs are published
+/// to a bounded FrameCache, from which frames are presented in decreasing
+/// timestamp order while the preceding GOPs are being prefetched.
+///
+/// A GOP with more frames than a share of the budget holds is split: only
+/// its last frames are kept, and the part before them is claimed again,
+/// decoding from the same keyframe. Long GOPs cost some decoding twice but
+/// never evict themselves from the cache.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ReversePlayback
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t WORKER_COUNT = 2;
+    static constexpr size_t MAX_GOPS_AHEAD = 3;
+    static constexpr Uint64 DEFAULT_BUDGET = 1536ULL * 1024 * 1024;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decoding state of a worker task
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Worker
+    {
+        Decoder decoder;
+        FrameConverter converter;
+        AVFrame* frame = nullptr;
+        bool opened = false;
+        UniquePtr<SerialTask> task;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    int mStreamIndex;
+    SharedPtr<KeyframeIndex> mKeyframeIndex;
+    FrameCache mCache;
+    Vector<UniquePtr<Worker>> mWorkers;
+
+    Mutex mScheduleMutex;
+    Mutex mMutex;
+    Map<Int64, Int64> mReadyGops;
+    Map<Int64, Int64> mRemainders;      ///< Parts of split GOPs, end to start
+    Int64 mCursor;
+    Int64 mNextEnd;
+    size_t mInFlight;
+    Uint64 mGopSize;
+    bool mReachedStart;
+
+    Atomic<bool> mStop{false};
+    Atomic<Uint64> mStallCount{0};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start decoding backwards from a position
+    ///
+    /// \param filePath Path of the media file
+    /// \param streamIndex Video stream to decode, -1 for the best one
+    /// \param index Keyframe index of the file, may be nullptr
+    /// \param cursorPts Timestamp of the frame currently shown, the first
+    ///                  frame returned is the one right before it
+    /// \param budget Memory budget of the decoded frame cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ReversePlayback(
+        const Path& filePath,
+        int streamIndex,
+        const SharedPtr<KeyframeIndex>& index,
+        Int64 cursorPts,
+        Uint64 budget = DEFAULT_BUDGET
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~ReversePlayback();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Worker task body, claims and decodes GOPs while there is room
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(Worker& worker);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Wake every worker after the room for GOPs changed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void WakeWorkers(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether another GOP may be decoded, the mutex must be held
+    ///
+    /// One is always admitted when none is ready or in flight, so that
+    /// playback goes on whatever the size of the GOPs.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool HasRoomLocked(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether every GOP has been claimed, the mutex must be held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsDrainedLocked(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take the frame preceding the last one returned
+    ///
+    /// \return The frame, or nullptr if its GOP is not decoded yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<VideoFrame> NextFrame(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once the first frame of the file has been returned
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsFinished(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of NextFrame calls that found no frame ready
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetStallCount(void) const;
+};
+
+} // namespace Moon
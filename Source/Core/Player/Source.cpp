@@ -0,0 +1,102 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/Source.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+Source::Source(const Path& filePath)
+    : filePath(filePath)
+    , maxWidth(0)
+    , maxHeight(0)
+    , sharesCodec(false)
+    , needsIndex(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Source::Open(
+    const AVCodecParameters* previous,
+    size_t frameCount,
+    const Progress& progress
+)
+{
+    auto report = [&](Stage stage, double completion) {
+        if (progress) {
+            progress(stage, completion);
+        }
+    };
+
+    report(Stage::Opening, 0.0);
+
+    if (!decoder.OpenInput(filePath, options)) {
+        return (false);
+    }
+
+    // Describe the file from the context just probed instead of probing twice
+    media = std::make_shared<Media>(filePath, decoder.GetFormatContext());
+    needsIndex = KeyframeIndex::IsNeeded(
+        decoder.GetFormatContext(), decoder.GetStream());
+
+    // Decoding ahead needs a codec of its own, the shared one only saves
+    // its setup when no frame is wanted ahead
+    sharesCodec = frameCount == 0 &&
+        Decoder::IsCompatible(previous, decoder.GetStream()->codecpar);
+
+    if (sharesCodec) {
+        report(Stage::Ready, 1.0);
+        return (true);
+    }
+
+    report(Stage::OpeningCodec, 0.0);
+
+    if (!decoder.OpenCodec()) {
+        return (false);
+    }
+
+    // Sources are opened ahead of playback, keep the real time workers free
+    FrameConverter converter(
+        SWS_BILINEAR, TaskScheduler::Priority::Interactive);
+    AVFrame* frame = av_frame_alloc();
+
+    report(Stage::Decoding, 0.0);
+
+    while (frame && frames.size() < frameCount && !IsInterrupted() &&
+        decoder.Decode(frame) == Decoder::Status::Frame
+    ) {
+        Int64 pts = Decoder::GetFramePts(frame);
+        SharedPtr<VideoFrame> converted = converter.ConvertToFit(
+            frame, pts, decoder.ToSeconds(pts), maxWidth, maxHeight);
+
+        av_frame_unref(frame);
+
+        if (converted) {
+            frames.push_back(std::move(converted));
+            report(Stage::Decoding,
+                static_cast<double>(frames.size()) / frameCount);
+        }
+    }
+
+    av_frame_free(&frame);
+
+    if (IsInterrupted()) {
+        return (false);
+    }
+
+    report(Stage::Ready, 1.0);
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool Source::IsInterrupted(void) const
+{
+    return (options.interrupt && *options.interrupt);
+}
+
+} // namespace Moon
@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Media/Media.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/Decoder.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief File opened and ready to be handed to a VideoPlayer
+///
+/// Everything slow about starting a file happens in Open: probing, opening
+/// the codec and decoding the first pictures. It can therefore run on any
+/// thread ahead of time, and the player only has to swap decoders.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Source
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Steps of opening a source
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Stage
+    {
+        Opening,        ///< Opening and probing the file
+        OpeningCodec,   ///< Setting up the decoder
+        Decoding,       ///< Decoding the first frames
+        Ready,
+        Failed,
+        Cancelled
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Called as Open advances, with the completion of the stage
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    using Progress = Function<void(Stage, double)>;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path filePath;
+    Decoder::Options options;
+    Uint32 maxWidth;        ///< Frames are scaled down to fit, 0 for no limit
+    Uint32 maxHeight;       ///< Frames are scaled down to fit, 0 for no limit
+    SharedPtr<Media> media;
+    Decoder decoder;
+    Vector<SharedPtr<VideoFrame>> frames;
+    bool sharesCodec;
+    bool needsIndex;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param filePath Path of the media file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit Source(const Path& filePath);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the file and decode its first frames
+    ///
+    /// \param previous Codec parameters of the source played before this
+    ///                 one, nullptr if none. When they match and no frame
+    ///                 is decoded ahead, no codec is opened and the decoder
+    ///                 must adopt the previous codec.
+    /// \param frameCount Number of frames to decode ahead
+    /// \param progress Called from this thread as opening advances, may be
+    ///                 nullptr
+    ///
+    /// \return True on success, false on error or when options.interrupt
+    ///         is set
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(
+        const AVCodecParameters* previous,
+        size_t frameCount,
+        const Progress& progress = nullptr
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True once options.interrupt is set
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsInterrupted(void) const;
+};
+
+} // namespace Moon
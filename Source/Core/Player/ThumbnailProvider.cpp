@@ -0,0 +1,263 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/ThumbnailProvider.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+ThumbnailProvider::ThumbnailProvider(
+    const Path& filePath,
+    const SharedPtr<KeyframeIndex>& index
+)
+    : mFilePath(filePath)
+    , mKeyframeIndex(index)
+    , mConverter(SWS_FAST_BILINEAR, TaskScheduler::Priority::Background)
+    , mFrame(nullptr)
+    , mFailed(false)
+    , mDecoding(false)
+    , mUsedSlots(0)
+{
+    mTask.Wake();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ThumbnailProvider::~ThumbnailProvider()
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        mStop = true;
+    }
+    mTask.Stop();
+
+    av_frame_free(&mFrame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ThumbnailProvider::Open(void)
+{
+    if (mOpened || mFailed) {
+        return (mOpened);
+    }
+
+    Decoder::Options options;
+
+    options.threads = 1;
+    options.minWidth = static_cast<int>(THUMBNAIL_WIDTH);
+    options.keyframesOnly = true;
+
+    mFrame = av_frame_alloc();
+    mFailed = true;
+
+    if (!mFrame || !mDecoder.Open(mFilePath, options)) {
+        return (false);
+    }
+
+    mDecoder.SetKeyframeIndex(mKeyframeIndex);
+
+    int width = mDecoder.GetWidth();
+    int height = mDecoder.GetHeight();
+
+    if (width <= 0 || height <= 0) {
+        return (false);
+    }
+
+    mBucketSeconds = std::max(1.0, mDecoder.GetDuration() / MAX_BUCKETS);
+    mWidth = THUMBNAIL_WIDTH;
+    mHeight = std::max<Uint32>(2, static_cast<Uint32>(
+        THUMBNAIL_WIDTH * height / width) & ~1U);
+    mFailed = false;
+    mOpened = true;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ThumbnailProvider::Work(void)
+{
+    if (!Open()) {
+        return;
+    }
+
+    while (true) {
+        Int64 bucket = 0;
+
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            if (mStop || !mRequest) {
+                return;
+            }
+            bucket = *mRequest;
+            mRequest.reset();
+            mDecoding = true;
+        }
+
+        SharedPtr<VideoFrame> thumbnail = nullptr;
+
+        if (mDecoder.Seek(bucket * mBucketSeconds)) {
+            while (mDecoder.Decode(mFrame) == Decoder::Status::Frame) {
+                Int64 pts = Decoder::GetFramePts(mFrame);
+
+                thumbnail = mConverter.Convert(
+                    mFrame, pts, mDecoder.ToSeconds(pts),
+                    mWidth, mHeight
+                );
+                av_frame_unref(mFrame);
+
+                if (thumbnail) {
+                    break;
+                }
+            }
+        }
+
+        std::unique_lock<Mutex> lock(mMutex);
+        mDecoding = false;
+        if (thumbnail) {
+            mReady.push_back({bucket, thumbnail});
+        } else {
+            mRequested.erase(bucket);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::IntRect ThumbnailProvider::GetSlotRect(Uint32 index) const
+{
+    return (sf::IntRect(
+        {
+            static_cast<int>((index % ATLAS_COLUMNS) * mWidth),
+            static_cast<int>((index / ATLAS_COLUMNS) * mHeight)
+        },
+        {static_cast<int>(mWidth), static_cast<int>(mHeight)}
+    ));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ThumbnailProvider::Update(void)
+{
+    if (!mOpened) {
+        return (false);
+    }
+
+    if (mAtlas.getSize().x < mWidth * ATLAS_COLUMNS) {
+        if (!mAtlas.resize({mWidth * ATLAS_COLUMNS, mHeight * ATLAS_ROWS})) {
+            std::cerr << "Could not create thumbnail atlas" << std::endl;
+            return (false);
+        }
+        mAtlas.setSmooth(true);
+    }
+
+    Vector<Pair<Int64, SharedPtr<VideoFrame>>> ready;
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        ready.swap(mReady);
+    }
+
+    for (auto& [bucket, thumbnail] : ready) {
+        Uint32 index = 0;
+
+        if (mUsedSlots < ATLAS_COLUMNS * ATLAS_ROWS) {
+            index = mUsedSlots++;
+        } else {
+            Int64 evicted = mUsage.back();
+
+            index = mSlots[evicted].index;
+            mSlots.erase(evicted);
+            mUsage.pop_back();
+
+            std::unique_lock<Mutex> lock(mMutex);
+            mRequested.erase(evicted);
+        }
+
+        sf::IntRect rect = GetSlotRect(index);
+
+        mAtlas.update(
+            thumbnail->data, {thumbnail->width, thumbnail->height},
+            {
+                static_cast<Uint32>(rect.position.x),
+                static_cast<Uint32>(rect.position.y)
+            }
+        );
+
+        mUsage.push_front(bucket);
+        mSlots[bucket] = {index, mUsage.begin()};
+    }
+
+    return (!ready.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ThumbnailProvider::IsPending(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    return (mRequest.has_value() || mDecoding || !mReady.empty());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Optional<sf::IntRect> ThumbnailProvider::Request(double seconds)
+{
+    if (!mOpened) {
+        return (std::nullopt);
+    }
+
+    Int64 bucket = static_cast<Int64>(std::max(0.0, seconds) / mBucketSeconds);
+    auto it = mSlots.find(bucket);
+
+    if (it != mSlots.end()) {
+        mUsage.splice(mUsage.begin(), mUsage, it->second.usage);
+        return (GetSlotRect(it->second.index));
+    }
+
+    bool requested = false;
+
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        requested = mRequested.insert(bucket).second;
+        if (requested) {
+            // Only the latest request is decoded, the one it replaces can
+            // be asked for again
+            if (mRequest) {
+                mRequested.erase(*mRequest);
+            }
+            mRequest = bucket;
+        }
+    }
+
+    if (requested) {
+        mTask.Wake();
+    }
+
+    if (mSlots.empty()) {
+        return (std::nullopt);
+    }
+
+    // Show the closest thumbnail while the exact one is decoded
+    auto after = mSlots.lower_bound(bucket);
+    auto closest = after;
+
+    if (after == mSlots.end() || (after != mSlots.begin() &&
+        bucket - std::prev(after)->first < after->first - bucket)
+    ) {
+        closest = std::prev(after);
+    }
+    return (GetSlotRect(closest->second.index));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const sf::Texture& ThumbnailProvider::GetTexture(void) const
+{
+    return (mAtlas);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u ThumbnailProvider::GetThumbnailSize(void) const
+{
+    return (sf::Vector2u(mWidth, mHeight));
+}
+
+} // namespace Moon
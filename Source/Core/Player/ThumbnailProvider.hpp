@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/SerialTask.hpp"
+#include <SFML/Graphics.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Seek preview thumbnails stored in an LRU texture atlas
+///
+/// Thumbnails are decoded by a background scheduler task that only decodes
+/// keyframes, at reduced resolution when the codec supports it.
+/// Positions are quantized into buckets, each bucket occupying one slot of
+/// the atlas; the least recently requested slot is recycled when full.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ThumbnailProvider
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr Uint32 THUMBNAIL_WIDTH = 160;
+    static constexpr Uint32 ATLAS_COLUMNS = 8;
+    static constexpr Uint32 ATLAS_ROWS = 8;
+    static constexpr double MAX_BUCKETS = 2000.0;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct Slot
+    {
+        Uint32 index;
+        List<Int64>::iterator usage;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Path mFilePath;
+    SharedPtr<KeyframeIndex> mKeyframeIndex;
+
+    Decoder mDecoder;
+    FrameConverter mConverter;
+    AVFrame* mFrame;
+    bool mFailed;
+
+    Mutex mMutex;
+    Optional<Int64> mRequest;
+    bool mDecoding;
+    Set<Int64> mRequested;
+    Vector<Pair<Int64, SharedPtr<VideoFrame>>> mReady;
+
+    Atomic<bool> mStop{false};
+    Atomic<bool> mOpened{false};
+    Atomic<double> mBucketSeconds{1.0};
+    Atomic<Uint32> mWidth{0};
+    Atomic<Uint32> mHeight{0};
+
+    sf::Texture mAtlas;
+    Map<Int64, Slot> mSlots;
+    List<Int64> mUsage;
+    Uint32 mUsedSlots;
+
+    SerialTask mTask{
+        TaskScheduler::Priority::Background, [this]{ Work(); }
+    };
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param filePath Path of the media file
+    /// \param index Keyframe index of the file, may be nullptr
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ThumbnailProvider(
+        const Path& filePath,
+        const SharedPtr<KeyframeIndex>& index
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~ThumbnailProvider();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the decoder on first use
+    ///
+    /// \return True if the decoder is usable
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Open(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task body, decodes the pending request
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Atlas rectangle of a slot
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::IntRect GetSlotRect(Uint32 index) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Upload the thumbnails decoded since the last call
+    ///
+    /// Must be called from the thread owning the OpenGL context.
+    ///
+    /// \return True if the atlas changed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True while a requested thumbnail is not uploaded yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPending(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Get the thumbnail of a position, requesting it if needed
+    ///
+    /// Requests are served latest first, so sweeping the mouse over the
+    /// timeline only decodes where it stops.
+    ///
+    /// \param seconds Position in the file
+    ///
+    /// \return Atlas rectangle of the thumbnail or of the closest one
+    ///         available, nothing if the atlas is still empty
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Optional<sf::IntRect> Request(double seconds);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Texture atlas holding every cached thumbnail
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const sf::Texture& GetTexture(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Size of a thumbnail, zero until the file is opened
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u GetThumbnailSize(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/TimeStretch.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <cmath>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Dot product of two runs and energy of the second
+///
+///////////////////////////////////////////////////////////////////////////////
+static Pair<float, float> CorrelateScalar(
+    const float* reference,
+    const float* candidate,
+    size_t count
+)
+{
+    float dot = 0.f;
+    float energy = 0.f;
+
+    for (size_t i = 0; i < count; i++) {
+        dot += reference[i] * candidate[i];
+        energy += candidate[i] * candidate[i];
+    }
+    return (Pair<float, float>(dot, energy));
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static Pair<float, float> CorrelateAvx2(
+    const float* reference,
+    const float* candidate,
+    size_t count
+)
+{
+    __m256 dot = _mm256_setzero_ps();
+    __m256 energy = _mm256_setzero_ps();
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 a = _mm256_loadu_ps(reference + i);
+        __m256 b = _mm256_loadu_ps(candidate + i);
+
+        dot = _mm256_fmadd_ps(a, b, dot);
+        energy = _mm256_fmadd_ps(b, b, energy);
+    }
+
+    alignas(32) float dots[8];
+    alignas(32) float energies[8];
+    Pair<float, float> result = CorrelateScalar(
+        reference + i, candidate + i, count - i);
+
+    _mm256_store_ps(dots, dot);
+    _mm256_store_ps(energies, energy);
+    for (int lane = 0; lane < 8; lane++) {
+        result.first += dots[lane];
+        result.second += energies[lane];
+    }
+    return (result);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+static float Score(const float* reference, const float* candidate, size_t count)
+{
+    Pair<float, float> sums;
+
+#if MOON_X86
+    if (HasAvx2()) {
+        sums = CorrelateAvx2(reference, candidate, count);
+    } else {
+        sums = CorrelateScalar(reference, candidate, count);
+    }
+#else
+    sums = CorrelateScalar(reference, candidate, count);
+#endif
+
+    return (sums.first / std::sqrt(sums.second + 1e-9f));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TimeStretch::TimeStretch(void)
+    : mChannels(0)
+    , mSequence(0)
+    , mOverlap(0)
+    , mSeek(0)
+    , mSpeed(1.0)
+    , mSkip(0.0)
+    , mPrimed(false)
+    , mInputStart(0)
+    , mInputEnd(0)
+    , mOutputStart(0)
+    , mOutputEnd(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimeStretch::Configure(int channels, int sampleRate, size_t maxFrames)
+{
+    double rate = static_cast<double>(sampleRate);
+
+    mChannels = static_cast<size_t>(std::max(channels, 1));
+    mOverlap = std::max<size_t>(8,
+        static_cast<size_t>(rate * OVERLAP_SECONDS));
+    mSequence = std::max(mOverlap * 3,
+        static_cast<size_t>(rate * SEQUENCE_SECONDS));
+    mSeek = std::max<size_t>(SEARCH_STEP,
+        static_cast<size_t>(rate * SEEK_SECONDS));
+
+    // Worst case: a full step at the highest speed is waiting, plus one
+    // push that did not make it enough
+    size_t step = mSequence - mOverlap;
+    size_t required = std::max(2 * mSeek + mSequence,
+        static_cast<size_t>(std::ceil(step * MAX_SPEED)) + 1);
+
+    mInput.assign((required + maxFrames) * mChannels, 0.f);
+    mOutput.assign((maxFrames + step) * mChannels, 0.f);
+    mTail.assign(mOverlap * mChannels, 0.f);
+    mFade.resize(mOverlap * mChannels);
+
+    for (size_t i = 0; i < mOverlap; i++) {
+        float weight = static_cast<float>(i) / mOverlap;
+
+        for (size_t c = 0; c < mChannels; c++) {
+            mFade[i * mChannels + c] = weight;
+        }
+    }
+    Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimeStretch::Clear(void)
+{
+    mInputStart = 0;
+    mInputEnd = 0;
+    mOutputStart = 0;
+    mOutputEnd = 0;
+    mSkip = 0.0;
+    mPrimed = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TimeStretch::SetSpeed(double speed)
+{
+    mSpeed = std::clamp(speed, MIN_SPEED, MAX_SPEED);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::Push(const float* samples, size_t frames)
+{
+    size_t capacity = mInput.size() / std::max<size_t>(mChannels, 1);
+
+    // Slide the pending input back to the start when the end is reached
+    if (mInputEnd + frames > capacity && mInputStart > 0) {
+        std::memmove(mInput.data(), mInput.data() + mInputStart * mChannels,
+            (mInputEnd - mInputStart) * mChannels * sizeof(float));
+        mInputEnd -= mInputStart;
+        mInputStart = 0;
+    }
+
+    size_t count = std::min(frames, capacity - mInputEnd);
+
+    std::memcpy(mInput.data() + mInputEnd * mChannels, samples,
+        count * mChannels * sizeof(float));
+    mInputEnd += count;
+    return (count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::GetRequiredInput(void) const
+{
+    size_t step = mSequence - mOverlap;
+
+    return (std::max(2 * mSeek + mSequence,
+        static_cast<size_t>(std::ceil(mSkip + step * mSpeed))));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::Search(const float* input) const
+{
+    size_t length = mOverlap * mChannels;
+    size_t best = 0;
+    float bestScore = -INFINITY;
+
+    for (size_t offset = 0; offset < 2 * mSeek; offset += SEARCH_STEP) {
+        float score = Score(mTail.data(), input + offset * mChannels, length);
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = offset;
+        }
+    }
+
+    size_t first = best > SEARCH_STEP ? best - SEARCH_STEP + 1 : 0;
+    size_t last = std::min(best + SEARCH_STEP, 2 * mSeek);
+    size_t coarse = best;
+
+    for (size_t offset = first; offset < last; offset++) {
+        if (offset == coarse) {
+            continue;
+        }
+
+        float score = Score(mTail.data(), input + offset * mChannels, length);
+
+        if (score > bestScore) {
+            bestScore = score;
+            best = offset;
+        }
+    }
+    return (best);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TimeStretch::Process(void)
+{
+    size_t step = mSequence - mOverlap;
+    size_t capacity = mOutput.size() / std::max<size_t>(mChannels, 1);
+
+    if (mChannels == 0 || mInputEnd - mInputStart < GetRequiredInput()) {
+        return (false);
+    }
+
+    if (mOutputEnd + step > capacity) {
+        if (mOutputStart == 0) {
+            return (false);
+        }
+        std::memmove(mOutput.data(), mOutput.data() + mOutputStart * mChannels,
+            (mOutputEnd - mOutputStart) * mChannels * sizeof(float));
+        mOutputEnd -= mOutputStart;
+        mOutputStart = 0;
+    }
+
+    const float* input = mInput.data() + mInputStart * mChannels;
+    size_t best = mPrimed ? Search(input) : 0;
+    const float* sequence = input + best * mChannels;
+    float* output = mOutput.data() + mOutputEnd * mChannels;
+    size_t overlap = mOverlap * mChannels;
+
+    // Fade from the continuation of the previous sequence into this one
+    if (mPrimed) {
+        for (size_t i = 0; i < overlap; i++) {
+            output[i] = mTail[i] + (sequence[i] - mTail[i]) * mFade[i];
+        }
+    } else {
+        std::memcpy(output, sequence, overlap * sizeof(float));
+    }
+
+    std::memcpy(output + overlap, sequence + overlap,
+        (step - mOverlap) * mChannels * sizeof(float));
+    std::memcpy(mTail.data(), sequence + step * mChannels,
+        overlap * sizeof(float));
+
+    mOutputEnd += step;
+    mSkip += step * mSpeed;
+
+    size_t skip = static_cast<size_t>(mSkip);
+
+    mSkip -= static_cast<double>(skip);
+    mInputStart += skip;
+    mPrimed = true;
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::Pull(float* samples, size_t frames)
+{
+    size_t count = std::min(frames, mOutputEnd - mOutputStart);
+
+    std::memcpy(samples, mOutput.data() + mOutputStart * mChannels,
+        count * mChannels * sizeof(float));
+    mOutputStart += count;
+
+    if (mOutputStart == mOutputEnd) {
+        mOutputStart = 0;
+        mOutputEnd = 0;
+    }
+    return (count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::GetInputFrames(void) const
+{
+    return (mInputEnd - mInputStart);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TimeStretch::GetOutputFrames(void) const
+{
+    return (mOutputEnd - mOutputStart);
+}
+
+} // namespace Moon
@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Pitch preserving speed change of interleaved float audio, WSOLA
+///
+/// The input is cut in sequences of SEQUENCE_SECONDS that are laid end to
+/// end, overlapping by OVERLAP_SECONDS, while the read position advances by
+/// the output length times the speed. Each sequence starts where it best
+/// continues the tail of the previous one, searched over SEEK_SECONDS by
+/// normalized cross-correlation: coarsely every SEARCH_STEP frames, then
+/// around the best match. The correlation runs on AVX2 when available.
+///
+/// Buffers are sized by Configure; Push, Process and Pull never allocate,
+/// so they can run in an audio callback.
+///
+///////////////////////////////////////////////////////////////////////////////
+class TimeStretch
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr double SEQUENCE_SECONDS = 0.040;
+    static constexpr double OVERLAP_SECONDS = 0.008;
+    static constexpr double SEEK_SECONDS = 0.015;
+    static constexpr size_t SEARCH_STEP = 4;
+    static constexpr double MIN_SPEED = 0.25;
+    static constexpr double MAX_SPEED = 4.0;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    size_t mChannels;
+    size_t mSequence;
+    size_t mOverlap;
+    size_t mSeek;
+    double mSpeed;
+    double mSkip;
+    bool mPrimed;
+
+    Vector<float> mInput;
+    size_t mInputStart;
+    size_t mInputEnd;
+    Vector<float> mOutput;
+    size_t mOutputStart;
+    size_t mOutputEnd;
+    Vector<float> mTail;
+    Vector<float> mFade;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    TimeStretch(void);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Offset in the input where the next sequence fits best
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t Search(const float* input) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Frames of input needed before the next sequence
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetRequiredInput(void) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Allocate the buffers and clear the state
+    ///
+    /// \param channels Interleaved channels
+    /// \param sampleRate Sample rate in Hz
+    /// \param maxFrames Largest Pull request
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Configure(int channels, int sampleRate, size_t maxFrames);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Drop every buffered sample, after a seek
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Clear(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param speed Input duration per output duration, clamped
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetSpeed(double speed);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Append input samples
+    ///
+    /// \param samples Interleaved samples
+    /// \param frames Number of frames
+    ///
+    /// \return Frames accepted, the rest must be pushed again later
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t Push(const float* samples, size_t frames);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Produce one sequence of output
+    ///
+    /// \return False if more input or room for output is needed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Process(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take output samples
+    ///
+    /// \param samples Receives interleaved samples
+    /// \param frames Number of frames wanted
+    ///
+    /// \return Frames written
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t Pull(float* samples, size_t frames);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Frames pushed and not consumed yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetInputFrames(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Frames produced and not pulled yet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetOutputFrames(void) const;
+};
+
+} // namespace Moon
@@ -0,0 +1,486 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Player/ToneMap.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include "Core/System/ParallelFor.hpp"
+#include <cmath>
+extern "C" {
+    #include <libavutil/mastering_display_metadata.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief SMPTE ST 2084 constants
+///
+///////////////////////////////////////////////////////////////////////////////
+static constexpr double PQ_M1 = 2610.0 / 16384.0;
+static constexpr double PQ_M2 = 2523.0 / 4096.0 * 128.0;
+static constexpr double PQ_C1 = 3424.0 / 4096.0;
+static constexpr double PQ_C2 = 2413.0 / 4096.0 * 32.0;
+static constexpr double PQ_C3 = 2392.0 / 4096.0 * 32.0;
+static constexpr double PQ_PEAK = 10000.0;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief ARIB STD-B67 constants and the system gamma of a 1000 nits display
+///
+///////////////////////////////////////////////////////////////////////////////
+static constexpr double HLG_A = 0.17883277;
+static constexpr double HLG_B = 0.28466892;
+static constexpr double HLG_C = 0.55991073;
+static constexpr double HLG_GAMMA = 1.2;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief BT.2020 to BT.709 primaries, on linear light
+///
+///////////////////////////////////////////////////////////////////////////////
+static constexpr float BT2020_TO_BT709[9] = {
+     1.6605f, -0.5876f, -0.0728f,
+    -0.1246f,  1.1329f, -0.0083f,
+    -0.0182f, -0.1006f,  1.1187f
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Planes of one row, Cb and Cr interleaved when step is 2
+///
+///////////////////////////////////////////////////////////////////////////////
+struct HdrRow
+{
+    const Uint16* luma;
+    const Uint16* cb;
+    const Uint16* cr;
+    int step;
+    int shift;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Tables and matrices shared by the kernels
+///
+///////////////////////////////////////////////////////////////////////////////
+struct HdrTables
+{
+    const float* input;
+    const Int32* output;
+    const float* yuv;
+    const float* gamut;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static double PqToLinear(double signal)
+{
+    double power = std::pow(std::clamp(signal, 0.0, 1.0), 1.0 / PQ_M2);
+
+    return (std::pow(std::max(power - PQ_C1, 0.0) / (PQ_C2 - PQ_C3 * power),
+        1.0 / PQ_M1));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double LinearToPq(double light)
+{
+    double power = std::pow(std::clamp(light, 0.0, 1.0), PQ_M1);
+
+    return (std::pow((PQ_C1 + PQ_C2 * power) / (1.0 + PQ_C3 * power), PQ_M2));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double HlgToLinear(double signal)
+{
+    signal = std::clamp(signal, 0.0, 1.0);
+    if (signal <= 0.5) {
+        return (signal * signal / 3.0);
+    }
+    return ((std::exp((signal - HLG_C) / HLG_A) + HLG_B) / 12.0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double Hable(double x)
+{
+    static constexpr double A = 0.15, B = 0.50, C = 0.10;
+    static constexpr double D = 0.20, E = 0.02, F = 0.30;
+
+    return ((x * (A * x + C * B) + D * E) / (x * (A * x + B) + D * F) - E / F);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief BT.2390 EETF, from a source peak to REFERENCE_WHITE, in PQ
+///
+///////////////////////////////////////////////////////////////////////////////
+static double Bt2390(double nits, double peak)
+{
+    double sourcePeak = LinearToPq(peak / PQ_PEAK);
+    double maxLuminance = LinearToPq(ToneMap::REFERENCE_WHITE / PQ_PEAK) /
+        sourcePeak;
+    double kneeStart = 1.5 * maxLuminance - 0.5;
+    double signal = std::min(LinearToPq(nits / PQ_PEAK) / sourcePeak, 1.0);
+
+    if (signal > kneeStart) {
+        double t = (signal - kneeStart) / (1.0 - kneeStart);
+        double t2 = t * t;
+        double t3 = t2 * t;
+
+        signal = (2.0 * t3 - 3.0 * t2 + 1.0) * kneeStart +
+            (t3 - 2.0 * t2 + t) * (1.0 - kneeStart) +
+            (-2.0 * t3 + 3.0 * t2) * maxLuminance;
+    }
+    return (PqToLinear(signal * sourcePeak) * PQ_PEAK);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void MapScalar(
+    const HdrTables& tables,
+    const HdrRow& row,
+    Uint8* pixels,
+    int first,
+    int last
+)
+{
+    const float* k = tables.yuv;
+    const float* m = tables.gamut;
+
+    for (int x = first; x < last; x++) {
+        int chroma = (x / 2) * row.step;
+        float y = (row.luma[x] >> row.shift) * k[0] + k[1];
+        float cb = (row.cb[chroma] >> row.shift) * k[2] + k[3];
+        float cr = (row.cr[chroma] >> row.shift) * k[2] + k[3];
+        float signal[3] = {
+            y + k[4] * cr,
+            y + k[5] * cb + k[6] * cr,
+            y + k[7] * cb
+        };
+        float light[3];
+        Uint8* pixel = pixels + 4 * x;
+
+        for (int c = 0; c < 3; c++) {
+            int index = static_cast<int>(std::clamp(signal[c], 0.f, 1.f) *
+                (ToneMap::INPUT_SIZE - 1) + 0.5f);
+
+            light[c] = tables.input[index];
+        }
+
+        for (int c = 0; c < 3; c++) {
+            float value = std::clamp(m[3 * c] * light[0] +
+                m[3 * c + 1] * light[1] + m[3 * c + 2] * light[2], 0.f, 1.f);
+            int index = static_cast<int>(std::sqrt(value) *
+                (ToneMap::OUTPUT_SIZE - 1) + 0.5f);
+
+            pixel[c] = static_cast<Uint8>(tables.output[index]);
+        }
+        pixel[3] = 255;
+    }
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static void MapAvx2(
+    const HdrTables& tables,
+    const HdrRow& row,
+    Uint8* pixels,
+    int width
+)
+{
+    const float* k = tables.yuv;
+    const __m128i shift = _mm_cvtsi32_si128(row.shift);
+    const __m256i pairs = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i evens = _mm256_setr_epi32(0, 0, 2, 2, 4, 4, 6, 6);
+    const __m256i odds = _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 7, 7);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 inputScale = _mm256_set1_ps(ToneMap::INPUT_SIZE - 1);
+    const __m256 outputScale = _mm256_set1_ps(ToneMap::OUTPUT_SIZE - 1);
+    const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+    __m256 coefficients[8];
+    __m256 gamut[9];
+    int x = 0;
+
+    for (int i = 0; i < 8; i++) {
+        coefficients[i] = _mm256_set1_ps(k[i]);
+    }
+    for (int i = 0; i < 9; i++) {
+        gamut[i] = _mm256_set1_ps(tables.gamut[i]);
+    }
+
+    for (; x + 8 <= width; x += 8) {
+        __m256i luma = _mm256_srl_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(row.luma + x))), shift);
+        __m256i cb;
+        __m256i cr;
+
+        if (row.step == 2) {
+            __m256i both = _mm256_cvtepu16_epi32(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(row.cb + x)));
+
+            cb = _mm256_permutevar8x32_epi32(both, evens);
+            cr = _mm256_permutevar8x32_epi32(both, odds);
+        } else {
+            cb = _mm256_permutevar8x32_epi32(_mm256_cvtepu16_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                row.cb + x / 2))), pairs);
+            cr = _mm256_permutevar8x32_epi32(_mm256_cvtepu16_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(
+                row.cr + x / 2))), pairs);
+        }
+        cb = _mm256_srl_epi32(cb, shift);
+        cr = _mm256_srl_epi32(cr, shift);
+
+        __m256 y = _mm256_fmadd_ps(_mm256_cvtepi32_ps(luma),
+            coefficients[0], coefficients[1]);
+        __m256 u = _mm256_fmadd_ps(_mm256_cvtepi32_ps(cb),
+            coefficients[2], coefficients[3]);
+        __m256 v = _mm256_fmadd_ps(_mm256_cvtepi32_ps(cr),
+            coefficients[2], coefficients[3]);
+        __m256 signal[3] = {
+            _mm256_fmadd_ps(coefficients[4], v, y),
+            _mm256_fmadd_ps(coefficients[6], v,
+                _mm256_fmadd_ps(coefficients[5], u, y)),
+            _mm256_fmadd_ps(coefficients[7], u, y)
+        };
+        __m256 light[3];
+
+        for (int c = 0; c < 3; c++) {
+            __m256 clamped = _mm256_min_ps(_mm256_max_ps(signal[c], zero), one);
+            __m256i index = _mm256_cvttps_epi32(
+                _mm256_fmadd_ps(clamped, inputScale, half));
+
+            light[c] = _mm256_i32gather_ps(tables.input, index, 4);
+        }
+
+        __m256i result = alpha;
+
+        for (int c = 0; c < 3; c++) {
+            __m256 value = _mm256_mul_ps(gamut[3 * c], light[0]);
+
+            value = _mm256_fmadd_ps(gamut[3 * c + 1], light[1], value);
+            value = _mm256_fmadd_ps(gamut[3 * c + 2], light[2], value);
+            value = _mm256_min_ps(_mm256_max_ps(value, zero), one);
+
+            __m256i index = _mm256_cvttps_epi32(_mm256_fmadd_ps(
+                _mm256_sqrt_ps(value), outputScale, half));
+            __m256i code = _mm256_i32gather_epi32(tables.output, index, 4);
+
+            result = _mm256_or_si256(result, _mm256_slli_epi32(code, 8 * c));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + 4 * x), result);
+    }
+
+    MapScalar(tables, row, pixels, x, width);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+ToneMap::ToneMap(void)
+    : mCurve(Curve::Bt2390)
+    , mTransfer(Transfer::None)
+    , mPeak(0.f)
+    , mYuv{}
+    , mGamut{}
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void ToneMap::BuildTables(void)
+{
+    mInput.resize(INPUT_SIZE);
+    mOutput.resize(OUTPUT_SIZE);
+
+    double peak = std::max<double>(mPeak, REFERENCE_WHITE);
+
+    for (int i = 0; i < INPUT_SIZE; i++) {
+        double signal = static_cast<double>(i) / (INPUT_SIZE - 1);
+        double nits = mTransfer == Transfer::Hlg
+            ? HLG_PEAK * std::pow(HlgToLinear(signal), HLG_GAMMA)
+            : PqToLinear(signal) * PQ_PEAK;
+        double light;
+
+        if (mCurve == Curve::Hable) {
+            light = Hable(nits / REFERENCE_WHITE) /
+                Hable(peak / REFERENCE_WHITE);
+        } else if (peak > REFERENCE_WHITE) {
+            light = Bt2390(std::min(nits, peak), peak) / REFERENCE_WHITE;
+        } else {
+            light = nits / REFERENCE_WHITE;
+        }
+        mInput[i] = static_cast<float>(std::clamp(light, 0.0, 1.0));
+    }
+
+    // Indexed by the square root of the light, BT.1886 with a gamma of 2.4
+    for (int i = 0; i < OUTPUT_SIZE; i++) {
+        double root = static_cast<double>(i) / (OUTPUT_SIZE - 1);
+
+        mOutput[i] = static_cast<Int32>(std::lrint(
+            std::pow(root * root, 1.0 / 2.4) * 255.0));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ToneMap::ApplyRows(
+    const AVFrame* picture,
+    Uint8* pixels,
+    int first,
+    int last
+) const
+{
+    bool interleaved = picture->format == AV_PIX_FMT_P010LE;
+    HdrTables tables{mInput.data(), mOutput.data(), mYuv, mGamut};
+
+    for (int y = first; y < last; y++) {
+        const Uint8* chroma = picture->data[1] + (y / 2) * picture->linesize[1];
+        HdrRow row;
+
+        row.luma = reinterpret_cast<const Uint16*>(
+            picture->data[0] + y * picture->linesize[0]);
+        row.cb = reinterpret_cast<const Uint16*>(chroma);
+        row.cr = interleaved ? row.cb + 1 : reinterpret_cast<const Uint16*>(
+            picture->data[2] + (y / 2) * picture->linesize[2]);
+        row.step = interleaved ? 2 : 1;
+        row.shift = interleaved ? 6 : 0;
+
+        Uint8* destination = pixels + static_cast<size_t>(y) *
+            picture->width * 4;
+
+#if MOON_X86
+        if (HasAvx2()) {
+            MapAvx2(tables, row, destination, picture->width);
+            continue;
+        }
+#endif
+        MapScalar(tables, row, destination, 0, picture->width);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ToneMap::SetCurve(Curve curve)
+{
+    if (curve != mCurve) {
+        mCurve = curve;
+        mTransfer = Transfer::None;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ToneMap::Curve ToneMap::GetCurve(void) const
+{
+    return (mCurve);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ToneMap::Prepare(const AVFrame* picture)
+{
+    Transfer transfer = GetTransfer(picture);
+
+    if (mCurve == Curve::Off || transfer == Transfer::None ||
+        !IsSupported(static_cast<AVPixelFormat>(picture->format))
+    ) {
+        return (false);
+    }
+
+    float peak = transfer == Transfer::Hlg ? HLG_PEAK : GetPeak(picture);
+
+    if (transfer != mTransfer || peak != mPeak) {
+        mTransfer = transfer;
+        mPeak = peak;
+        BuildTables();
+    }
+
+    // HDR is nearly always BT.2020, BT.709 matrices are kept when tagged
+    bool bt709 = picture->colorspace == AVCOL_SPC_BT709;
+    float kr = bt709 ? 0.2126f : 0.2627f;
+    float kb = bt709 ? 0.0722f : 0.0593f;
+    float kg = 1.f - kr - kb;
+    bool full = picture->color_range == AVCOL_RANGE_JPEG;
+
+    mYuv[0] = full ? 1.f / 1023.f : 1.f / 876.f;
+    mYuv[1] = full ? 0.f : -64.f / 876.f;
+    mYuv[2] = full ? 1.f / 1023.f : 1.f / 896.f;
+    mYuv[3] = -512.f * mYuv[2];
+    mYuv[4] = 2.f * (1.f - kr);
+    mYuv[5] = -2.f * kb * (1.f - kb) / kg;
+    mYuv[6] = -2.f * kr * (1.f - kr) / kg;
+    mYuv[7] = 2.f * (1.f - kb);
+
+    for (int i = 0; i < 9; i++) {
+        mGamut[i] = picture->color_primaries == AVCOL_PRI_BT709
+            ? (i % 4 == 0 ? 1.f : 0.f) : BT2020_TO_BT709[i];
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ToneMap::Apply(
+    const AVFrame* picture,
+    Uint8* pixels,
+    bool parallel,
+    TaskScheduler::Priority priority
+) const
+{
+    Uint32 height = static_cast<Uint32>(picture->height);
+    Uint32 strips = (height + STRIP_ROWS - 1) / STRIP_ROWS;
+
+    if (!parallel) {
+        ApplyRows(picture, pixels, 0, picture->height);
+        return;
+    }
+
+    ParallelFor(strips, [&](Uint32 strip) {
+        Uint32 first = strip * STRIP_ROWS;
+
+        ApplyRows(picture, pixels, static_cast<int>(first),
+            static_cast<int>(std::min(first + STRIP_ROWS, height)));
+    }, priority);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ToneMap::Transfer ToneMap::GetTransfer(const AVFrame* picture)
+{
+    switch (picture->color_trc) {
+        case AVCOL_TRC_SMPTE2084:
+            return (Transfer::Pq);
+        case AVCOL_TRC_ARIB_STD_B67:
+            return (Transfer::Hlg);
+        default:
+            return (Transfer::None);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool ToneMap::IsSupported(AVPixelFormat format)
+{
+    return (format == AV_PIX_FMT_P010LE || format == AV_PIX_FMT_YUV420P10LE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+float ToneMap::GetPeak(const AVFrame* picture)
+{
+    const AVFrameSideData* light = av_frame_get_side_data(
+        picture, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL);
+    const AVFrameSideData* mastering = av_frame_get_side_data(
+        picture, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA);
+
+    if (light) {
+        auto metadata = reinterpret_cast<const AVContentLightMetadata*>(
+            light->data);
+
+        if (metadata->MaxCLL > 0) {
+            return (std::min(static_cast<float>(metadata->MaxCLL),
+                static_cast<float>(PQ_PEAK)));
+        }
+    }
+
+    if (mastering) {
+        auto metadata = reinterpret_cast<const AVMasteringDisplayMetadata*>(
+            mastering->data);
+
+        if (metadata->has_luminance && metadata->max_luminance.num > 0) {
+            return (std::min(static_cast<float>(av_q2d(
+                metadata->max_luminance)), static_cast<float>(PQ_PEAK)));
+        }
+    }
+    return (DEFAULT_PEAK);
+}
+
+} // namespace Moon
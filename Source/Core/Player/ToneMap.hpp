@@ -0,0 +1,184 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+extern "C" {
+    #include <libavutil/frame.h>
+    #include <libavutil/pixfmt.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Tone mapping of 10 bit PQ and HLG pictures to 8 bit SDR RGBA
+///
+/// Converting HDR straight to RGBA with the scaler shows the PQ or HLG
+/// signal as if it were BT.709, flat and washed out. This stage reads the
+/// 10 bit 4:2:0 planes instead and, per pixel:
+///
+///   - converts YCbCr to non linear BT.2020 RGB in float,
+///   - looks each channel up in a 1D table holding the transfer function
+///     followed by the tone curve, giving linear light where 1 is the SDR
+///     peak,
+///   - converts BT.2020 primaries to BT.709 with a 3x3 matrix and clips,
+///   - looks the result up in a BT.1886 output table indexed by the square
+///     root of the light, which keeps the shadows smooth.
+///
+/// The curve works on each channel, which keeps the cost to table lookups
+/// but shifts the hue of saturated highlights a little. HLG uses a 1000
+/// nits display with the OOTF applied per channel. Both tables are built
+/// again only when the transfer, curve or mastering peak changes.
+///
+/// The AVX2 path does 8 pixels per pass with gathers, and pictures are
+/// split in strips over the scheduler with ParallelFor.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ToneMap
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int INPUT_SIZE = 4096;
+    static constexpr int OUTPUT_SIZE = 4096;
+    static constexpr Uint32 STRIP_ROWS = 16;
+    static constexpr float REFERENCE_WHITE = 203.f;
+    static constexpr float DEFAULT_PEAK = 1000.f;
+    static constexpr float HLG_PEAK = 1000.f;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Tone curves
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Curve
+    {
+        Off,                            ///< Leave HDR to the scaler
+        Bt2390,                         ///< ITU-R BT.2390 EETF, in PQ
+        Hable                           ///< Filmic curve of Uncharted 2
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Transfer functions handled
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Transfer
+    {
+        None,
+        Pq,
+        Hlg
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Curve mCurve;
+    Transfer mTransfer;
+    float mPeak;
+    Vector<float> mInput;
+    Vector<Int32> mOutput;
+    float mYuv[8];
+    float mGamut[9];
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ToneMap(void);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Fill the input and output tables for the current settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void BuildTables(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Tone map rows of a picture into RGBA
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ApplyRows(const AVFrame* picture, Uint8* pixels, int first,
+        int last) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param curve Curve used for the next pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetCurve(Curve curve);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Curve used for the next pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Curve GetCurve(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pick the tables and matrices for a decoded picture
+    ///
+    /// \param picture Decoded picture, its colorimetry and side data are
+    ///                read
+    ///
+    /// \return True if the picture is HDR in a supported format and the
+    ///         curve is not Off, Apply must then be used
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Prepare(const AVFrame* picture);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Tone map a picture prepared with Prepare
+    ///
+    /// \param picture 10 bit 4:2:0 planes, the prepared picture or a scaled
+    ///                copy of it
+    /// \param pixels RGBA destination of the picture size, tightly packed
+    /// \param parallel False to do every strip on the calling thread
+    /// \param priority Class of the strip tasks, lower it off the playback
+    ///                 path so that playback keeps its workers
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Apply(const AVFrame* picture, Uint8* pixels, bool parallel = true,
+        TaskScheduler::Priority priority =
+            TaskScheduler::Priority::RealTime) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Transfer function of a picture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static Transfer GetTransfer(const AVFrame* picture);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True for the 10 bit 4:2:0 formats Apply reads
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static bool IsSupported(AVPixelFormat format);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Peak luminance in nits from the content light level or the
+    ///         mastering display, DEFAULT_PEAK without either
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static float GetPeak(const AVFrame* picture);
+};
+
+} // namespace Moon
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+extern "C" {
+    #include <libavutil/avutil.h>
+    #include <libavutil/mem.h>
+    #include <libavutil/frame.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+class ColorLut;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Frame structure to hold decoded video frame data
+///
+/// The pixel data is tightly packed RGBA and owned by the frame. The source
+/// serial tells frames of successive playlist items apart. The duration
+/// paces playback once the frame is shown, 0 keeps the previous pace. The
+/// decoded picture is only kept on request, for analysis of the original
+/// planes, and counts in the size. Frames graded on the CPU keep the table
+/// they were graded with.
+///
+///////////////////////////////////////////////////////////////////////////////
+struct VideoFrame
+{
+    Uint8* data;
+    Int64 pts;
+    double timestamp;
+    double duration;
+    Uint32 width;
+    Uint32 height;
+    Uint32 source;
+    AVFrame* picture;
+    SharedPtr<const ColorLut> lut;
+
+    VideoFrame()
+        : data(nullptr), pts(AV_NOPTS_VALUE), timestamp(0.0), duration(0.0)
+        , width(0), height(0), source(0), picture(nullptr) {}
+
+    VideoFrame(
+        Uint8* frameData, Int64 framePts, double frameTimestamp,
+        Uint32 frameWidth, Uint32 frameHeight
+    )
+        : data(frameData), pts(framePts), timestamp(frameTimestamp)
+        , duration(0.0), width(frameWidth), height(frameHeight), source(0)
+        , picture(nullptr) {}
+
+    VideoFrame(const VideoFrame&) = delete;
+    VideoFrame& operator=(const VideoFrame&) = delete;
+
+    ~VideoFrame() {
+        if (data) {
+            av_free(data);
+            data = nullptr;
+        }
+        av_frame_free(&picture);
+    }
+
+    Uint64 GetSize(void) const {
+        Uint64 size = static_cast<Uint64>(width) * height * 4;
+
+        for (int i = 0; picture && i < AV_NUM_DATA_POINTERS; i++) {
+            if (picture->buf[i]) {
+                size += picture->buf[i]->size;
+            }
+        }
+        return (size);
+    }
+};
+
+} // namespace Moon
@@ -25,36 +25,82 @@ namespace Moon
 
 ///////////////////////////////////////////////////////////////////////////////
 VideoPlayer::VideoPlayer(const Path& filePath)
-    : mMedia(std::make_shared<Media>(filePath))
-    , mFormatContext(nullptr)
-    , mCodecContext(nullptr)
-    , mFrame(nullptr)
-    , mFrameRGB(nullptr)
-    , mPacket(nullptr)
-    , mSwsContext(nullptr)
-    , mBuffer(nullptr)
+    : mFrame(nullptr)
     , mTexture({1U, 1U})
-    , mVideoStreamIndex(-1)
     , mIsPlaying(false)
     , mPlaybackSpeed(1.0)
+    , mFrameDuration(1.0 / 25.0)
     , mPlaybackClock()
     , mLastFrameTime((double)mPlaybackClock.getElapsedTime().asSeconds())
 {
-    Initialize();
+    mOpenTime = mPlaybackClock.getElapsedTime().asSeconds();
+
+    Source source(filePath);
+
+    source.Open(nullptr, 0);
+    Initialize(source);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+VideoPlayer::VideoPlayer(UniquePtr<Source> source)
+    : mFrame(nullptr)
+    , mTexture({1U, 1U})
+    , mIsPlaying(false)
+    , mPlaybackSpeed(1.0)
+    , mFrameDuration(1.0 / 25.0)
+    , mPlaybackClock()
+    , mLastFrameTime((double)mPlaybackClock.getElapsedTime().asSeconds())
+{
+    mOpenTime = mPlaybackClock.getElapsedTime().asSeconds();
+
+    if (!source) {
+        source = std::make_unique<Source>(Path());
+    }
+    Initialize(*source);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+VideoPlayer::VideoPlayer(const SharedPtr<Playlist>& playlist)
+    : mFrame(nullptr)
+    , mTexture({1U, 1U})
+    , mIsPlaying(false)
+    , mPlaybackSpeed(1.0)
+    , mFrameDuration(1.0 / 25.0)
+    , mPlaybackClock()
+    , mLastFrameTime((double)mPlaybackClock.getElapsedTime().asSeconds())
+    , mPlaylist(playlist)
+{
+    mOpenTime = mPlaybackClock.getElapsedTime().asSeconds();
+
+    UniquePtr<Source> source = nullptr;
+
+    for (size_t i = 0; !source && i < playlist->GetCount(); i++) {
+        source = playlist->Take(i);
+        mDecodingItem = i;
+    }
+
+    if (!source) {
+        source = std::make_unique<Source>(
+            playlist->GetCount() > 0 ? playlist->GetItem(0) : Path());
+    }
+    Initialize(*source);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 VideoPlayer::~VideoPlayer()
 {
+    mReverse.reset();
+    mStepper.reset();
+
     mStopDecoding = true;
 
-    mQueueFullCV.notify_all();
+    if (mPlaylist) {
+        mPlaylist->Stop();
+    }
+
     mQueueEmptyCV.notify_all();
     mFrameCV.notify_all();
-
-    if (mDecodeThread.joinable()) {
-        mDecodeThread.join();
-    }
+    mDecodeTask.Stop();
 
     {
         std::unique_lock<Mutex> lock(mQueueMutex);
@@ -63,297 +109,657 @@ VideoPlayer::~VideoPlayer()
         }
     }
 
-    if (mBuffer) {
-        av_free(mBuffer);
-        mBuffer = nullptr;
+    if (mFrame) {
+        av_frame_free(&mFrame);
     }
+    av_frame_free(&mFiltered);
+}
 
-    if (mFrameRGB) {
-        av_frame_free(&mFrameRGB);
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::Initialize(Source& source)
+{
+    mMedia = source.media ? source.media
+        : std::make_shared<Media>(source.filePath);
+
+    if (!source.decoder.IsOpen()) {
+        return;
     }
 
-    if (mFrame) {
-        av_frame_free(&mFrame);
+    mDecoder = std::move(source.decoder);
+    mMaxWidth = source.maxWidth;
+    mMaxHeight = source.maxHeight;
+    mFrameDuration = mDecoder.GetFrameDuration();
+    mDuration = mDecoder.GetDuration();
+    mVideoStream = mDecoder.GetStreamIndex();
+    mAudioStream = mDecoder.FindAudioStream(mAudioRank);
+    mDecoder.SelectStreams(mVideoStream, mAudioStream, mSubtitleStream);
+    mCurrentItem = mDecodingItem;
+
+    mFrame = av_frame_alloc();
+    mFiltered = av_frame_alloc();
+
+    if (!mFrame || !mFiltered) {
+        std::cerr << "Could not allocate frames" << std::endl;
+        return;
     }
 
-    if (mPacket) {
-        av_packet_free(&mPacket);
+    if (!mTexture.resize({
+        static_cast<Uint32>(mDecoder.GetWidth()),
+        static_cast<Uint32>(mDecoder.GetHeight())
+    })) {
+        std::cerr << "Could not resize SFML texture" << std::endl;
     }
 
-    if (mSwsContext) {
-        sws_freeContext(mSwsContext);
-        mSwsContext = nullptr;
+    // Seeking in files without an index is slow and inaccurate, read their
+    // keyframe positions in the background
+    if (source.needsIndex) {
+        mKeyframeIndex = std::make_shared<KeyframeIndex>(
+            mMedia->filePath, mDecoder.GetStreamIndex());
+        mDecoder.SetKeyframeIndex(mKeyframeIndex);
     }
 
-    if (mCodecContext) {
-        avcodec_free_context(&mCodecContext);
+    mStepper = std::make_unique<FrameStepper>(
+        mMedia->filePath, mVideoStream, mKeyframeIndex);
+
+    // Show the first picture right away, the decode thread then continues
+    // from the next one while the queue fills
+    bool presented = false;
+
+    for (const auto& frame : source.frames) {
+        if (presented) {
+            mFrameQueue.push(frame);
+        } else {
+            presented = PresentFrame(frame);
+        }
     }
 
-    if (mFormatContext) {
-        avformat_close_input(&mFormatContext);
+    while (!presented && mDecoder.Decode(mFrame) == Decoder::Status::Frame) {
+        Int64 pts = Decoder::GetFramePts(mFrame);
+
+        mConverter.SetToneMapping(mToneMapping);
+        SharedPtr<VideoFrame> frame = mConverter.ConvertToFit(
+            mFrame, pts, mDecoder.ToSeconds(pts), mMaxWidth, mMaxHeight);
+        SharedPtr<const ColorLut> lut = GetLut();
+
+        if (frame && lut) {
+            lut->Apply(frame->data, frame->width, frame->height);
+            frame->lut = lut;
+        }
+        av_frame_unref(mFrame);
+        presented = PresentFrame(frame);
+    }
+
+    if (presented) {
+        mTimeToFirstFrame =
+            mPlaybackClock.getElapsedTime().asSeconds() - mOpenTime;
+    }
+
+    if (mPlaylist) {
+        Optional<size_t> next = mPlaylist->GetNext(mDecodingItem);
+
+        if (next) {
+            mPlaylist->Prepare(*next, mDecoder.GetStream()->codecpar);
+        }
     }
+
+    mDecodeTask.Wake();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void VideoPlayer::Initialize(void)
+bool VideoPlayer::SwitchToNextSource(void)
 {
-    if (avformat_open_input(
-        &mFormatContext, mMedia->filePath.c_str(), nullptr, nullptr) != 0
-    ) {
-        std::cerr << "Could not open input file: " << mMedia->filePath << std::endl;
-        return;
-    }
+    Optional<size_t> first = mPlaylist->GetNext(mDecodingItem);
+    Optional<size_t> next = first;
 
-    if (avformat_find_stream_info(mFormatContext, nullptr) < 0) {
-        std::cerr << "Could not find stream information" << std::endl;
-        avformat_close_input(&mFormatContext);
-        return;
+    if (!next) {
+        return (false);
     }
 
-    for (unsigned int i = 0; i < mFormatContext->nb_streams; i++) {
-        AVStream *stream = mFormatContext->streams[i];
-        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO) {
-            mVideoStreamIndex = i;
-            break;
+    do {
+        UniquePtr<Source> source = mPlaylist->Take(*next);
+        bool opened = source && !source->sharesCodec;
+
+        // The current codec is handed over when the streams are compatible,
+        // saving its setup and keeping its threads warm
+        if (source && source->sharesCodec) {
+            {
+                std::unique_lock<Mutex> lock(mDecoderMutex);
+                opened = source->decoder.AdoptCodec(mDecoder);
+            }
+            opened = opened || source->decoder.OpenCodec();
         }
-    }
 
-    if (mVideoStreamIndex == -1) {
-        std::cerr << "Could not find video stream" << std::endl;
-        avformat_close_input(&mFormatContext);
-        return;
-    }
+        if (opened) {
+            StartSource(*next, *source, false);
+            return (true);
+        }
 
-    AVCodecParameters* codecParams =
-        mFormatContext->streams[mVideoStreamIndex]->codecpar;
-    const AVCodec* codec = avcodec_find_decoder(codecParams->codec_id);
+        std::cerr << "Skipping " << mPlaylist->GetItem(*next) << std::endl;
+        next = mPlaylist->GetNext(*next);
+    } while (next && next != first && !mStopDecoding);
 
-    if (!codec) {
-        std::cerr << "Unsupported video codec" << std::endl;
-        return;
-    }
+    return (false);
+}
 
-    mCodecContext = avcodec_alloc_context3(codec);
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::StartSource(size_t item, Source& source, bool restart)
+{
+    int audio = -1;
 
-    if (!mCodecContext) {
-        std::cerr << "Could not allocate video codec context" << std::endl;
-        return;
-    }
+    {
+        std::unique_lock<Mutex> lock(mDecoderMutex);
+        mDecoder = std::move(source.decoder);
 
-    if (avcodec_parameters_to_context(mCodecContext, codecParams) < 0) {
-        std::cerr << "Failed to copy video codec parameters to decoder context" << std::endl;
-        avformat_close_input(&mFormatContext);
-        return;
+        // The track chosen for the previous items carries over
+        if (mAudioRank != AUDIO_NONE) {
+            audio = mDecoder.FindAudioStream(mAudioRank);
+        }
+        mDecoder.SelectStreams(mDecoder.GetStreamIndex(), audio, -1);
     }
 
-    if (avcodec_open2(mCodecContext, codec, nullptr) < 0) {
-        std::cerr << "Could not open video codec" << std::endl;
-        avformat_close_input(&mFormatContext);
-        return;
-    }
+    mDecodingItem = item;
+    mDecodingSource++;
+    mVideoStream = mDecoder.GetStreamIndex();
+    mAudioStream = audio;
+    mSubtitleStream = mDecoder.GetSubtitleStreamIndex();
 
-    mFrame = av_frame_alloc();
-    mFrameRGB = av_frame_alloc();
+    {
+        std::unique_lock<Mutex> lock(mQueueMutex);
+        if (restart) {
+            mSourceChanges = {};
+            mFrameQueue = {};
+        }
 
-    if (!mFrame || !mFrameRGB) {
-        std::cerr << "Could not allocate frames" << std::endl;
-        return;
+        mSourceChanges.push({
+            mDecodingSource, mDecodingItem, source.media,
+            mDecoder.GetStreamIndex(), source.needsIndex,
+            mDecoder.GetDuration(), mDecoder.GetFrameDuration()
+        });
+
+        if (!restart) {
+            SharedPtr<const ColorLut> lut = GetLut();
+
+            for (const auto& frame : source.frames) {
+                frame->source = mDecodingSource;
+                if (lut) {
+                    lut->Apply(frame->data, frame->width, frame->height);
+                    frame->lut = lut;
+                }
+                mFrameQueue.push(frame);
+            }
+            mQueueEmptyCV.notify_one();
+        }
     }
 
-    mPacket = av_packet_alloc();
-    if (!mPacket) {
-        std::cerr << "Could not allocate packet" << std::endl;
-        return;
+    Optional<size_t> following = mPlaylist->GetNext(mDecodingItem);
+
+    if (following) {
+        mPlaylist->Prepare(*following, mDecoder.GetStream()->codecpar);
     }
+}
 
-    int numBytes = av_image_get_buffer_size(
-        AV_PIX_FMT_RGBA, mCodecContext->width, mCodecContext->height, 1);
-    mBuffer = (Uint8*)av_malloc(numBytes);
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::ReturnToSeekItem(void)
+{
+    size_t item = mSeekItem;
+    UniquePtr<Source> source = mPlaylist->Take(item);
 
-    if (!mBuffer) {
-        std::cerr << "Could not allocate buffer" << std::endl;
-        return;
+    // Taken without previous parameters, the source has its own codec
+    if (!source || source->sharesCodec) {
+        std::cerr << "Could not reopen " << mPlaylist->GetItem(item) << std::endl;
+        return (false);
     }
 
-    av_image_fill_arrays(
-        mFrameRGB->data, mFrameRGB->linesize, mBuffer, AV_PIX_FMT_RGBA,
-        mCodecContext->width, mCodecContext->height, 1
-    );
+    StartSource(item, *source, true);
+    return (true);
+}
 
-    mSwsContext = sws_getContext(
-        mCodecContext->width, mCodecContext->height, mCodecContext->pix_fmt,
-        mCodecContext->width, mCodecContext->height, AV_PIX_FMT_RGBA,
-        SWS_BILINEAR, nullptr, nullptr, nullptr
-    );
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::ApplySourceChange(Uint32 serial)
+{
+    Optional<SourceChange> change;
+
+    {
+        std::unique_lock<Mutex> lock(mQueueMutex);
+        while (!mSourceChanges.empty() &&
+            mSourceChanges.front().serial <= serial
+        ) {
+            change = std::move(mSourceChanges.front());
+            mSourceChanges.pop();
+        }
+    }
 
-    if (!mSwsContext) {
-        std::cerr << "Could not initialize SWS context" << std::endl;
+    mCurrentSource = serial;
+
+    if (!change) {
         return;
     }
 
-    if (!mTexture.resize({
-        static_cast<Uint32>(mCodecContext->width),
-        static_cast<Uint32>(mCodecContext->height)
-    })) {
-        std::cerr << "Could not resize SFML texture" << std::endl;
+    mMedia = change->media;
+    mCurrentItem = change->item;
+    mDuration = change->duration;
+    mFrameDuration = change->frameDuration;
+
+    // Keyframes and GOPs belong to the previous item
+    {
+        std::unique_lock<Mutex> lock(mQueueMutex);
+        mKeyframeIndex = change->needsIndex
+            ? std::make_shared<KeyframeIndex>(mMedia->filePath, change->stream)
+            : nullptr;
     }
+    mStreamsChanged = true;
+    mDecodeTask.Wake();
 
-    mDecodeThread = Thread(&VideoPlayer::DecodeFrame, this);
+    mStepper = std::make_unique<FrameStepper>(
+        mMedia->filePath, change->stream, mKeyframeIndex,
+        GetFrameCacheBudget());
+    mStepper->SetActive(!mIsPlaying);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::DecodeFrame(void)
 {
-    AVRational timeBase =
-        mFormatContext->streams[mVideoStreamIndex]->time_base;
-    bool endOfFile = false;
-
     while (!mStopDecoding) {
-        {
-            std::unique_lock<Mutex> lock(mQueueMutex);
-            if (mFrameQueue.size() >= MAX_QUEUE_SIZE && !endOfFile) {
-                mQueueFullCV.wait(lock, [this]{
-                    return (mFrameQueue.size() < MAX_QUEUE_SIZE || mStopDecoding);
-                });
+        if (mStreamsChanged.exchange(false)) {
+            SharedPtr<KeyframeIndex> index;
 
-                if (mStopDecoding) {
-                    break;
-                }
+            {
+                std::unique_lock<Mutex> lock(mQueueMutex);
+                index = mKeyframeIndex;
+            }
+
+            std::unique_lock<Mutex> lock(mDecoderMutex);
+
+            if (!mDecoder.SelectStreams(
+                mVideoStream, mAudioStream, mSubtitleStream)
+            ) {
+                std::cerr << "Could not select streams" << std::endl;
+            } else {
+                mDecoder.SetKeyframeIndex(index);
+                mFrameDuration = mDecoder.GetFrameDuration();
             }
+            mFilter.Reset();
         }
 
-        if (!mIsPlaying) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            continue;
+        if (mFiltersChanged.exchange(false)) {
+            std::unique_lock<Mutex> lock(mFilterMutex);
+            mFilter.SetDescription(mFilterDescription);
+            mFilter.SetDeinterlace(mDeinterlace);
         }
 
-        int readResult = av_read_frame(mFormatContext, mPacket);
-        if (readResult < 0) {
-            if (readResult == AVERROR_EOF) {
-                endOfFile = true;
-                avcodec_send_packet(mCodecContext, nullptr);
+        if (mSeekRequested.exchange(false)) {
+            double target = mSeekTarget;
+
+            // The decoder may already be in the next item while the previous
+            // one is shown, the seek is meant for the shown one
+            if (mPlaylist && mSeekSource != mDecodingSource) {
+                ReturnToSeekItem();
+            }
+
+            if (!mDecoder.Seek(target)) {
+                std::cerr << "Could not seek to timestamp: " << target << std::endl;
             } else {
-                break;
+                mFilter.Reset();
+
+                std::unique_lock<Mutex> lock(mQueueMutex);
+                mFrameQueue = {};
+                mEndOfFile = false;
+                mSkipUntil = target;
             }
         }
 
-        if (!endOfFile && mPacket->stream_index != mVideoStreamIndex) {
-            av_packet_unref(mPacket);
-            continue;
+        {
+            std::unique_lock<Mutex> lock(mQueueMutex);
+            if (mFrameQueue.size() >= MAX_QUEUE_SIZE || mEndOfFile) {
+                return;
+            }
         }
 
-        if (!endOfFile && avcodec_send_packet(mCodecContext, mPacket) < 0) {
-            av_packet_unref(mPacket);
-            continue;
-        }
+        Decoder::Status status = mDecoder.Decode(mFrame);
 
-        while (true) {
-            int ret = avcodec_receive_frame(mCodecContext, mFrame);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
-                break;
-            } else if (ret < 0) {
-                mStopDecoding = true;
-                break;
+        if (status == Decoder::Status::EndOfFile) {
+            // Temporal filters still hold the last pictures
+            if (mFilter.IsEnabled() && mFilter.Push(nullptr)) {
+                DrainFilter();
             }
+            mFilter.Reset();
 
-            double timestamp = 0.0;
-            if (mFrame->pts != AV_NOPTS_VALUE) {
-                timestamp = av_q2d(timeBase) * mFrame->pts;
+            if (mPlaylist && SwitchToNextSource()) {
+                mSkipUntil = -1.0;
+            } else {
+                mEndOfFile = true;
             }
+            continue;
+        } else if (status == Decoder::Status::Error) {
+            mStopDecoding = true;
+            return;
+        }
+
+        mFilter.Detect(mFrame);
+
+        if (!mFilter.IsEnabled()) {
+            QueuePicture(mFrame, mDecoder.GetFrameDuration());
+        } else {
+            mFilter.SetTimeBase(mDecoder.GetStream()->time_base);
+            mFilter.SetFrameRate(mDecoder.GetFrameRate());
 
-            int numBytes = av_image_get_buffer_size(
-                AV_PIX_FMT_RGBA, mCodecContext->width, mCodecContext->height, 1);
-            Uint8* frameBuffer = (Uint8*)av_malloc(numBytes);
+            if (mFilter.Push(mFrame)) {
+                av_frame_unref(mFrame);
+                DrainFilter();
 
-            if (!frameBuffer) {
-                continue;
+                std::unique_lock<Mutex> lock(mFilterMutex);
+                mFilterStats = mFilter.GetStats();
+            } else {
+                // Better the unfiltered picture than none
+                {
+                    std::unique_lock<Mutex> lock(mFilterMutex);
+                    mFilterError = mFilter.GetError();
+                }
+                QueuePicture(mFrame, mDecoder.GetFrameDuration());
             }
+        }
+    }
+}
 
-            AVFrame* tempFrame = av_frame_alloc();
-            av_image_fill_arrays(
-                tempFrame->data, tempFrame->linesize, frameBuffer, AV_PIX_FMT_RGBA,
-                mCodecContext->width, mCodecContext->height, 1
-            );
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::QueuePicture(AVFrame* picture, double duration)
+{
+    Int64 pts = Decoder::GetFramePts(picture);
+    double timestamp = mDecoder.ToSeconds(pts);
 
-            sws_scale(
-                mSwsContext, mFrame->data, mFrame->linesize, 0,
-                mCodecContext->height, tempFrame->data, tempFrame->linesize
-            );
+    // Seeking lands on a keyframe, drop what precedes the requested time.
+    // A picture without a timestamp cannot be placed, it is kept
+    if (pts != AV_NOPTS_VALUE && timestamp < mSkipUntil) {
+        av_frame_unref(picture);
+        return;
+    }
 
-            {
-                std::unique_lock<Mutex> lock(mQueueMutex);
-                mFrameQueue.push(std::make_shared<VideoFrame>(
-                    frameBuffer, mFrame->pts, timestamp
-                ));
-                mCurrentTimestamp = timestamp;
+    mConverter.SetToneMapping(mToneMapping);
+    SharedPtr<VideoFrame> frame = mConverter.ConvertToFit(
+        picture, pts, timestamp, mMaxWidth, mMaxHeight);
 
-                mQueueEmptyCV.notify_one();
-            }
+    if (frame && mKeepPictures) {
+        frame->picture = av_frame_clone(picture);
+    }
+    av_frame_unref(picture);
 
-            av_frame_free(&tempFrame);
+    if (!frame) {
+        return;
+    }
+    frame->source = mDecodingSource;
+    frame->duration = duration;
 
-            if (mPlaybackSpeed != 1.0) {
-                std::this_thread::sleep_for(
-                    std::chrono::milliseconds(static_cast<int>(10 / mPlaybackSpeed))
-                );
-            }
+    if (SharedPtr<const ColorLut> lut = GetLut()) {
+        lut->Apply(frame->data, frame->width, frame->height);
+        frame->lut = lut;
+    }
+
+    // A frame decoded before a pending seek is stale
+    std::unique_lock<Mutex> lock(mQueueMutex);
+    if (mSeekRequested) {
+        return;
+    }
+    mFrameQueue.push(frame);
+    mQueueEmptyCV.notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::DrainFilter(void)
+{
+    while (mFilter.Pull(mFiltered)) {
+        AVRational rate = mFilter.GetFrameRate();
+        double duration = mDecoder.GetFrameDuration();
+
+        // Without a known rate, a deinterlacer still sends two fields
+        if (rate.num > 0 && rate.den > 0) {
+            duration = av_q2d(av_inv_q(rate));
+        } else if (mFilter.GetStats().deinterlacing) {
+            duration /= 2.0;
         }
+        QueuePicture(mFiltered, duration);
+    }
+}
 
-        if (!endOfFile) {
-            av_packet_unref(mPacket);
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::PresentFrame(const SharedPtr<VideoFrame>& frame)
+{
+    if (!frame || !frame->data) {
+        return (false);
+    }
+
+    sf::Vector2u size(frame->width, frame->height);
+
+    if (mTarget) {
+        sf::Vector2u end = mTargetPosition + size;
+
+        if (end.x > mTarget->getSize().x || end.y > mTarget->getSize().y) {
+            return (false);
+        }
+        mTarget->update(frame->data, size, mTargetPosition);
+    } else {
+        if (mTexture.getSize() != size && !mTexture.resize(size)) {
+            std::cerr << "Could not resize SFML texture" << std::endl;
+            return (false);
         }
+        mTexture.update(frame->data, size, {0U, 0U});
+    }
+
+    if (frame->duration > 0.0) {
+        mFrameDuration = frame->duration;
+    }
 
-        if (endOfFile && avcodec_receive_frame(mCodecContext, mFrame) == AVERROR_EOF) {
-            break;
+    mFrameSize = size;
+    mShownFrame = frame;
+    mPresentedFrames++;
+    mCurrentPts = frame->pts;
+    mCurrentTimestamp = frame->timestamp;
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetPlaying(bool playing)
+{
+    // The pause is not lateness, the next frame is due right away
+    if (playing && !mIsPlaying) {
+        mLastFrameTime = mPlaybackClock.getElapsedTime().asSeconds() -
+            mFrameDuration / mPlaybackSpeed;
+    }
+    mIsPlaying = playing;
+
+    if (mStepper) {
+        if (!playing) {
+            mStepper->SetCursor(mCurrentPts);
+        }
+        mStepper->SetActive(!playing);
+    }
+
+    // The forward queue and the reverse engine are stale after stepping,
+    // restart them half a frame away so the current frame is not repeated
+    if (playing && mStepped) {
+        mStepped = false;
+        mPendingStep = 0;
+        Seek(mCurrentTimestamp + (mReverse ? -0.5 : 0.5) * mFrameDuration);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::IsPrerolled(void)
+{
+    if (mReverse) {
+        return (true);
+    }
+
+    std::unique_lock<Mutex> lock(mQueueMutex);
+    return (
+        mFrameQueue.size() >= std::min(mPrerollDepth, MAX_QUEUE_SIZE) ||
+        mEndOfFile || mStopDecoding
+    );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::ProcessPendingSeek(void)
+{
+    if (!mShowNextFrame) {
+        return (false);
+    }
+
+    SharedPtr<VideoFrame> frame = nullptr;
+
+    {
+        std::unique_lock<Mutex> lock(mQueueMutex);
+        if (mFrameQueue.empty()) {
+            return (false);
         }
+
+        frame = mFrameQueue.front();
+        mFrameQueue.pop();
+        mDecodeTask.Wake();
+    }
+
+    mShowNextFrame = false;
+
+    if (frame->source != mCurrentSource) {
+        ApplySourceChange(frame->source);
+    }
+
+    if (mStepper) {
+        mStepper->SetCursor(frame->pts);
+    }
+    return (PresentFrame(frame));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::ProcessPendingStep(void)
+{
+    if (mPendingStep == 0 || !mStepper) {
+        return (false);
+    }
+
+    SharedPtr<VideoFrame> frame = mStepper->Step(mPendingStep);
+
+    if (!frame) {
+        return (false);
     }
+
+    mPendingStep = 0;
+    mStepped = true;
+    return (PresentFrame(frame));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::Play(void)
 {
-    mIsPlaying = true;
+    SetPlaying(true);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::Pause(void)
 {
-    mIsPlaying = false;
+    SetPlaying(false);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::Stop(void)
 {
-    mIsPlaying = false;
+    SetPlaying(false);
     mStopDecoding = true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::TogglePause(void)
 {
-    mIsPlaying = !mIsPlaying;
+    SetPlaying(!mIsPlaying);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::StepForward(void)
+{
+    if (mIsPlaying) {
+        SetPlaying(false);
+    }
+    mPendingStep = 1;
+    ProcessPendingStep();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::StepBackward(void)
+{
+    if (mIsPlaying) {
+        SetPlaying(false);
+    }
+    mPendingStep = -1;
+    ProcessPendingStep();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetFrameCacheBudget(Uint64 bytes)
+{
+    if (mStepper) {
+        mStepper->SetBudget(bytes);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 VideoPlayer::GetFrameCacheBudget(void) const
+{
+    return (mStepper ? mStepper->GetBudget() : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 VideoPlayer::GetFrameCacheSize(void) const
+{
+    return (mStepper ? mStepper->GetSize() : 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<KeyframeIndex>& VideoPlayer::GetKeyframeIndex(void) const
+{
+    return (mKeyframeIndex);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::Seek(double seconds)
 {
-    Int64 timestamp = static_cast<Int64>(seconds * AV_TIME_BASE);
-    if (av_seek_frame(mFormatContext,
-        mVideoStreamIndex, timestamp, AVSEEK_FLAG_BACKWARD) < 0
-    ) {
-        std::cerr << "Could not seek to timestamp: " << seconds << std::endl;
-        return;
+    seconds = std::max(0.0, seconds);
+
+    std::unique_lock<Mutex> decoderLock(mDecoderMutex);
+    Int64 pts = mDecoder.ToPts(seconds);
+
+    decoderLock.unlock();
+
+    if (mReverse) {
+        mReverse = std::make_unique<ReversePlayback>(
+            mMedia->filePath, mVideoStream, mKeyframeIndex,
+            pts + 1);
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mQueueMutex);
+        mFrameQueue = {};
+        mSeekTarget = seconds;
+        mSeekSource = mCurrentSource;
+        mSeekItem = mCurrentItem;
+        mSeekRequested = true;
+    }
+    mCurrentTimestamp = seconds;
+    mPrerolling = true;
+    mDecodeTask.Wake();
+
+    // While paused, the first frame decoded at the new position is shown
+    if (!mIsPlaying) {
+        mShowNextFrame = true;
+    }
+
+    if (mStepper && !mIsPlaying) {
+        mStepper->SetCursor(pts);
     }
-    avcodec_flush_buffers(mCodecContext);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 double VideoPlayer::GetDuration(void) const
 {
-    if (mFormatContext && mFormatContext->duration != AV_NOPTS_VALUE) {
-        return (static_cast<double>(mFormatContext->duration) / AV_TIME_BASE);
-    }
-    return (0.0);
+    return (mDuration);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -362,6 +768,118 @@ double VideoPlayer::GetCurrentTime(void) const
     return (mCurrentTimestamp);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::SelectStream(Stream::Type type, int index)
+{
+    {
+        std::unique_lock<Mutex> lock(mDecoderMutex);
+        if (!mDecoder.IsOpen()) {
+            return (false);
+        }
+    }
+
+    bool found = index < 0 && type != Stream::Type::Video;
+
+    for (const auto& stream : mMedia->streams) {
+        found = found || (
+            stream->type == type && static_cast<int>(stream->index) == index
+        );
+    }
+
+    if (!found) {
+        return (false);
+    }
+
+    if (type == Stream::Type::Audio) {
+        int rank = 0;
+
+        for (const auto& stream : mMedia->streams) {
+            rank += stream->type == type &&
+                static_cast<int>(stream->index) < index;
+        }
+        mAudioStream = index;
+        mAudioRank = index < 0 ? AUDIO_NONE : rank;
+    } else if (type == Stream::Type::Subtitle) {
+        mSubtitleStream = index;
+    } else if (index != mVideoStream) {
+        mVideoStream = index;
+
+        // Keyframes and GOPs belong to the previous stream
+        {
+            std::unique_lock<Mutex> lock(mQueueMutex);
+            if (mKeyframeIndex) {
+                mKeyframeIndex = std::make_shared<KeyframeIndex>(
+                    mMedia->filePath, index);
+            }
+        }
+
+        mStepper = std::make_unique<FrameStepper>(
+            mMedia->filePath, index, mKeyframeIndex, GetFrameCacheBudget());
+        mStepper->SetActive(!mIsPlaying);
+        mCurrentPts = AV_NOPTS_VALUE;
+        mStreamsChanged = true;
+        Seek(mCurrentTimestamp);
+        return (true);
+    }
+
+    mStreamsChanged = true;
+    mDecodeTask.Wake();
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int VideoPlayer::GetSelectedStream(Stream::Type type) const
+{
+    if (type == Stream::Type::Audio) {
+        return (mAudioStream);
+    } else if (type == Stream::Type::Subtitle) {
+        return (mSubtitleStream);
+    }
+    return (mVideoStream);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetPrerollDepth(size_t frames)
+{
+    mPrerollDepth = std::max<size_t>(1, frames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t VideoPlayer::GetPrerollDepth(void) const
+{
+    return (mPrerollDepth);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double VideoPlayer::GetTimeToFirstFrame(void) const
+{
+    return (mTimeToFirstFrame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double VideoPlayer::GetTimeToPreroll(void) const
+{
+    return (mTimeToPreroll);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<Media>& VideoPlayer::GetMedia(void) const
+{
+    return (mMedia);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<Playlist>& VideoPlayer::GetPlaylist(void) const
+{
+    return (mPlaylist);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t VideoPlayer::GetCurrentItem(void) const
+{
+    return (mCurrentItem);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 void VideoPlayer::SetPlaybackSpeed(double speed)
 {
@@ -375,47 +893,314 @@ double VideoPlayer::GetPlaybackSpeed(void) const
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void VideoPlayer::Update(void)
+void VideoPlayer::SetReverse(bool reverse)
 {
-    if (!mIsPlaying) {
+    std::unique_lock<Mutex> lock(mDecoderMutex);
+
+    if (reverse == IsReverse() || !mDecoder.IsOpen()) {
         return;
     }
 
+    Int64 pts = mDecoder.ToPts(mCurrentTimestamp);
+
+    lock.unlock();
+
+    if (reverse) {
+        Int64 cursor = mCurrentPts != AV_NOPTS_VALUE ? mCurrentPts : pts;
+        mReverse = std::make_unique<ReversePlayback>(
+            mMedia->filePath, mVideoStream, mKeyframeIndex, cursor);
+    } else {
+        mReverse.reset();
+        Seek(mCurrentTimestamp);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::IsReverse(void) const
+{
+    return (mReverse != nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::IsPlaying(void) const
+{
+    return (mIsPlaying);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::IsPrerolling(void) const
+{
+    return (mPrerolling);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool VideoPlayer::Update(void)
+{
+    if (!mIsPlaying) {
+        return (ProcessPendingSeek() || ProcessPendingStep());
+    }
+
     SharedPtr<VideoFrame> frame = nullptr;
+    double now = mPlaybackClock.getElapsedTime().asSeconds();
+
+    // The clock only starts once enough frames are buffered, so playback
+    // does not stutter right after opening or seeking
+    if (mPrerolling) {
+        if (!IsPrerolled()) {
+            return (false);
+        }
+
+        mPrerolling = false;
+        mLastFrameTime = now - mFrameDuration / mPlaybackSpeed;
+
+        if (mTimeToPreroll == 0.0) {
+            mTimeToPreroll = now - mOpenTime;
+        }
+    }
+
+    double interval = mFrameDuration / mPlaybackSpeed;
+
+    if (now - mLastFrameTime < interval) {
+        return (false);
+    }
+
+    if (mReverse) {
+        frame = mReverse->NextFrame();
+
+        // On a stall the timer is kept so the frame shows as soon as ready
+        if (!frame) {
+            return (false);
+        }
+        mLastFrameTime = now;
+    } else {
+        // Every full interval elapsed beyond the first is a frame that
+        // should already have been shown
+        double elapsed = now - mLastFrameTime;
+        size_t late = mDropLateFrames && elapsed >= 2.0 * interval
+            ? static_cast<size_t>(elapsed / interval) - 1
+            : 0;
+
+        mLastFrameTime = now;
 
+        {
+            std::unique_lock<Mutex> lock(mQueueMutex);
+            if (mFrameQueue.empty()) {
+                return (false);
+            }
+
+            frame = mFrameQueue.front();
+            mFrameQueue.pop();
+
+            while (late > 0 && !mFrameQueue.empty()) {
+                frame = mFrameQueue.front();
+                mFrameQueue.pop();
+                mDroppedFrames++;
+                late--;
+            }
+
+            mDecodeTask.Wake();
+        }
+
+        if (frame->source != mCurrentSource) {
+            ApplySourceChange(frame->source);
+        }
+    }
+
+    return (PresentFrame(frame));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double VideoPlayer::GetNextUpdateDelay(void) const
+{
+    if (!mIsPlaying) {
+        return (mPendingStep != 0 || mShowNextFrame
+            ? POLL_INTERVAL : std::numeric_limits<double>::infinity());
+    }
+
+    if (IsEndOfVideo()) {
+        return (std::numeric_limits<double>::infinity());
+    }
+
+    if (mPrerolling) {
+        return (POLL_INTERVAL);
+    }
+
+    double due = mLastFrameTime + mFrameDuration / mPlaybackSpeed -
+        mPlaybackClock.getElapsedTime().asSeconds();
+
+    return (due > 0.0 ? due : POLL_INTERVAL);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Texture& VideoPlayer::GetCurrentFrameTexture(void) const
+{
+    return (mTexture);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetTarget(sf::Texture* texture, sf::Vector2u position)
+{
+    mTarget = texture;
+    mTargetPosition = position;
+
+    if (mTarget && mTexture.getSize() == mFrameSize && mFrameSize.x > 0) {
+        sf::Vector2u end = mTargetPosition + mFrameSize;
+
+        if (end.x <= mTarget->getSize().x && end.y <= mTarget->getSize().y) {
+            mTarget->update(mTexture, mTargetPosition);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+const SharedPtr<VideoFrame>& VideoPlayer::GetCurrentFrame(void) const
+{
+    return (mShownFrame);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetKeepPictures(bool keep)
+{
+    mKeepPictures = keep;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetFilters(const String& description)
+{
     {
-        static double frameDuration = 1.0 / av_q2d(
-            mFormatContext->streams[mVideoStreamIndex]->avg_frame_rate
-        );
+        std::unique_lock<Mutex> lock(mFilterMutex);
+        if (description == mFilterDescription) {
+            return;
+        }
+        mFilterDescription = description;
+        mFilterError.clear();
+    }
+    mFiltersChanged = true;
+
+    // Decode the shown frame again, through the new filters
+    if (!mIsPlaying && mShownFrame) {
+        Seek(mShownFrame->timestamp);
+    } else {
+        mDecodeTask.Wake();
+    }
+}
 
-        if (mPlaybackClock.getElapsedTime().asSeconds() - mLastFrameTime < frameDuration / mPlaybackSpeed) {
+///////////////////////////////////////////////////////////////////////////////
+String VideoPlayer::GetFilters(void)
+{
+    std::unique_lock<Mutex> lock(mFilterMutex);
+    return (mFilterDescription);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+String VideoPlayer::GetFilterError(void)
+{
+    std::unique_lock<Mutex> lock(mFilterMutex);
+    return (mFilterError);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetDeinterlace(FilterGraph::Deinterlace mode)
+{
+    {
+        std::unique_lock<Mutex> lock(mFilterMutex);
+        if (mode == mDeinterlace) {
             return;
         }
-        mLastFrameTime = mPlaybackClock.getElapsedTime().asSeconds();
+        mDeinterlace = mode;
+    }
+    mFiltersChanged = true;
 
-        std::unique_lock<Mutex> lock(mQueueMutex);
-        if (mFrameQueue.empty()) {
+    if (!mIsPlaying && mShownFrame) {
+        Seek(mShownFrame->timestamp);
+    } else {
+        mDecodeTask.Wake();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+FilterGraph::Deinterlace VideoPlayer::GetDeinterlace(void)
+{
+    std::unique_lock<Mutex> lock(mFilterMutex);
+    return (mDeinterlace);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+FilterGraph::Stats VideoPlayer::GetFilterStats(void)
+{
+    std::unique_lock<Mutex> lock(mFilterMutex);
+    return (mFilterStats);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetLut(SharedPtr<const ColorLut> lut)
+{
+    {
+        std::unique_lock<Mutex> lock(mFilterMutex);
+        if (lut == mLut) {
             return;
         }
+        mLut = std::move(lut);
+    }
 
-        frame = mFrameQueue.front();
-        mFrameQueue.pop();
+    if (!mIsPlaying && mShownFrame) {
+        Seek(mShownFrame->timestamp);
+    }
+}
 
-        mQueueFullCV.notify_one();
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<const ColorLut> VideoPlayer::GetLut(void)
+{
+    std::unique_lock<Mutex> lock(mFilterMutex);
+    return (mLut);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+SharedPtr<const ColorLut> VideoPlayer::GetShownLut(void) const
+{
+    return (mShownFrame ? mShownFrame->lut : nullptr);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetToneMapping(ToneMap::Curve curve)
+{
+    if (mToneMapping.exchange(curve) == curve) {
+        return;
     }
 
-    if (frame && frame->data) {
-        mTexture.update(frame->data, {
-            static_cast<Uint32>(mCodecContext->width),
-            static_cast<Uint32>(mCodecContext->height)
-        }, {0U, 0U});
+    if (!mIsPlaying && mShownFrame) {
+        Seek(mShownFrame->timestamp);
     }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-sf::Texture& VideoPlayer::GetCurrentFrameTexture(void) const
+ToneMap::Curve VideoPlayer::GetToneMapping(void) const
 {
-    return (mTexture);
+    return (mToneMapping);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+sf::Vector2u VideoPlayer::GetFrameSize(void) const
+{
+    return (mFrameSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void VideoPlayer::SetDropLateFrames(bool drop)
+{
+    mDropLateFrames = drop;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 VideoPlayer::GetPresentedFrames(void) const
+{
+    return (mPresentedFrames);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 VideoPlayer::GetDroppedFrames(void) const
+{
+    return (mDroppedFrames);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -428,7 +1213,10 @@ size_t VideoPlayer::GetQueueSize(void)
 ///////////////////////////////////////////////////////////////////////////////
 bool VideoPlayer::IsEndOfVideo(void) const
 {
-    return (mStopDecoding && mFrameQueue.empty());
+    if (mReverse) {
+        return (mReverse->IsFinished());
+    }
+    return ((mStopDecoding || mEndOfFile) && mFrameQueue.empty());
 }
 
 } // namespace Moon
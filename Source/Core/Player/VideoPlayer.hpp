@@ -8,13 +8,19 @@
 ///////////////////////////////////////////////////////////////////////////////
 #include "Core/Config/Config.hpp"
 #include "Core/Media/Media.hpp"
+#include "Core/Player/VideoFrame.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/Player/ColorLut.hpp"
+#include "Core/Player/FilterGraph.hpp"
+#include "Core/Player/ReversePlayback.hpp"
+#include "Core/Player/FrameStepper.hpp"
+#include "Core/Player/KeyframeIndex.hpp"
+#include "Core/Player/Source.hpp"
+#include "Core/Player/Playlist.hpp"
+#include "Core/System/SerialTask.hpp"
 #include <SFML/Graphics.hpp>
 #include <queue>
-extern "C" {
-    #include <libavformat/avformat.h>
-    #include <libavcodec/avcodec.h>
-    #include <libswscale/swscale.h>
-}
 
 ///////////////////////////////////////////////////////////////////////////////
 // Namespace Moon
@@ -22,68 +28,127 @@ extern "C" {
 namespace Moon
 {
 
-///////////////////////////////////////////////////////////////////////////////
-/// \brief Frame structure to hold decoded video frame data
-///
-///////////////////////////////////////////////////////////////////////////////
-struct VideoFrame
-{
-    Uint8* data;
-    Int64 pts;
-    double timestamp;
-    
-    VideoFrame() : data(nullptr), pts(AV_NOPTS_VALUE), timestamp(0.0) {}
-    
-    VideoFrame(Uint8* frameData, Int64 framePts, double frameTimestamp)
-        : data(frameData), pts(framePts), timestamp(frameTimestamp) {}
-        
-    ~VideoFrame() {
-        if (data) {
-            av_free(data);
-            data = nullptr;
-        }
-    }
-};
-
 ///////////////////////////////////////////////////////////////////////////////
 /// \brief
 ///
 ///////////////////////////////////////////////////////////////////////////////
 class VideoPlayer
 {
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Playlist item reached by the decoding thread
+    ///
+    /// Applied on the main thread once its first frame is presented.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct SourceChange
+    {
+        Uint32 serial;
+        size_t item;
+        SharedPtr<Media> media;
+        int stream;
+        bool needsIndex;
+        double duration;
+        double frameDuration;
+    };
+
 private:
     ///////////////////////////////////////////////////////////////////////////
     //
     ///////////////////////////////////////////////////////////////////////////
     SharedPtr<Media> mMedia;
-    AVFormatContext* mFormatContext;
-    AVCodecContext* mCodecContext;
+    Decoder mDecoder;
+    Mutex mDecoderMutex;
+    Atomic<double> mDuration{0.0};
+    FrameConverter mConverter;
     AVFrame* mFrame;
-    AVFrame* mFrameRGB;
-    AVPacket* mPacket;
-    struct SwsContext* mSwsContext;
-    Uint8* mBuffer;
     mutable sf::Texture mTexture;
-    int mVideoStreamIndex;
     bool mIsPlaying;
     double mPlaybackSpeed;
+    Atomic<double> mFrameDuration;
 
-    Thread mDecodeThread;
     Mutex mFrameMutex;
     ConditionVariable mFrameCV;
     Atomic<bool> mStopDecoding{false};
     Atomic<bool> mNewFrameReady{false};
 
     static constexpr size_t MAX_QUEUE_SIZE = 30;
+    static constexpr double POLL_INTERVAL = 0.002;
+    static constexpr size_t DEFAULT_PREROLL_DEPTH = 8;
+    static constexpr int AUDIO_BEST = -1;
+    static constexpr int AUDIO_NONE = -2;
     std::queue<SharedPtr<VideoFrame>> mFrameQueue;
     Mutex mQueueMutex;
-    ConditionVariable mQueueFullCV;
     ConditionVariable mQueueEmptyCV;
     Atomic<double> mCurrentTimestamp{0.0};
+    Atomic<bool> mEndOfFile{false};
+
+    Atomic<bool> mSeekRequested{false};
+    Atomic<double> mSeekTarget{0.0};
+
+    SharedPtr<KeyframeIndex> mKeyframeIndex;
+
+    Atomic<int> mVideoStream{-1};
+    Atomic<int> mAudioStream{-1};
+    Atomic<int> mAudioRank{AUDIO_BEST};     ///< Audio track kept across items
+    Atomic<int> mSubtitleStream{-1};
+    Atomic<bool> mStreamsChanged{false};
+
+    Int64 mCurrentPts{AV_NOPTS_VALUE};
+    UniquePtr<ReversePlayback> mReverse;
+
+    UniquePtr<FrameStepper> mStepper;
+    int mPendingStep{0};
+    bool mShowNextFrame{false};
+    bool mStepped{false};
 
     sf::Clock mPlaybackClock;
     double mLastFrameTime{0.0};
 
+    size_t mPrerollDepth{DEFAULT_PREROLL_DEPTH};
+    bool mPrerolling{true};
+    double mOpenTime{0.0};
+    double mTimeToFirstFrame{0.0};
+    double mTimeToPreroll{0.0};
+
+    SharedPtr<Playlist> mPlaylist;
+    size_t mDecodingItem{0};
+    size_t mCurrentItem{0};
+    Uint32 mDecodingSource{0};
+    Uint32 mCurrentSource{0};
+    Atomic<Uint32> mSeekSource{0};
+    Atomic<size_t> mSeekItem{0};
+    std::queue<SourceChange> mSourceChanges;
+
+    double mSkipUntil{-1.0};
+
+    Uint32 mMaxWidth{0};
+    Uint32 mMaxHeight{0};
+    sf::Texture* mTarget{nullptr};
+    sf::Vector2u mTargetPosition;
+    sf::Vector2u mFrameSize;
+
+    SharedPtr<VideoFrame> mShownFrame;
+    Atomic<bool> mKeepPictures{false};
+
+    FilterGraph mFilter;
+    AVFrame* mFiltered{nullptr};
+    Mutex mFilterMutex;
+    String mFilterDescription;
+    String mFilterError;
+    FilterGraph::Deinterlace mDeinterlace{FilterGraph::Deinterlace::Auto};
+    FilterGraph::Stats mFilterStats;
+    Atomic<bool> mFiltersChanged{false};
+    SharedPtr<const ColorLut> mLut;
+    Atomic<ToneMap::Curve> mToneMapping{ToneMap::Curve::Bt2390};
+
+    bool mDropLateFrames{false};
+    Uint64 mPresentedFrames{0};
+    Uint64 mDroppedFrames{0};
+    SerialTask mDecodeTask{
+        TaskScheduler::Priority::RealTime, [this]{ DecodeFrame(); }
+    };
+
 public:
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
@@ -93,6 +158,26 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     VideoPlayer(const Path& filePath);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Play a file opened beforehand, usually by a Loader
+    ///
+    /// \param source Opened file, its decoder and frames are taken over
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit VideoPlayer(UniquePtr<Source> source);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Play the items of a playlist back to back
+    ///
+    /// The next item is opened in the background and decoding continues
+    /// into it at the end of the current one, reusing the codec when the
+    /// parameters of both streams match.
+    ///
+    /// \param playlist Items to play
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    VideoPlayer(const SharedPtr<Playlist>& playlist);
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
     ///
@@ -103,15 +188,118 @@ private:
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
     ///
+    /// \param source Opened file, its decoder is taken over
+    ///
     ///////////////////////////////////////////////////////////////////////////
-    void Initialize(void);
+    void Initialize(Source& source);
 
     ///////////////////////////////////////////////////////////////////////////
-    /// \brief
+    /// \brief Continue decoding into the next playlist item
+    ///
+    /// Called by the decoding thread at the end of the current item. Items
+    /// that cannot be opened are skipped.
+    ///
+    /// \return False at the end of the playlist
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool SwitchToNextSource(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode from an opened playlist item
+    ///
+    /// \param item Index of the item in the playlist
+    /// \param source Opened item, its decoder is taken over
+    /// \param restart True when going back to an item for a seek: pending
+    ///                source changes are dropped along with the frames
+    ///                decoded ahead
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void StartSource(size_t item, Source& source, bool restart);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Open the shown item again when the decoder is already past it
+    ///
+    /// \return False if it could not be opened, the seek then applies to
+    ///         the item being decoded
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool ReturnToSeekItem(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Apply the playlist changes reached by a presented frame
+    ///
+    /// \param serial Source serial of the frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void ApplySourceChange(Uint32 serial);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decoding task body, fills the queue then returns
+    ///
+    /// Woken again whenever the queue drains, a seek is requested or the
+    /// selected streams change.
     ///
     ///////////////////////////////////////////////////////////////////////////
     void DecodeFrame(void);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Convert a decoded or filtered picture and queue it
+    ///
+    /// \param picture Picture, unreferenced once queued or dropped
+    /// \param duration Seconds the picture stays on screen at normal speed
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void QueuePicture(AVFrame* picture, double duration);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Queue every picture the filter graph has ready
+    ///
+    /// The pictures are paced at the rate of the graph output, not of the
+    /// stream, since filters may drop or add pictures.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void DrainFilter(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Upload a frame to the texture and make it the current one
+    ///
+    /// \param frame Frame to present
+    ///
+    /// \return True if the texture was updated
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool PresentFrame(const SharedPtr<VideoFrame>& frame);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start or stop playback, switching frame stepping accordingly
+    ///
+    /// \param playing True to play
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetPlaying(bool playing);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Whether enough frames are queued to start the clock
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPrerolled(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Present the frame reached by a seek made while paused
+    ///
+    /// \return True if the frame was presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool ProcessPendingSeek(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Present the requested step if its frame is decoded
+    ///
+    /// \return True if the step was presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool ProcessPendingStep(void);
+
 public:
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
@@ -145,6 +333,138 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     void Seek(double seconds);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pause and show the next frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void StepForward(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Pause and show the previous frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void StepBackward(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set the memory budget of the frame stepping cache
+    ///
+    /// \param bytes Maximum amount of decoded pixels kept around the cursor
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetFrameCacheBudget(Uint64 bytes);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Memory budget of the frame stepping cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetFrameCacheBudget(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Memory used by the frame stepping cache in bytes
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetFrameCacheSize(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Background keyframe index, nullptr if the file has a usable
+    ///         seek index of its own
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<KeyframeIndex>& GetKeyframeIndex(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Select the stream of a type read from the file
+    ///
+    /// Unselected streams are discarded by the demuxer. The switch happens
+    /// on the decoding thread without reopening the file; changing the video
+    /// stream resumes it at the current position. The best audio stream is
+    /// selected when a file opens, and the next playlist items keep the
+    /// audio track chosen here, by its position among the audio streams.
+    ///
+    /// \param type Type of the stream
+    /// \param index Stream::index of one of the Media::streams, -1 to drop
+    ///              every audio or subtitle stream
+    ///
+    /// \return False if there is no such stream
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool SelectStream(Stream::Type type, int index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param type Type of the stream
+    ///
+    /// \return Index of the selected stream of this type, -1 if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    int GetSelectedStream(Stream::Type type) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set how many frames must be queued before the clock starts
+    ///
+    /// Applies when playback starts and after every seek.
+    ///
+    /// \param frames Number of frames, capped to the queue size
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetPrerollDepth(size_t frames);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of frames queued before the clock starts
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetPrerollDepth(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Seconds from opening the file to showing its first frame
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetTimeToFirstFrame(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Seconds from opening the file to starting the clock, 0 until
+    ///         playback started
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    double GetTimeToPreroll(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Description of the file and its streams
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<Media>& GetMedia(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Playlist being played, nullptr for a single file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<Playlist>& GetPlaylist(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Index of the playlist item shown, 0 for a single file
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetCurrentItem(void) const;
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
     ///
@@ -153,6 +473,42 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     void SetPlaybackSpeed(double speed);
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Switch between forward and reverse playback
+    ///
+    /// Reverse playback starts from the frame currently shown. Going back
+    /// forward seeks the forward decoder to the same position.
+    ///
+    /// \param reverse True to play backwards
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetReverse(bool reverse);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True if playing backwards
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsReverse(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True unless paused
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPlaying(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return True while frames are queued after a start or a seek, before
+    ///         the clock runs
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool IsPrerolling(void) const;
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
     ///
@@ -178,10 +534,23 @@ public:
     double GetCurrentTime(void) const;
 
     ///////////////////////////////////////////////////////////////////////////
-    /// \brief
+    /// \brief Present the next frame if it is due
+    ///
+    /// \return True if a new frame was uploaded to the texture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Update(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Time until Update has something to present
+    ///
+    /// Lets the caller sleep between frames instead of polling. While the
+    /// decoder is late, a short polling interval is returned instead.
+    ///
+    /// \return Delay in seconds, infinity when paused with nothing pending
     ///
     ///////////////////////////////////////////////////////////////////////////
-    void Update(void);
+    double GetNextUpdateDelay(void) const;
 
     ///////////////////////////////////////////////////////////////////////////
     /// \brief
@@ -191,6 +560,175 @@ public:
     ///////////////////////////////////////////////////////////////////////////
     sf::Texture& GetCurrentFrameTexture(void) const;
 
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Present frames into a region of another texture
+    ///
+    /// Lets several players share one texture, so that they can be drawn
+    /// in a single batch. The current frame is copied there right away.
+    ///
+    /// \param texture Texture receiving the frames, nullptr to use the
+    ///                texture of the player again
+    /// \param position Top left corner of the region, frames not fitting
+    ///                 in the texture from there are not presented
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetTarget(sf::Texture* texture, sf::Vector2u position);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Frame currently shown, nullptr before the first one
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    const SharedPtr<VideoFrame>& GetCurrentFrame(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Keep the decoded picture of the frames played from now on
+    ///
+    /// Frames from the step cache and reverse playback never have one.
+    ///
+    /// \param keep True to keep them in VideoFrame::picture
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetKeepPictures(bool keep);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Filter the decoded pictures before they are presented
+    ///
+    /// Takes effect without reopening anything: the decoding thread builds
+    /// the new graph at its next picture, frames already queued play out,
+    /// and while paused the current frame is decoded again to show it.
+    /// Pictures from the step cache and reverse playback are not filtered.
+    ///
+    /// \param description Filters in the ffmpeg -vf syntax, empty for none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetFilters(const String& description);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Current filter description
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    String GetFilters(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Why the filters could not be applied, empty if they were
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    String GetFilterError(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Choose when interlaced pictures are deinterlaced
+    ///
+    /// Auto, the default, deinterlaces from the first picture the decoder
+    /// flags as interlaced, to one frame per field.
+    ///
+    /// \param mode Deinterlacing mode
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetDeinterlace(FilterGraph::Deinterlace mode);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Deinterlacing mode
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    FilterGraph::Deinterlace GetDeinterlace(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Counters of the filter stage, updated by the decoding thread
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    FilterGraph::Stats GetFilterStats(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Grade the converted pictures with a 3D LUT on the CPU
+    ///
+    /// The decoding thread picks the table up at its next picture; frames
+    /// already queued keep the previous grade, none is dropped. While paused
+    /// the current frame is decoded again to show it.
+    ///
+    /// \param lut Table to apply, nullptr for none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetLut(SharedPtr<const ColorLut> lut);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Table applied to new pictures, nullptr if none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<const ColorLut> GetLut(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Table the shown frame was graded with on the CPU, nullptr
+    ///         if it was not
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SharedPtr<const ColorLut> GetShownLut(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Choose how PQ and HLG pictures are brought to SDR
+    ///
+    /// Applies from the next decoded picture like SetLut.
+    ///
+    /// \param curve Tone curve, Off to leave HDR to the scaler
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetToneMapping(ToneMap::Curve curve);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Tone curve of HDR pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ToneMap::Curve GetToneMapping(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Size of the frame currently shown
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    sf::Vector2u GetFrameSize(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Skip queued frames when presenting falls behind the clock
+    ///
+    /// Off by default, playback then slows down instead.
+    ///
+    /// \param drop True to drop late frames
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetDropLateFrames(bool drop);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of frames presented since opening
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetPresentedFrames(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Number of late frames skipped since opening
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Uint64 GetDroppedFrames(void) const;
+
     ///////////////////////////////////////////////////////////////////////////
     /// \brief Get the current queue size
     ///
@@ -0,0 +1,16 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/Priority.hpp"
+#include "Core/System/ResourceUsage.hpp"
+#include "Core/System/CacheDirectory.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include "Core/System/TaskScheduler.hpp"
+#include "Core/System/ParallelFor.hpp"
+#include "Core/System/SerialTask.hpp"
+#include "Core/System/SampleRing.hpp"
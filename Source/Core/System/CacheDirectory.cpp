@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/CacheDirectory.hpp"
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static Path GetCacheRoot(void)
+{
+    const char* cache = std::getenv("XDG_CACHE_HOME");
+
+    if (cache && *cache) {
+        return (Path(cache) / "moon");
+    }
+
+    const char* home = std::getenv("HOME");
+
+    if (home && *home) {
+        return (Path(home) / ".cache" / "moon");
+    }
+    return (Path());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Path GetCacheDirectory(const Path& filePath)
+{
+    std::error_code error;
+    Path absolute = std::filesystem::absolute(filePath, error);
+    Uint64 size = std::filesystem::file_size(filePath, error);
+
+    if (error) {
+        return (Path());
+    }
+
+    auto modified = std::filesystem::last_write_time(filePath, error);
+    Path root = GetCacheRoot();
+
+    if (error || root.empty()) {
+        return (Path());
+    }
+
+    // FNV-1a over the identity of the file
+    String key = absolute.string() + '\n' + std::to_string(size) + '\n' +
+        std::to_string(modified.time_since_epoch().count());
+    Uint64 hash = 14695981039346656037ULL;
+
+    for (char c : key) {
+        hash = (hash ^ static_cast<Uint8>(c)) * 1099511628211ULL;
+    }
+
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016" PRIx64, hash);
+
+    Path directory = root / name;
+
+    std::filesystem::create_directories(directory, error);
+    if (error) {
+        std::cerr << "Could not create cache directory " << directory
+            << ": " << error.message() << std::endl;
+        return (Path());
+    }
+    return (directory);
+}
+
+} // namespace Moon
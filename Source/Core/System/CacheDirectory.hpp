@@ -0,0 +1,32 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Directory holding the data computed for a media file
+///
+/// Keyframe indexes and analysis results are kept under the user cache
+/// directory ($XDG_CACHE_HOME/moon, or ~/.cache/moon), in one directory per
+/// file named after its absolute path, size and modification time, so that
+/// an edited file never reuses stale data.
+///
+/// \param filePath Path of the media file
+///
+/// \return The directory, created if needed, empty on failure
+///
+///////////////////////////////////////////////////////////////////////////////
+Path GetCacheDirectory(const Path& filePath);
+
+} // namespace Moon
@@ -0,0 +1,29 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/CpuFeatures.hpp"
+extern "C" {
+    #include <libavutil/cpu.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+bool HasAvx2(void)
+{
+#if MOON_X86
+    static const bool available = (av_get_cpu_flags() &
+        (AV_CPU_FLAG_AVX2 | AV_CPU_FLAG_FMA3)) ==
+        (AV_CPU_FLAG_AVX2 | AV_CPU_FLAG_FMA3);
+
+    return (available);
+#else
+    return (false);
+#endif
+}
+
+} // namespace Moon
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// SIMD kernels
+///////////////////////////////////////////////////////////////////////////////
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #include <immintrin.h>
+    #define MOON_X86 1
+    /// Compile a single function for AVX2, callers must check HasAvx2
+    #define MOON_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+    #define MOON_X86 0
+    #define MOON_TARGET_AVX2
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Whether AVX2 kernels can run on this CPU
+///
+/// Uses the FFmpeg CPU detection, so that AV_CPU_FLAGS or a forced mask
+/// applies to our kernels too.
+///
+/// \return True if AVX2 and FMA are available
+///
+///////////////////////////////////////////////////////////////////////////////
+bool HasAvx2(void);
+
+} // namespace Moon
@@ -0,0 +1,71 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/ParallelFor.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Indices of one call, shared with the helper tasks
+///
+///////////////////////////////////////////////////////////////////////////////
+struct ParallelJob
+{
+    Function<void(Uint32)> body;
+    Uint32 count = 0;
+    Atomic<Uint32> next{0};
+    Mutex mutex;
+    ConditionVariable doneCV;
+    Uint32 done = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+static void RunIndices(ParallelJob& job)
+{
+    for (Uint32 index = job.next++; index < job.count; index = job.next++) {
+        job.body(index);
+
+        std::unique_lock<Mutex> lock(job.mutex);
+        if (++job.done == job.count) {
+            job.doneCV.notify_all();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ParallelFor(
+    Uint32 count,
+    const Function<void(Uint32)>& body,
+    TaskScheduler::Priority priority
+)
+{
+    if (count <= 1) {
+        for (Uint32 index = 0; index < count; index++) {
+            body(index);
+        }
+        return;
+    }
+
+    auto job = std::make_shared<ParallelJob>();
+    TaskScheduler& scheduler = TaskScheduler::GetInstance();
+    size_t helpers = std::min<size_t>(count - 1, scheduler.GetLimit(priority));
+
+    job->body = body;
+    job->count = count;
+
+    // Helpers starting after the last index was claimed just return
+    for (size_t i = 0; i < helpers; i++) {
+        scheduler.Submit(priority, [job]{ RunIndices(*job); });
+    }
+
+    RunIndices(*job);
+
+    std::unique_lock<Mutex> lock(job->mutex);
+    job->doneCV.wait(lock, [&]{ return (job->done == job->count); });
+}
+
+} // namespace Moon
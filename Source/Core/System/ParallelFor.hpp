@@ -0,0 +1,38 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Run a body over a range of indices, on the calling thread and
+///        on scheduler tasks
+///
+/// Indices are claimed one at a time from a shared counter. The caller
+/// waits only for the indices being worked on, never for a queued task,
+/// so it is safe from a scheduler worker and finishes alone if every
+/// worker is busy.
+///
+/// \param count Number of indices, the body sees 0 to count - 1
+/// \param body Work of one index, called concurrently
+/// \param priority Class of the helper tasks
+///
+///////////////////////////////////////////////////////////////////////////////
+void ParallelFor(
+    Uint32 count,
+    const Function<void(Uint32)>& body,
+    TaskScheduler::Priority priority = TaskScheduler::Priority::RealTime
+);
+
+} // namespace Moon
@@ -0,0 +1,40 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/Priority.hpp"
+#if defined(__linux__)
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+#if defined(__linux__)
+///////////////////////////////////////////////////////////////////////////////
+static constexpr int BACKGROUND_NICE = 10;
+static constexpr int IOPRIO_CLASS_IDLE = 3;
+static constexpr int IOPRIO_CLASS_SHIFT = 13;
+static constexpr int IOPRIO_WHO_PROCESS = 1;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+void SetBackgroundPriority(void)
+{
+#if defined(__linux__)
+    // On Linux both the nice value and the I/O priority are per thread
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+
+    setpriority(PRIO_PROCESS, static_cast<id_t>(tid), BACKGROUND_NICE);
+    syscall(
+        SYS_ioprio_set, IOPRIO_WHO_PROCESS, tid,
+        IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT
+    );
+#endif
+}
+
+} // namespace Moon
@@ -0,0 +1,27 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Lower the CPU and I/O priority of the calling thread
+///
+/// Used by background work (thumbnails, indexing, analysis) so it only runs
+/// on otherwise idle resources and never delays playback. This is a no-op
+/// on platforms without per-thread priorities.
+///
+///////////////////////////////////////////////////////////////////////////////
+void SetBackgroundPriority(void);
+
+} // namespace Moon
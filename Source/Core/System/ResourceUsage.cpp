@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/ResourceUsage.hpp"
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+    #include <unistd.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 GetPeakMemory(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return (0);
+    }
+    #if defined(__APPLE__)
+        return (static_cast<Uint64>(usage.ru_maxrss));
+    #else
+        // Linux reports kilobytes
+        return (static_cast<Uint64>(usage.ru_maxrss) * 1024);
+    #endif
+#else
+    return (0);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Uint64 GetCurrentMemory(void)
+{
+#if defined(__linux__)
+    // Second field of statm is the resident set, in pages
+    IfStream statm("/proc/self/statm");
+    Uint64 size = 0;
+    Uint64 resident = 0;
+
+    if (!(statm >> size >> resident)) {
+        return (0);
+    }
+    return (resident * static_cast<Uint64>(sysconf(_SC_PAGESIZE)));
+#else
+    return (0);
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+double GetCpuTime(void)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return (0.0);
+    }
+    return (
+        usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+        usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6
+    );
+#else
+    return (0.0);
+#endif
+}
+
+} // namespace Moon
@@ -0,0 +1,41 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Peak resident memory of the process
+///
+/// \return Size in bytes, 0 when the platform does not report it
+///
+///////////////////////////////////////////////////////////////////////////////
+Uint64 GetPeakMemory(void);
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Current resident memory of the process
+///
+/// \return Size in bytes, 0 when the platform does not report it
+///
+///////////////////////////////////////////////////////////////////////////////
+Uint64 GetCurrentMemory(void);
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief CPU time consumed by the process, user and system combined
+///
+/// \return Time in seconds, 0 when the platform does not report it
+///
+///////////////////////////////////////////////////////////////////////////////
+double GetCpuTime(void);
+
+} // namespace Moon
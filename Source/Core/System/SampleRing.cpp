@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/SampleRing.hpp"
+#include <bit>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+SampleRing::SampleRing(size_t capacity)
+    : mData(std::bit_ceil(std::max<size_t>(capacity, 2)))
+    , mMask(mData.size() - 1)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SampleRing::Write(const float* samples, size_t count)
+{
+    size_t write = mWrite.load(std::memory_order_relaxed);
+    size_t read = mRead.load(std::memory_order_acquire);
+
+    count = std::min(count, mData.size() - (write - read));
+
+    for (size_t i = 0; i < count; i++) {
+        mData[(write + i) & mMask] = samples[i];
+    }
+
+    mWrite.store(write + count, std::memory_order_release);
+    return (count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SampleRing::Read(float* samples, size_t count)
+{
+    size_t read = mRead.load(std::memory_order_relaxed);
+    size_t write = mWrite.load(std::memory_order_acquire);
+
+    count = std::min(count, write - read);
+
+    for (size_t i = 0; i < count; i++) {
+        samples[i] = mData[(read + i) & mMask];
+    }
+
+    mRead.store(read + count, std::memory_order_release);
+    return (count);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t SampleRing::GetAvailable(void) const
+{
+    return (mWrite.load(std::memory_order_acquire) -
+        mRead.load(std::memory_order_acquire));
+}
+
+} // namespace Moon
@@ -0,0 +1,70 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Lock free ring of float samples, one writer and one reader
+///
+/// The writer never waits: samples that do not fit are dropped, so it can
+/// sit in an audio callback. The capacity is rounded up to a power of two
+/// and the positions only ever grow, wrapping through a mask.
+///
+///////////////////////////////////////////////////////////////////////////////
+class SampleRing
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Vector<float> mData;
+    size_t mMask;
+    alignas(64) Atomic<size_t> mWrite{0};
+    alignas(64) Atomic<size_t> mRead{0};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param capacity Minimum number of samples held
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit SampleRing(size_t capacity);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Append samples, from the writer thread only
+    ///
+    /// \return Samples written, the rest was dropped
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t Write(const float* samples, size_t count);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take the oldest samples, from the reader thread only
+    ///
+    /// \return Samples read
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t Read(float* samples, size_t count);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return Samples waiting to be read
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetAvailable(void) const;
+};
+
+} // namespace Moon
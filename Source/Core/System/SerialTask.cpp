@@ -0,0 +1,74 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/SerialTask.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+SerialTask::SerialTask(TaskScheduler::Priority priority, Function<void()> body)
+    : mPriority(priority)
+    , mBody(std::move(body))
+    , mScheduled(false)
+    , mWoken(false)
+    , mStopped(false)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+SerialTask::~SerialTask()
+{
+    Stop();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialTask::Run(void)
+{
+    while (true) {
+        {
+            std::unique_lock<Mutex> lock(mMutex);
+            if (!mWoken || mStopped) {
+                mScheduled = false;
+                mIdleCV.notify_all();
+                return;
+            }
+            mWoken = false;
+        }
+
+        mBody();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialTask::Wake(void)
+{
+    {
+        std::unique_lock<Mutex> lock(mMutex);
+        if (mStopped) {
+            return;
+        }
+
+        mWoken = true;
+
+        // A run in progress picks the wake up when its body returns
+        if (mScheduled) {
+            return;
+        }
+        mScheduled = true;
+    }
+
+    TaskScheduler::GetInstance().Submit(mPriority, [this]{ Run(); });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void SerialTask::Stop(void)
+{
+    std::unique_lock<Mutex> lock(mMutex);
+    mStopped = true;
+    mIdleCV.wait(lock, [this]{ return (!mScheduled); });
+}
+
+} // namespace Moon
@@ -0,0 +1,87 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Function run on the TaskScheduler whenever it is woken
+///
+/// Replaces a dedicated thread waiting on a condition variable: the body
+/// does whatever work is pending and returns instead of waiting. Runs never
+/// overlap, and waking it during a run schedules another one, so no wake up
+/// is lost.
+///
+///////////////////////////////////////////////////////////////////////////////
+class SerialTask
+{
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    TaskScheduler::Priority mPriority;
+    Function<void()> mBody;
+
+    Mutex mMutex;
+    ConditionVariable mIdleCV;
+    bool mScheduled;
+    bool mWoken;
+    bool mStopped;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param priority Priority class of the runs
+    /// \param body Function doing the pending work
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    SerialTask(TaskScheduler::Priority priority, Function<void()> body);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Stop and wait for the current run
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~SerialTask();
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    SerialTask(const SerialTask&) = delete;
+    SerialTask& operator=(const SerialTask&) = delete;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Task submitted to the scheduler
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Run(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Run the body again soon
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Wake(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Ignore further wake ups and wait for the current run
+    ///
+    /// Must be called before anything used by the body is destroyed.
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Stop(void);
+};
+
+} // namespace Moon
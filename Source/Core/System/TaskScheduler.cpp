@@ -0,0 +1,252 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/System/TaskScheduler.hpp"
+#include "Core/System/Priority.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static thread_local size_t sWorkerIndex = SIZE_MAX;
+
+///////////////////////////////////////////////////////////////////////////////
+TaskScheduler::TaskScheduler(void)
+    : mVersion(0)
+    , mStop(false)
+{
+    size_t cores = std::max<size_t>(1, Thread::hardware_concurrency());
+    size_t backgroundCount = std::max<size_t>(1, cores / 2);
+
+    mForegroundCount = std::max(MIN_WORKERS, cores);
+
+    for (size_t i = 0; i < PRIORITY_COUNT; i++) {
+        mRunning[i] = 0;
+    }
+
+    // One foreground worker is kept for real time tasks
+    mLimits[static_cast<size_t>(Priority::RealTime)] = mForegroundCount;
+    mLimits[static_cast<size_t>(Priority::Interactive)] = mForegroundCount - 1;
+    mLimits[static_cast<size_t>(Priority::Background)] = backgroundCount;
+
+    for (size_t i = 0; i < mForegroundCount + backgroundCount; i++) {
+        mWorkers.push_back(std::make_unique<Worker>());
+        mWorkers.back()->background = i >= mForegroundCount;
+    }
+
+    // Started once every worker exists, since they steal from each other
+    for (size_t i = 0; i < mWorkers.size(); i++) {
+        mWorkers[i]->thread = Thread(&TaskScheduler::Work, this, i);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TaskScheduler::~TaskScheduler()
+{
+    {
+        std::unique_lock<Mutex> lock(mSleepMutex);
+        mStop = true;
+    }
+    NotifyAll();
+
+    for (auto& worker : mWorkers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+TaskScheduler& TaskScheduler::GetInstance(void)
+{
+    static TaskScheduler instance;
+
+    return (instance);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::Work(size_t index)
+{
+    sWorkerIndex = index;
+
+    if (mWorkers[index]->background) {
+        SetBackgroundPriority();
+    }
+
+    while (true) {
+        Uint64 version = 0;
+
+        {
+            std::unique_lock<Mutex> lock(mSleepMutex);
+            if (mStop) {
+                break;
+            }
+            version = mVersion;
+        }
+
+        if (RunOne(index)) {
+            continue;
+        }
+
+        // Anything submitted or finished since the scan bumps the version
+        std::unique_lock<Mutex> lock(mSleepMutex);
+        mSleepCV[mWorkers[index]->background].wait(lock, [this, version]{
+            return (mStop || mVersion != version);
+        });
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TaskScheduler::RunOne(size_t index)
+{
+    Worker& self = *mWorkers[index];
+    size_t background = static_cast<size_t>(Priority::Background);
+
+    for (size_t priority = 0; priority < PRIORITY_COUNT; priority++) {
+        if ((priority == background) != self.background) {
+            continue;
+        }
+
+        // Reserve a slot of the class before looking for one of its tasks
+        size_t running = mRunning[priority];
+        bool reserved = false;
+
+        while (running < mLimits[priority] && !reserved) {
+            reserved = mRunning[priority].compare_exchange_weak(
+                running, running + 1);
+        }
+
+        if (!reserved) {
+            continue;
+        }
+
+        Task task;
+        bool found = Pop(self, priority, true, task);
+
+        for (size_t i = 1; !found && i < mWorkers.size(); i++) {
+            Worker& victim = *mWorkers[(index + i) % mWorkers.size()];
+
+            if (victim.background == self.background) {
+                found = Pop(victim, priority, false, task);
+            }
+        }
+
+        if (!found) {
+            mRunning[priority]--;
+            continue;
+        }
+
+        task();
+
+        // The slot freed may let a task of the same class start, this
+        // worker scans again right away so no other needs waking
+        mRunning[priority]--;
+        return (true);
+    }
+
+    return (false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool TaskScheduler::Pop(Worker& worker, size_t priority, bool owner, Task& task)
+{
+    std::unique_lock<Mutex> lock(worker.mutex);
+    std::deque<Task>& queue = worker.queues[priority];
+
+    if (queue.empty()) {
+        return (false);
+    }
+
+    // The owner takes its most recent task, likely still hot in cache,
+    // thieves take the oldest one
+    if (owner) {
+        task = std::move(queue.back());
+        queue.pop_back();
+    } else {
+        task = std::move(queue.front());
+        queue.pop_front();
+    }
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::Notify(bool background)
+{
+    {
+        std::unique_lock<Mutex> lock(mSleepMutex);
+        mVersion++;
+    }
+
+    // One task, one worker: the others keep sleeping. A worker that is not
+    // waiting scans the deques again before it does
+    mSleepCV[background].notify_one();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::NotifyAll(void)
+{
+    {
+        std::unique_lock<Mutex> lock(mSleepMutex);
+        mVersion++;
+    }
+
+    for (ConditionVariable& sleep : mSleepCV) {
+        sleep.notify_all();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+std::future<void> TaskScheduler::Submit(Priority priority, Task task)
+{
+    auto packaged = std::make_shared<std::packaged_task<void()>>(
+        std::move(task));
+    std::future<void> future = packaged->get_future();
+    bool background = priority == Priority::Background;
+    size_t index = sWorkerIndex;
+
+    // Tasks spawned by a worker stay on its deque, others are spread
+    if (index >= mWorkers.size() || mWorkers[index]->background != background) {
+        size_t first = background ? mForegroundCount : 0;
+        size_t count = background
+            ? mWorkers.size() - mForegroundCount : mForegroundCount;
+
+        index = first + mNextWorker++ % count;
+    }
+
+    {
+        std::unique_lock<Mutex> lock(mWorkers[index]->mutex);
+        mWorkers[index]->queues[static_cast<size_t>(priority)].push_back(
+            [packaged]{ (*packaged)(); });
+    }
+    Notify(background);
+
+    return (future);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::SetLimit(Priority priority, size_t limit)
+{
+    mLimits[static_cast<size_t>(priority)] =
+        std::clamp<size_t>(limit, 1, GetWorkerCount(priority));
+    NotifyAll();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TaskScheduler::GetLimit(Priority priority) const
+{
+    return (mLimits[static_cast<size_t>(priority)]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+size_t TaskScheduler::GetWorkerCount(Priority priority) const
+{
+    if (priority == Priority::Background) {
+        return (mWorkers.size() - mForegroundCount);
+    }
+    return (mForegroundCount);
+}
+
+} // namespace Moon
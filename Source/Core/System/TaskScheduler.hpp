@@ -0,0 +1,189 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include <deque>
+#include <future>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Process wide work-stealing thread pool
+///
+/// Every worker owns a deque per priority: it pops its own tasks last in
+/// first out and steals the oldest task of another worker when idle.
+/// Background tasks run on a separate set of workers with a lowered CPU and
+/// I/O priority, and each class has a concurrency limit; interactive tasks
+/// always leave one worker free, so playback is never starved.
+///
+///////////////////////////////////////////////////////////////////////////////
+class TaskScheduler
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Priority classes, in decreasing order
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Priority
+    {
+        RealTime,       ///< Playback, decoding frames about to be shown
+        Interactive,    ///< Work the user is waiting for
+        Background      ///< Indexing, thumbnails, batch processing
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    using Task = Function<void()>;
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t PRIORITY_COUNT = 3;
+    static constexpr size_t MIN_WORKERS = 2;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    struct Worker
+    {
+        bool background;
+        Mutex mutex;
+        std::deque<Task> queues[PRIORITY_COUNT];
+        Thread thread;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Vector<UniquePtr<Worker>> mWorkers;
+    size_t mForegroundCount;
+    Atomic<size_t> mNextWorker{0};
+    Atomic<size_t> mLimits[PRIORITY_COUNT];
+    Atomic<size_t> mRunning[PRIORITY_COUNT];
+
+    Mutex mSleepMutex;
+    ConditionVariable mSleepCV[2];      ///< Foreground and background workers
+    Uint64 mVersion;
+    bool mStop;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Start the workers
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    TaskScheduler(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Stop the workers, pending tasks are dropped
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~TaskScheduler();
+
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Worker thread body
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(size_t index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Run one task available to a worker
+    ///
+    /// \return False if there was none
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool RunOne(size_t index);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Take a task of a priority from a worker
+    ///
+    /// \param owner True to pop from the back, false to steal the front
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Pop(Worker& worker, size_t priority, bool owner, Task& task);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Wake a worker after a task became runnable
+    ///
+    /// \param background True if the task is for the background workers
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Notify(bool background);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Wake every worker
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void NotifyAll(void);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \return The scheduler shared by the whole process
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static TaskScheduler& GetInstance(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Queue a task
+    ///
+    /// \param priority Priority class of the task
+    /// \param task Function to run
+    ///
+    /// \return Future ready once the task ran
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    std::future<void> Submit(Priority priority, Task task);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Set how many tasks of a class may run at once
+    ///
+    /// \param priority Priority class
+    /// \param limit Maximum number of running tasks, at least 1, capped to
+    ///              the number of workers serving the class
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void SetLimit(Priority priority, size_t limit);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param priority Priority class
+    ///
+    /// \return Maximum number of running tasks of the class
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetLimit(Priority priority) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param priority Priority class
+    ///
+    /// \return Number of workers able to run tasks of the class
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    size_t GetWorkerCount(Priority priority) const;
+};
+
+} // namespace Moon
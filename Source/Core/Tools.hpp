@@ -0,0 +1,11 @@
+///////////////////////////////////////////////////////////////////////////////
+/// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Tools/Benchmark.hpp"
+#include "Core/Tools/ContactSheet.hpp"
+#include "Core/Tools/QualityMetrics.hpp"
@@ -0,0 +1,408 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Tools/Benchmark.hpp"
+#include "Core/Player/TimeStretch.hpp"
+#include "Core/Player/FilterGraph.hpp"
+#include "Core/Player/ColorLut.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+static constexpr size_t BLOCK_FRAMES = 4096;
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Harmonic tones over noise, close enough to music for the search
+///        to do its usual amount of work
+///
+///////////////////////////////////////////////////////////////////////////////
+static Vector<float> MakeSignal(size_t frames, size_t channels, int rate)
+{
+    Vector<float> signal(frames * channels);
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> noise(-0.05f, 0.05f);
+
+    for (size_t i = 0; i < frames; i++) {
+        double time = static_cast<double>(i) / rate;
+        double pitch = 220.0 * (1.0 + 0.5 * std::sin(time));
+        float tone = static_cast<float>(
+            0.4 * std::sin(2.0 * M_PI * pitch * time) +
+            0.2 * std::sin(4.0 * M_PI * pitch * time));
+
+        for (size_t c = 0; c < channels; c++) {
+            signal[i * channels + c] = tone + noise(random);
+        }
+    }
+    return (signal);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief .cube text of a film like grade, so every cell of the lattice
+///        holds a different color
+///
+///////////////////////////////////////////////////////////////////////////////
+static String MakeCube(int size)
+{
+    std::ostringstream cube;
+
+    cube << "TITLE \"Benchmark\"\nLUT_3D_SIZE " << size << "\n";
+    for (int b = 0; b < size; b++) {
+        for (int g = 0; g < size; g++) {
+            for (int r = 0; r < size; r++) {
+                double red = static_cast<double>(r) / (size - 1);
+                double green = static_cast<double>(g) / (size - 1);
+                double blue = static_cast<double>(b) / (size - 1);
+                double luma = 0.2126 * red + 0.7152 * green + 0.0722 * blue;
+
+                cube << std::pow(red, 0.9) << ' '
+                    << 0.8 * green + 0.2 * luma << ' '
+                    << std::sqrt(blue) * 0.9 + 0.05 << '\n';
+            }
+        }
+    }
+    return (cube.str());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Benchmark::Benchmark(const Options& options)
+    : mOptions(options)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+void Benchmark::RunTimeStretch(Vector<Result>& results) const
+{
+    static constexpr size_t CHANNELS[] = {1, 2};
+    static constexpr double SPEEDS[] = {0.5, 0.75, 1.25, 1.5, 2.0};
+
+    size_t frames = static_cast<size_t>(mOptions.seconds * SAMPLE_RATE);
+
+    for (size_t channels : CHANNELS) {
+        Vector<float> signal = MakeSignal(frames, channels, SAMPLE_RATE);
+        Vector<float> output(BLOCK_FRAMES * channels);
+
+        for (double speed : SPEEDS) {
+            TimeStretch stretch;
+            size_t offset = 0;
+
+            stretch.Configure(static_cast<int>(channels), SAMPLE_RATE,
+                BLOCK_FRAMES);
+            stretch.SetSpeed(speed);
+
+            auto start = std::chrono::steady_clock::now();
+
+            // Same loop as the audio output: pull blocks, push on demand
+            while (true) {
+                while (stretch.GetOutputFrames() < BLOCK_FRAMES) {
+                    if (stretch.Process()) {
+                        continue;
+                    }
+                    if (offset == frames) {
+                        break;
+                    }
+                    offset += stretch.Push(signal.data() + offset * channels,
+                        std::min(BLOCK_FRAMES, frames - offset));
+                }
+                if (stretch.Pull(output.data(), BLOCK_FRAMES) == 0) {
+                    break;
+                }
+            }
+
+            double seconds = std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+            std::ostringstream setup;
+
+            setup << channels << " ch, " << speed << "x";
+            results.push_back({
+                "time-stretch",
+                setup.str(),
+                seconds * 1e9 / (static_cast<double>(frames) * channels),
+                "ns/sample",
+                seconds > 0.0 ? mOptions.seconds / seconds : 0.0,
+                HasAvx2()
+            });
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Benchmark::RunDeinterlace(Vector<Result>& results) const
+{
+    static constexpr int THREADS[] = {1, 2, 4, 0};
+    static constexpr int PATTERNS = 8;
+
+    Vector<AVFrame*> pictures;
+
+    // Moving bars, with the bottom field half a step behind the top one
+    for (int i = 0; i < PATTERNS; i++) {
+        AVFrame* picture = av_frame_alloc();
+
+        picture->width = FRAME_WIDTH;
+        picture->height = FRAME_HEIGHT;
+        picture->format = AV_PIX_FMT_YUV420P;
+        if (av_frame_get_buffer(picture, 0) < 0) {
+            av_frame_free(&picture);
+            break;
+        }
+        picture->flags |= AV_FRAME_FLAG_INTERLACED |
+            AV_FRAME_FLAG_TOP_FIELD_FIRST;
+
+        for (int y = 0; y < FRAME_HEIGHT; y++) {
+            Uint8* row = picture->data[0] + y * picture->linesize[0];
+            int shift = i * 16 + (y % 2) * 8;
+
+            for (int x = 0; x < FRAME_WIDTH; x++) {
+                row[x] = static_cast<Uint8>(((x + shift) / 32) % 2 ? 200 : 40);
+            }
+        }
+        for (int plane = 1; plane < 3; plane++) {
+            std::memset(picture->data[plane], 128,
+                picture->linesize[plane] * FRAME_HEIGHT / 2);
+        }
+        pictures.push_back(picture);
+    }
+
+    Int64 count = static_cast<Int64>(mOptions.seconds * FIELD_RATE / 2);
+    AVFrame* output = av_frame_alloc();
+
+    for (int threads : THREADS) {
+        if (pictures.size() < PATTERNS || !output) {
+            std::cerr << "Could not allocate benchmark pictures" << std::endl;
+            break;
+        }
+
+        FilterGraph graph;
+        Uint64 fields = 0;
+
+        graph.SetDeinterlace(FilterGraph::Deinterlace::On);
+        graph.SetThreads(threads);
+        graph.SetTimeBase({2, FIELD_RATE});
+        graph.SetFrameRate({FIELD_RATE, 2});
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (Int64 i = 0; i <= count; i++) {
+            AVFrame* picture = i < count
+                ? av_frame_clone(pictures[i % PATTERNS]) : nullptr;
+
+            if (picture) {
+                picture->pts = i;
+                picture->best_effort_timestamp = i;
+            }
+            if (!graph.Push(picture)) {
+                av_frame_free(&picture);
+                break;
+            }
+            av_frame_free(&picture);
+
+            while (graph.Pull(output)) {
+                av_frame_unref(output);
+                fields++;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        String setup = "1080i" + std::to_string(FIELD_RATE) + ", " +
+            (threads ? std::to_string(threads) + " threads" : "auto");
+
+        results.push_back({
+            "deinterlace",
+            setup,
+            fields ? seconds * 1000.0 / fields : 0.0,
+            "ms/frame",
+            seconds > 0.0 ? fields / (seconds * FIELD_RATE) : 0.0,
+            HasAvx2()
+        });
+    }
+
+    av_frame_free(&output);
+    for (AVFrame*& picture : pictures) {
+        av_frame_free(&picture);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Benchmark::RunColorLut(Vector<Result>& results) const
+{
+    static constexpr int SIZES[] = {17, 33, 65};
+
+    size_t pixelCount = static_cast<size_t>(FRAME_WIDTH) * FRAME_HEIGHT;
+    Vector<Uint8> source(pixelCount * 4);
+    Vector<Uint8> pixels(source.size());
+    std::mt19937 random(42);
+    Int64 count = static_cast<Int64>(mOptions.seconds * FRAME_RATE);
+
+    // Noise defeats the caches as much as real footage would
+    for (size_t i = 0; i < source.size(); i++) {
+        source[i] = static_cast<Uint8>(i % 4 == 3 ? 255 : random());
+    }
+
+    for (int size : SIZES) {
+        std::istringstream cube(MakeCube(size));
+        ColorLut lut;
+
+        if (!lut.LoadFromStream(cube)) {
+            std::cerr << "Could not build the benchmark LUT" << std::endl;
+            break;
+        }
+
+        for (bool parallel : {true, false}) {
+            double seconds = 0.0;
+
+            // The copy restores the input and is not part of the cost
+            for (Int64 i = 0; i < count; i++) {
+                std::memcpy(pixels.data(), source.data(), source.size());
+
+                auto start = std::chrono::steady_clock::now();
+
+                lut.Apply(pixels.data(), FRAME_WIDTH, FRAME_HEIGHT, parallel);
+                seconds += std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count();
+            }
+
+            String setup = "1080p, " + std::to_string(size) + "^3, " +
+                (parallel ? "tiled" : "1 thread");
+
+            results.push_back({
+                "lut",
+                setup,
+                count ? seconds * 1000.0 / count : 0.0,
+                "ms/frame",
+                seconds > 0.0 ? count / (seconds * FRAME_RATE) : 0.0,
+                HasAvx2()
+            });
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Benchmark::RunToneMap(Vector<Result>& results) const
+{
+    struct Setup
+    {
+        AVPixelFormat format;
+        ToneMap::Curve curve;
+        const char* name;
+    };
+
+    static constexpr Setup SETUPS[] = {
+        {AV_PIX_FMT_P010LE, ToneMap::Curve::Bt2390, "p010, BT.2390"},
+        {AV_PIX_FMT_P010LE, ToneMap::Curve::Hable, "p010, Hable"},
+        {AV_PIX_FMT_YUV420P10LE, ToneMap::Curve::Bt2390, "420p10, BT.2390"},
+        {AV_PIX_FMT_P010LE, ToneMap::Curve::Off, "p010, scaler"}
+    };
+
+    Int64 count = static_cast<Int64>(mOptions.seconds * FRAME_RATE);
+    std::mt19937 random(42);
+
+    for (const Setup& setup : SETUPS) {
+        AVFrame* picture = av_frame_alloc();
+
+        if (!picture) {
+            break;
+        }
+
+        picture->width = UHD_WIDTH;
+        picture->height = UHD_HEIGHT;
+        picture->format = setup.format;
+        picture->color_trc = AVCOL_TRC_SMPTE2084;
+        picture->color_primaries = AVCOL_PRI_BT2020;
+        picture->colorspace = AVCOL_SPC_BT2020_NCL;
+        picture->color_range = AVCOL_RANGE_MPEG;
+        if (av_frame_get_buffer(picture, 0) < 0) {
+            std::cerr << "Could not allocate benchmark pictures" << std::endl;
+            av_frame_free(&picture);
+            break;
+        }
+
+        // Limited range noise, shifted to the high bits for P010
+        int shift = setup.format == AV_PIX_FMT_P010LE ? 6 : 0;
+        int planes = setup.format == AV_PIX_FMT_P010LE ? 2 : 3;
+
+        for (int plane = 0; plane < planes; plane++) {
+            int rows = plane ? UHD_HEIGHT / 2 : UHD_HEIGHT;
+
+            for (int y = 0; y < rows; y++) {
+                Uint16* row = reinterpret_cast<Uint16*>(
+                    picture->data[plane] + y * picture->linesize[plane]);
+
+                for (int x = 0; x < picture->linesize[plane] / 2; x++) {
+                    row[x] = static_cast<Uint16>((64 + random() % 877) << shift);
+                }
+            }
+        }
+
+        FrameConverter converter;
+        auto start = std::chrono::steady_clock::now();
+
+        converter.SetToneMapping(setup.curve);
+        for (Int64 i = 0; i < count; i++) {
+            converter.Convert(picture, i, static_cast<double>(i) / FRAME_RATE);
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        results.push_back({
+            "tone-map",
+            String("2160p ") + setup.name,
+            count ? seconds * 1000.0 / count : 0.0,
+            "ms/frame",
+            seconds > 0.0 ? count / (seconds * FRAME_RATE) : 0.0,
+            HasAvx2()
+        });
+        av_frame_free(&picture);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Vector<Benchmark::Result> Benchmark::Run(void) const
+{
+    Vector<Result> results;
+
+    if (mOptions.suite.empty() || mOptions.suite == "time-stretch") {
+        RunTimeStretch(results);
+    }
+    if (mOptions.suite.empty() || mOptions.suite == "deinterlace") {
+        RunDeinterlace(results);
+    }
+    if (mOptions.suite.empty() || mOptions.suite == "lut") {
+        RunColorLut(results);
+    }
+    if (mOptions.suite.empty() || mOptions.suite == "tone-map") {
+        RunToneMap(results);
+    }
+    return (results);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void Benchmark::Print(std::ostream& output, const Vector<Result>& results)
+{
+    output << std::left << std::setw(16) << "suite" << std::setw(24)
+        << "setup" << std::right << std::setw(14) << "cost"
+        << std::setw(11) << "unit" << std::setw(14) << "real time"
+        << std::endl;
+
+    for (const Result& result : results) {
+        output << std::left << std::setw(16) << result.suite
+            << std::setw(24) << result.setup << std::right << std::fixed
+            << std::setprecision(2) << std::setw(14) << result.cost
+            << std::setw(11) << result.unit << std::setw(13)
+            << std::setprecision(0) << result.realTime << "x"
+            << (result.avx2 ? "  AVX2" : "") << std::endl;
+    }
+}
+
+} // namespace Moon
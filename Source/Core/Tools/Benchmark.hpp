@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Headless timing of the processing stages on synthetic data
+///
+/// Each suite feeds a stage the same generated input for every setup and
+/// reports the time per unit of work, so runs on different machines or
+/// builds compare directly. Nothing is read from disk.
+///
+///////////////////////////////////////////////////////////////////////////////
+class Benchmark
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr int SAMPLE_RATE = 48000;
+    static constexpr int FIELD_RATE = 50;
+    static constexpr int FRAME_WIDTH = 1920;
+    static constexpr int FRAME_HEIGHT = 1080;
+    static constexpr int FRAME_RATE = 25;
+    static constexpr int UHD_WIDTH = 3840;
+    static constexpr int UHD_HEIGHT = 2160;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Run settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Options
+    {
+        String suite;                   ///< Suite to run, empty for all
+        double seconds = 10.0;          ///< Media duration per setup
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Measure of one setup
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Result
+    {
+        String suite;                   ///< Stage measured
+        String setup;                   ///< Parameters of the run
+        double cost;                    ///< Time per unit of work
+        String unit;                    ///< Unit of the cost
+        double realTime;                ///< Media seconds per second, 0 for
+                                        ///< stages without a media time
+        bool avx2;                      ///< Whether AVX2 kernels ran
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Options mOptions;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param options Run settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    explicit Benchmark(const Options& options);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief WSOLA time stretch, per channel at SAMPLE_RATE
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void RunTimeStretch(Vector<Result>& results) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief bwdif deinterlacing of 1080i to one frame per field, over
+    ///        several slice thread counts
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void RunDeinterlace(Vector<Result>& results) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief 3D LUT grading of 1080p RGBA frames on the CPU, for several
+    ///        lattice sizes, tiled over the scheduler and on one thread
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void RunColorLut(Vector<Result>& results) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Conversion of 2160p PQ pictures to RGBA, tone mapped and
+    ///        through the scaler alone
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void RunToneMap(Vector<Result>& results) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Run the selected suites
+    ///
+    /// \return One result per setup, empty if no suite matched
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Vector<Result> Run(void) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Print results as an aligned table
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    static void Print(std::ostream& output, const Vector<Result>& results);
+};
+
+} // namespace Moon
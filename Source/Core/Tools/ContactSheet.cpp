@@ -0,0 +1,196 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Tools/ContactSheet.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/Player/FrameConverter.hpp"
+#include "Core/System/ResourceUsage.hpp"
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+ContactSheet::ContactSheet(const Vector<Path>& files, const Options& options)
+    : mOptions(options)
+{
+    mOptions.count = std::max<Uint32>(1, mOptions.count);
+    mOptions.columns = std::clamp<Uint32>(mOptions.columns, 1, mOptions.count);
+    mOptions.width = std::max<Uint32>(16, mOptions.width & ~1U);
+
+    Set<String> names;
+
+    for (const Path& file : files) {
+        auto sheet = std::make_unique<Sheet>();
+        String stem = file.stem().string();
+        String name = stem + "_sheet";
+
+        // Files of the same name in different folders get a counter
+        for (Uint32 copy = 2; !names.insert(name).second; copy++) {
+            name = stem + "_" + std::to_string(copy) + "_sheet";
+        }
+
+        sheet->filePath = file;
+        sheet->output = mOptions.output / (name + "." + mOptions.format);
+        sheet->pending = mOptions.count;
+        mSheets.push_back(std::move(sheet));
+
+        for (Uint32 first = 0; first < mOptions.count; first += POINTS_PER_TASK) {
+            mTasks.push_back({
+                mSheets.size() - 1, first,
+                std::min(first + POINTS_PER_TASK, mOptions.count)
+            });
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ContactSheet::Work(void)
+{
+    while (true) {
+        size_t index = mNextTask.fetch_add(1);
+
+        if (index >= mTasks.size()) {
+            break;
+        }
+        RunTask(mTasks[index]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ContactSheet::RunTask(const Task& task)
+{
+    Sheet& sheet = *mSheets[task.sheet];
+    Decoder decoder;
+    Decoder::Options options;
+
+    // Files are decoded in parallel already, one codec thread each is enough
+    options.threads = 1;
+    options.minWidth = static_cast<int>(mOptions.width);
+    options.keyframesOnly = true;
+
+    if (!decoder.Open(sheet.filePath, options) ||
+        decoder.GetWidth() <= 0 || decoder.GetHeight() <= 0
+    ) {
+        {
+            std::unique_lock<Mutex> lock(sheet.mutex);
+            sheet.failed = true;
+        }
+        Complete(sheet, task.last - task.first);
+        return;
+    }
+
+    Uint32 width = mOptions.width;
+    Uint32 height = std::max<Uint32>(2, static_cast<Uint32>(
+        static_cast<Uint64>(width) * decoder.GetHeight() / decoder.GetWidth()
+    ) & ~1U);
+    Uint32 rows = (mOptions.count + mOptions.columns - 1) / mOptions.columns;
+
+    {
+        std::unique_lock<Mutex> lock(sheet.mutex);
+        if (sheet.tileHeight == 0) {
+            sheet.tileHeight = height;
+            sheet.image.resize({
+                mOptions.columns * (width + SPACING) + SPACING,
+                rows * (height + SPACING) + SPACING
+            });
+        }
+    }
+
+    FrameConverter converter(SWS_FAST_BILINEAR, mOptions.priority);
+    AVFrame* frame = av_frame_alloc();
+    double duration = decoder.GetDuration();
+
+    for (Uint32 point = task.first; point < task.last && frame; point++) {
+        double seconds = duration * (point + 0.5) / mOptions.count;
+        SharedPtr<VideoFrame> thumbnail = nullptr;
+
+        if (!decoder.Seek(seconds)) {
+            continue;
+        }
+
+        while (!thumbnail && decoder.Decode(frame) == Decoder::Status::Frame) {
+            Int64 pts = Decoder::GetFramePts(frame);
+
+            thumbnail = converter.Convert(
+                frame, pts, decoder.ToSeconds(pts), width, height);
+            av_frame_unref(frame);
+        }
+
+        if (!thumbnail) {
+            continue;
+        }
+
+        sf::Image tile({thumbnail->width, thumbnail->height}, thumbnail->data);
+        sf::Vector2u position(
+            SPACING + (point % mOptions.columns) * (width + SPACING),
+            SPACING + (point / mOptions.columns) * (height + SPACING)
+        );
+
+        std::unique_lock<Mutex> lock(sheet.mutex);
+        if (!sheet.image.copy(tile, position)) {
+            std::cerr << "Could not place thumbnail " << point << " of "
+                << sheet.filePath << std::endl;
+        }
+    }
+
+    av_frame_free(&frame);
+    Complete(sheet, task.last - task.first);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void ContactSheet::Complete(Sheet& sheet, Uint32 points)
+{
+    if (sheet.pending.fetch_sub(points) != points) {
+        return;
+    }
+
+    std::unique_lock<Mutex> lock(sheet.mutex);
+
+    if (sheet.failed || sheet.tileHeight == 0) {
+        std::cerr << "Could not open " << sheet.filePath << std::endl;
+        mFailed++;
+    } else {
+        if (sheet.image.saveToFile(sheet.output)) {
+            mWritten++;
+        } else {
+            std::cerr << "Could not write " << sheet.output << std::endl;
+            mFailed++;
+        }
+    }
+
+    // Release the pixels right away, only sheets in progress stay in memory
+    sheet.image = sf::Image();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ContactSheet::Report ContactSheet::Run(void)
+{
+    auto start = std::chrono::steady_clock::now();
+    TaskScheduler& scheduler = TaskScheduler::GetInstance();
+    size_t count = mOptions.threads;
+
+    if (count == 0) {
+        count = scheduler.GetLimit(mOptions.priority);
+    }
+    count = std::min(count, std::max<size_t>(1, mTasks.size()));
+
+    Vector<std::future<void>> workers;
+
+    for (size_t i = 0; i < count; i++) {
+        workers.push_back(scheduler.Submit(
+            mOptions.priority, [this]{ Work(); }));
+    }
+    for (auto& worker : workers) {
+        worker.wait();
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    return (Report{mWritten, mFailed, elapsed.count(), GetPeakMemory()});
+}
+
+} // namespace Moon
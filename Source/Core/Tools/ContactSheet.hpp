@@ -0,0 +1,145 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/System/TaskScheduler.hpp"
+#include <SFML/Graphics/Image.hpp>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Headless generator of tiled preview sheets
+///
+/// Each file gets a grid of evenly spaced keyframe thumbnails saved as one
+/// image next to the others in the output directory, named after the file
+/// with a counter when two files share a name. The seek points of
+/// every file are split into small tasks shared by scheduler workers,
+/// so a few long files and many short ones keep every core busy alike.
+///
+///////////////////////////////////////////////////////////////////////////////
+class ContactSheet
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr Uint32 POINTS_PER_TASK = 4;
+    static constexpr Uint32 SPACING = 4;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Layout and output settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Options
+    {
+        Uint32 count = 16;          ///< Thumbnails per file
+        Uint32 columns = 4;         ///< Thumbnails per row
+        Uint32 width = 320;         ///< Width of a thumbnail in pixels
+        String format = "jpg";      ///< Extension of the output images
+        Path output = ".";          ///< Output directory
+        Uint32 threads = 0;         ///< Concurrent workers, 0 for the limit
+                                    ///< of the priority class
+        TaskScheduler::Priority priority =
+            TaskScheduler::Priority::Background;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Summary of a run
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Report
+    {
+        size_t files;               ///< Sheets written
+        size_t failed;              ///< Files that could not be processed
+        double seconds;             ///< Wall clock duration
+        Uint64 peakMemory;          ///< Peak resident memory in bytes
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Sheet of a file, filled concurrently by its tasks
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Sheet
+    {
+        Path filePath;
+        Path output;
+        Mutex mutex;
+        sf::Image image;
+        Uint32 tileHeight = 0;
+        Atomic<Uint32> pending{0};
+        bool failed = false;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Range of seek points [first, last) of a sheet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Task
+    {
+        size_t sheet;
+        Uint32 first;
+        Uint32 last;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Options mOptions;
+    Vector<UniquePtr<Sheet>> mSheets;
+    Vector<Task> mTasks;
+    Atomic<size_t> mNextTask{0};
+    Atomic<size_t> mWritten{0};
+    Atomic<size_t> mFailed{0};
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param files Media files to process
+    /// \param options Layout and output settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ContactSheet(const Vector<Path>& files, const Options& options);
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Worker body, runs tasks until none is left
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Work(void);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode the thumbnails of a task into its sheet
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void RunTask(const Task& task);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Account for finished seek points, saving the sheet after the
+    ///        last one
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Complete(Sheet& sheet, Uint32 points);
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Generate every sheet, blocking until done
+    ///
+    /// \return Summary of the run
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Report Run(void);
+};
+
+} // namespace Moon
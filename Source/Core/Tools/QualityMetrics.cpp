@@ -0,0 +1,539 @@
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Tools/QualityMetrics.hpp"
+#include "Core/System/CpuFeatures.hpp"
+#include <cmath>
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Sums of a 4x4 block: a, b, a² + b² and a * b
+///
+///////////////////////////////////////////////////////////////////////////////
+using BlockSums = Array<int, 4>;
+
+///////////////////////////////////////////////////////////////////////////////
+static Uint64 SumSquaredErrorScalar(const Uint8* a, const Uint8* b, int width)
+{
+    Uint64 sum = 0;
+
+    for (int x = 0; x < width; x++) {
+        int difference = a[x] - b[x];
+        sum += static_cast<Uint64>(difference * difference);
+    }
+    return (sum);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void SumBlocksScalar(
+    const Uint8* a,
+    int aStride,
+    const Uint8* b,
+    int bStride,
+    int first,
+    int count,
+    BlockSums* sums
+)
+{
+    for (int block = first; block < count; block++) {
+        BlockSums total = {0, 0, 0, 0};
+
+        for (int y = 0; y < 4; y++) {
+            for (int x = block * 4; x < block * 4 + 4; x++) {
+                int pa = a[y * aStride + x];
+                int pb = b[y * bStride + x];
+
+                total[0] += pa;
+                total[1] += pb;
+                total[2] += pa * pa + pb * pb;
+                total[3] += pa * pb;
+            }
+        }
+        sums[block] = total;
+    }
+}
+
+#if MOON_X86
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static Uint64 SumSquaredErrorAvx2(
+    const Uint8* a,
+    const Uint8* b,
+    int width
+)
+{
+    __m256i sum = _mm256_setzero_si256();
+    int x = 0;
+
+    // 16 pixels widened to 16 bits, madd squares and adds pairs in 32 bits
+    for (; x + 16 <= width; x += 16) {
+        __m256i pa = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x)));
+        __m256i pb = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x)));
+        __m256i difference = _mm256_sub_epi16(pa, pb);
+
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(difference, difference));
+    }
+
+    alignas(32) Uint32 lanes[8];
+    Uint64 total = 0;
+
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    for (Uint32 lane : lanes) {
+        total += lane;
+    }
+    return (total + SumSquaredErrorScalar(a + x, b + x, width - x));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+MOON_TARGET_AVX2 static void SumBlocksAvx2(
+    const Uint8* a,
+    int aStride,
+    const Uint8* b,
+    int bStride,
+    int count,
+    BlockSums* sums
+)
+{
+    const __m256i ones = _mm256_set1_epi16(1);
+    int block = 0;
+
+    // Four blocks at a time, rows are accumulated before the horizontal sums
+    for (; block + 4 <= count; block += 4) {
+        __m256i s1 = _mm256_setzero_si256();
+        __m256i s2 = _mm256_setzero_si256();
+        __m256i ss = _mm256_setzero_si256();
+        __m256i s12 = _mm256_setzero_si256();
+
+        for (int y = 0; y < 4; y++) {
+            __m256i pa = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(a + y * aStride + block * 4)));
+            __m256i pb = _mm256_cvtepu8_epi16(_mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(b + y * bStride + block * 4)));
+
+            s1 = _mm256_add_epi16(s1, pa);
+            s2 = _mm256_add_epi16(s2, pb);
+            ss = _mm256_add_epi32(ss, _mm256_add_epi32(
+                _mm256_madd_epi16(pa, pa), _mm256_madd_epi16(pb, pb)));
+            s12 = _mm256_add_epi32(s12, _mm256_madd_epi16(pa, pb));
+        }
+
+        // Each 128 bit lane holds two blocks: [x0, x1, y0, y1]
+        __m256i first = _mm256_hadd_epi32(
+            _mm256_madd_epi16(s1, ones), _mm256_madd_epi16(s2, ones));
+        __m256i second = _mm256_hadd_epi32(ss, s12);
+        alignas(32) int means[8];
+        alignas(32) int products[8];
+
+        _mm256_store_si256(reinterpret_cast<__m256i*>(means), first);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products), second);
+
+        for (int i = 0; i < 4; i++) {
+            int lane = (i / 2) * 4 + i % 2;
+
+            sums[block + i] = {
+                means[lane], means[lane + 2],
+                products[lane], products[lane + 2]
+            };
+        }
+    }
+
+    SumBlocksScalar(a, aStride, b, bStride, block, count, sums);
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetWindowSsim(
+    const BlockSums& a,
+    const BlockSums& b,
+    const BlockSums& c,
+    const BlockSums& d
+)
+{
+    // Constants scaled for sums over the 64 pixels of a window
+    static constexpr double C1 = 0.01 * 0.01 * 255 * 255 * 64;
+    static constexpr double C2 = 0.03 * 0.03 * 255 * 255 * 64 * 63;
+
+    double s1 = a[0] + b[0] + c[0] + d[0];
+    double s2 = a[1] + b[1] + c[1] + d[1];
+    double ss = a[2] + b[2] + c[2] + d[2];
+    double s12 = a[3] + b[3] + c[3] + d[3];
+    double variances = ss * 64 - s1 * s1 - s2 * s2;
+    double covariance = s12 * 64 - s1 * s2;
+
+    return ((2 * s1 * s2 + C1) * (2 * covariance + C2) /
+        ((s1 * s1 + s2 * s2 + C1) * (variances + C2)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static double GetPsnr(Uint64 error, Uint64 samples)
+{
+    if (error == 0 || samples == 0) {
+        return (QualityMetrics::MAX_PSNR);
+    }
+    return (std::min(QualityMetrics::MAX_PSNR, 10.0 * std::log10(
+        255.0 * 255.0 * static_cast<double>(samples) / error)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static String QuoteJson(const String& text)
+{
+    String quoted = "\"";
+
+    for (char character : text) {
+        if (character == '"' || character == '\\') {
+            quoted += '\\';
+        }
+        quoted += character;
+    }
+    return (quoted + "\"");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QualityMetrics::QualityMetrics(
+    const Path& reference,
+    const Path& distorted,
+    const Options& options
+)
+    : mOptions(options)
+    , mWidth(0)
+    , mHeight(0)
+{
+    mInputs[0].filePath = reference;
+    mInputs[1].filePath = distorted;
+
+    for (Input& input : mInputs) {
+        input.frame = av_frame_alloc();
+        input.pictures[0] = av_frame_alloc();
+        input.pictures[1] = av_frame_alloc();
+
+        if (!input.frame || !input.pictures[0] || !input.pictures[1] ||
+            !input.decoder.Open(input.filePath)
+        ) {
+            std::cerr << "Could not open " << input.filePath << std::endl;
+            return;
+        }
+    }
+
+    mWidth = mInputs[0].decoder.GetWidth();
+    mHeight = mInputs[0].decoder.GetHeight();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QualityMetrics::~QualityMetrics()
+{
+    for (Input& input : mInputs) {
+        av_frame_free(&input.frame);
+        av_frame_free(&input.pictures[0]);
+        av_frame_free(&input.pictures[1]);
+        sws_freeContext(input.scaler);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+bool QualityMetrics::Decode(Input& input, int slot)
+{
+    if (input.decoder.Decode(input.frame) != Decoder::Status::Frame) {
+        return (false);
+    }
+
+    AVFrame* frame = input.frame;
+    AVFrame* picture = input.pictures[slot];
+    AVPixelFormat format = static_cast<AVPixelFormat>(frame->format);
+
+    av_frame_unref(picture);
+
+    if ((format == AV_PIX_FMT_YUV420P || format == AV_PIX_FMT_YUVJ420P) &&
+        frame->width == mWidth && frame->height == mHeight
+    ) {
+        av_frame_move_ref(picture, frame);
+        return (true);
+    }
+
+    picture->format = AV_PIX_FMT_YUV420P;
+    picture->width = mWidth;
+    picture->height = mHeight;
+
+    input.scaler = sws_getCachedContext(input.scaler,
+        frame->width, frame->height, format,
+        mWidth, mHeight, AV_PIX_FMT_YUV420P,
+        SWS_BICUBIC, nullptr, nullptr, nullptr);
+
+    if (!input.scaler || av_frame_get_buffer(picture, 0) < 0) {
+        std::cerr << "Could not convert " << input.filePath << std::endl;
+        av_frame_unref(frame);
+        return (false);
+    }
+
+    sws_scale(input.scaler, frame->data, frame->linesize, 0, frame->height,
+        picture->data, picture->linesize);
+    av_frame_copy_props(picture, frame);
+    av_frame_unref(frame);
+
+    return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+Pair<int, int> QualityMetrics::GetPlaneSize(int plane) const
+{
+    if (plane == 0) {
+        return (Pair<int, int>(mWidth, mHeight));
+    }
+    return (Pair<int, int>((mWidth + 1) / 2, (mHeight + 1) / 2));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void QualityMetrics::Measure(
+    const AVFrame* reference,
+    const AVFrame* distorted,
+    Strip& strip
+) const
+{
+    auto [width, height] = GetPlaneSize(strip.plane);
+    const Uint8* a = reference->data[strip.plane];
+    const Uint8* b = distorted->data[strip.plane];
+    int aStride = reference->linesize[strip.plane];
+    int bStride = distorted->linesize[strip.plane];
+    bool avx2 = HasAvx2();
+
+    for (int y = strip.first; y < strip.last; y++) {
+#if MOON_X86
+        if (avx2) {
+            strip.error += SumSquaredErrorAvx2(
+                a + y * aStride, b + y * bStride, width);
+            continue;
+        }
+#endif
+        strip.error += SumSquaredErrorScalar(
+            a + y * aStride, b + y * bStride, width);
+    }
+
+    // Strips start on multiples of 4 rows, each owns the windows whose top
+    // block row it contains and reads one block row past its end
+    int columns = width / 4;
+    int firstWindow = strip.first / 4;
+    int lastWindow = std::min(strip.last / 4, height / 4 - 1);
+
+    if (columns < 2 || firstWindow >= lastWindow) {
+        return;
+    }
+
+    Vector<BlockSums> blocks(
+        static_cast<size_t>(lastWindow - firstWindow + 1) * columns);
+
+    for (int row = firstWindow; row <= lastWindow; row++) {
+        const Uint8* blockA = a + row * 4 * aStride;
+        const Uint8* blockB = b + row * 4 * bStride;
+        BlockSums* sums = &blocks[static_cast<size_t>(row - firstWindow) * columns];
+
+#if MOON_X86
+        if (avx2) {
+            SumBlocksAvx2(blockA, aStride, blockB, bStride, columns, sums);
+            continue;
+        }
+#endif
+        SumBlocksScalar(blockA, aStride, blockB, bStride, 0, columns, sums);
+    }
+
+    for (int row = 0; row < lastWindow - firstWindow; row++) {
+        const BlockSums* top = &blocks[static_cast<size_t>(row) * columns];
+        const BlockSums* bottom = top + columns;
+
+        for (int x = 0; x + 1 < columns; x++) {
+            strip.ssim += GetWindowSsim(
+                top[x], top[x + 1], bottom[x], bottom[x + 1]);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void QualityMetrics::Write(std::ostream& output, const Frame& frame) const
+{
+    char line[512];
+
+    if (mOptions.format == Format::Csv) {
+        std::snprintf(line, sizeof(line),
+            "%llu,%.6f,%.4f,%.4f,%.4f,%.4f,%.6f,%.6f,%.6f,%.6f\n",
+            static_cast<unsigned long long>(frame.index), frame.timestamp,
+            frame.psnr[0], frame.psnr[1], frame.psnr[2], frame.psnrAverage,
+            frame.ssim[0], frame.ssim[1], frame.ssim[2], frame.ssimAverage);
+    } else {
+        std::snprintf(line, sizeof(line),
+            "%s    {\"frame\": %llu, \"time\": %.6f, "
+            "\"psnr_y\": %.4f, \"psnr_u\": %.4f, \"psnr_v\": %.4f, "
+            "\"psnr\": %.4f, \"ssim_y\": %.6f, \"ssim_u\": %.6f, "
+            "\"ssim_v\": %.6f, \"ssim\": %.6f}",
+            frame.index > 0 ? ",\n" : "",
+            static_cast<unsigned long long>(frame.index), frame.timestamp,
+            frame.psnr[0], frame.psnr[1], frame.psnr[2], frame.psnrAverage,
+            frame.ssim[0], frame.ssim[1], frame.ssim[2], frame.ssimAverage);
+    }
+    output << line;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+QualityMetrics::Report QualityMetrics::Run(void)
+{
+    auto start = std::chrono::steady_clock::now();
+    Report report = {0, 0.0, 0.0, 0.0, 0.0, HasAvx2(), false};
+
+    if (mWidth <= 0 || mHeight <= 0) {
+        report.failed = true;
+        return (report);
+    }
+
+    OfStream file;
+    std::ostream* output = &std::cout;
+
+    if (!mOptions.output.empty()) {
+        file.open(mOptions.output);
+        if (!file) {
+            std::cerr << "Could not write " << mOptions.output << std::endl;
+            report.failed = true;
+            return (report);
+        }
+        output = &file;
+    }
+
+    if (mOptions.format == Format::Csv) {
+        *output << "frame,time,psnr_y,psnr_u,psnr_v,psnr,"
+            "ssim_y,ssim_u,ssim_v,ssim\n";
+    } else {
+        *output << "{\n  \"reference\": "
+            << QuoteJson(mInputs[0].filePath.string()) << ",\n"
+            << "  \"distorted\": "
+            << QuoteJson(mInputs[1].filePath.string()) << ",\n"
+            << "  \"frames\": [\n";
+    }
+
+    TaskScheduler& scheduler = TaskScheduler::GetInstance();
+    bool decoded[2] = {false, false};
+    int slot = 0;
+
+    // Decode the next pair into the other slot while measuring this one
+    auto submitDecodes = [&](Vector<std::future<void>>& tasks, int target) {
+        for (int i = 0; i < 2; i++) {
+            tasks.push_back(scheduler.Submit(mOptions.priority,
+                [this, &decoded, i, target]{
+                    decoded[i] = Decode(mInputs[i], target);
+                }
+            ));
+        }
+    };
+
+    {
+        Vector<std::future<void>> tasks;
+
+        submitDecodes(tasks, slot);
+        for (auto& task : tasks) {
+            task.wait();
+        }
+    }
+
+    Uint64 totalError = 0;
+    Uint64 totalSamples = 0;
+    double totalSsim = 0.0;
+
+    while (decoded[0] && decoded[1]) {
+        const AVFrame* reference = mInputs[0].pictures[slot];
+        const AVFrame* distorted = mInputs[1].pictures[slot];
+        Vector<Strip> strips;
+        Vector<std::future<void>> tasks;
+
+        for (int plane = 0; plane < static_cast<int>(PLANE_COUNT); plane++) {
+            int height = GetPlaneSize(plane).second;
+
+            for (int first = 0; first < height; first += STRIP_ROWS) {
+                strips.push_back({plane, first,
+                    std::min(first + STRIP_ROWS, height)});
+            }
+        }
+
+        submitDecodes(tasks, 1 - slot);
+        for (Strip& strip : strips) {
+            tasks.push_back(scheduler.Submit(mOptions.priority,
+                [this, reference, distorted, &strip]{
+                    Measure(reference, distorted, strip);
+                }
+            ));
+        }
+        for (auto& task : tasks) {
+            task.wait();
+        }
+
+        Frame frame = {};
+        Uint64 errors[PLANE_COUNT] = {};
+        double ssims[PLANE_COUNT] = {};
+        Uint64 frameError = 0;
+        Uint64 frameSamples = 0;
+
+        for (const Strip& strip : strips) {
+            errors[strip.plane] += strip.error;
+            ssims[strip.plane] += strip.ssim;
+        }
+
+        for (size_t plane = 0; plane < PLANE_COUNT; plane++) {
+            auto [width, height] = GetPlaneSize(static_cast<int>(plane));
+            Uint64 samples = static_cast<Uint64>(width) * height;
+            Int64 windows = static_cast<Int64>(std::max(0, width / 4 - 1)) *
+                std::max(0, height / 4 - 1);
+
+            frame.psnr[plane] = GetPsnr(errors[plane], samples);
+            frame.ssim[plane] = windows > 0 ? ssims[plane] / windows : 1.0;
+            frame.ssimAverage += frame.ssim[plane] * samples;
+            frameError += errors[plane];
+            frameSamples += samples;
+        }
+
+        frame.index = report.frames;
+        frame.timestamp = mInputs[0].decoder.ToSeconds(
+            Decoder::GetFramePts(reference));
+        frame.psnrAverage = GetPsnr(frameError, frameSamples);
+        frame.ssimAverage /= frameSamples;
+
+        Write(*output, frame);
+
+        totalError += frameError;
+        totalSamples += frameSamples;
+        totalSsim += frame.ssimAverage;
+        report.frames++;
+        slot = 1 - slot;
+    }
+
+    if (decoded[0] != decoded[1]) {
+        std::cerr << "Frame counts differ, stopped after " << report.frames
+            << " frames" << std::endl;
+    }
+
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    report.psnr = GetPsnr(totalError, totalSamples);
+    report.ssim = report.frames > 0 ? totalSsim / report.frames : 0.0;
+    report.seconds = elapsed.count();
+    report.speed = report.seconds > 0.0 ? report.frames *
+        mInputs[0].decoder.GetFrameDuration() / report.seconds : 0.0;
+
+    if (mOptions.format == Format::Json) {
+        char summary[256];
+
+        std::snprintf(summary, sizeof(summary),
+            "\n  ],\n  \"summary\": {\"frames\": %llu, \"psnr\": %.4f, "
+            "\"ssim\": %.6f}\n}\n",
+            static_cast<unsigned long long>(report.frames),
+            report.psnr, report.ssim);
+        *output << summary;
+    }
+
+    output->flush();
+    report.failed = !*output;
+
+    return (report);
+}
+
+} // namespace Moon
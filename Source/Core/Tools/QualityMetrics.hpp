@@ -0,0 +1,193 @@
+///////////////////////////////////////////////////////////////////////////////
+// Header guard
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+///////////////////////////////////////////////////////////////////////////////
+// Dependencies
+///////////////////////////////////////////////////////////////////////////////
+#include "Core/Config/Config.hpp"
+#include "Core/Player/Decoder.hpp"
+#include "Core/System/TaskScheduler.hpp"
+extern "C" {
+    #include <libswscale/swscale.h>
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Namespace Moon
+///////////////////////////////////////////////////////////////////////////////
+namespace Moon
+{
+
+///////////////////////////////////////////////////////////////////////////////
+/// \brief Headless PSNR and SSIM measurement between two encodes
+///
+/// Frames are paired in decode order and compared on the Y, U and V planes
+/// of 8 bit 4:2:0 pictures; other formats and sizes are converted to the
+/// reference first. Each plane is split in strips of rows measured by
+/// scheduler tasks while the next pair of frames is decoded, and the inner
+/// loops use AVX2 when the CPU has it.
+///
+/// SSIM follows the usual 8x8 windows with a stride of 4 pixels, built from
+/// the sums of 4x4 blocks.
+///
+///////////////////////////////////////////////////////////////////////////////
+class QualityMetrics
+{
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    static constexpr size_t PLANE_COUNT = 3;
+    static constexpr int STRIP_ROWS = 64;
+    static constexpr double MAX_PSNR = 100.0;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Output file formats
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    enum class Format
+    {
+        Csv,
+        Json
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Output settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Options
+    {
+        Format format = Format::Csv;    ///< Per frame output format
+        Path output;                    ///< Output file, empty for stdout
+        TaskScheduler::Priority priority =
+            TaskScheduler::Priority::Interactive;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Measures of one pair of frames
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Frame
+    {
+        Uint64 index;                   ///< Position in decode order
+        double timestamp;               ///< Reference timestamp in seconds
+        double psnr[PLANE_COUNT];       ///< PSNR of Y, U and V in dB
+        double psnrAverage;             ///< PSNR of the three planes pooled
+        double ssim[PLANE_COUNT];       ///< SSIM of Y, U and V
+        double ssimAverage;             ///< SSIM weighted by plane size
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Summary of a run
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Report
+    {
+        Uint64 frames;                  ///< Pairs of frames measured
+        double psnr;                    ///< From the error of every frame
+        double ssim;                    ///< Mean of the frame SSIM
+        double seconds;                 ///< Wall clock duration
+        double speed;                   ///< Media seconds per second
+        bool avx2;                      ///< Whether AVX2 kernels ran
+        bool failed;                    ///< A file or the output failed
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decoding state of one file, two pictures are kept so that
+    ///        the next one decodes while the current one is measured
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Input
+    {
+        Path filePath;
+        Decoder decoder;
+        AVFrame* frame = nullptr;
+        AVFrame* pictures[2] = {nullptr, nullptr};
+        SwsContext* scaler = nullptr;
+    };
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Partial sums of a strip of rows of a plane
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    struct Strip
+    {
+        int plane;
+        int first;
+        int last;
+        Uint64 error = 0;
+        double ssim = 0.0;
+    };
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    //
+    ///////////////////////////////////////////////////////////////////////////
+    Options mOptions;
+    Input mInputs[2];
+    int mWidth;
+    int mHeight;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    /// \param reference Original or reference encode
+    /// \param distorted Encode to measure
+    /// \param options Output settings
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    QualityMetrics(
+        const Path& reference,
+        const Path& distorted,
+        const Options& options
+    );
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    ~QualityMetrics();
+
+private:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Decode the next picture of a file, as 8 bit 4:2:0 at the size
+    ///        of the reference
+    ///
+    /// \return False at the end of the file or on error
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    bool Decode(Input& input, int slot);
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Squared error and SSIM windows of a strip
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Measure(const AVFrame* reference, const AVFrame* distorted,
+        Strip& strip) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Size of a plane of the compared pictures
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Pair<int, int> GetPlaneSize(int plane) const;
+
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Write one frame in the output format
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    void Write(std::ostream& output, const Frame& frame) const;
+
+public:
+    ///////////////////////////////////////////////////////////////////////////
+    /// \brief Measure every frame, blocking until done
+    ///
+    /// \return Summary of the run
+    ///
+    ///////////////////////////////////////////////////////////////////////////
+    Report Run(void);
+};
+
+} // namespace Moon
@@ -7,16 +7,724 @@
 #include <SFML/System.hpp>
 #include <imgui.h>
 #include <imgui-SFML.h>
+#include <charconv>
+#include <cstring>
+
+///////////////////////////////////////////////////////////////////////////////
+static constexpr int IMGUI_SETTLE_FRAMES = 3;
+static constexpr double UI_POLL_INTERVAL = 1.0 / 60.0;
+static constexpr double STATS_INTERVAL = 1.0;
+static constexpr double MIN_WAIT = 0.001;
+static constexpr double AUDIO_SYNC_THRESHOLD = 0.15;
+static constexpr const char* DEINTERLACE_MODES[] = {"Off", "Auto", "On"};
+static constexpr const char* TONE_CURVES[] = {"Off", "BT.2390", "Hable"};
+
+///////////////////////////////////////////////////////////////////////////////
+static bool ParseNumber(const char* text, Moon::Uint32& value)
+{
+    const char* end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, value);
+
+    return (error == std::errc() && last == end && last != text);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static void TrackCombo(
+    Moon::VideoPlayer& player,
+    const char* label,
+    Moon::Stream::Type type
+)
+{
+    int selected = player.GetSelectedStream(type);
+    Moon::String preview = selected < 0 ? "None" : "#" + std::to_string(selected);
+
+    if (!ImGui::BeginCombo(label, preview.c_str())) {
+        return;
+    }
+
+    if (type != Moon::Stream::Type::Video &&
+        ImGui::Selectable("None", selected < 0)
+    ) {
+        player.SelectStream(type, -1);
+    }
+
+    for (const auto& stream : player.GetMedia()->streams) {
+        if (stream->type != type) {
+            continue;
+        }
+
+        int index = static_cast<int>(stream->index);
+        Moon::String name = "#" + std::to_string(index) + " " +
+            stream->codec.name;
+
+        if (ImGui::Selectable(name.c_str(), index == selected)) {
+            player.SelectStream(type, index);
+        }
+    }
+
+    ImGui::EndCombo();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunContactSheet(int argc, char* argv[])
+{
+    Moon::ContactSheet::Options options;
+    Moon::Vector<Moon::Path> files;
+    bool valid = true;
+
+    // Nothing else runs in batch mode, the user is waiting for the sheets
+    options.priority = Moon::TaskScheduler::Priority::Interactive;
+
+    for (int i = 2; i < argc; i++) {
+        Moon::String argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--count" && hasValue) {
+            valid &= ParseNumber(argv[++i], options.count);
+        } else if (argument == "--columns" && hasValue) {
+            valid &= ParseNumber(argv[++i], options.columns);
+        } else if (argument == "--width" && hasValue) {
+            valid &= ParseNumber(argv[++i], options.width);
+        } else if (argument == "--threads" && hasValue) {
+            valid &= ParseNumber(argv[++i], options.threads);
+        } else if (argument == "--format" && hasValue) {
+            options.format = argv[++i];
+        } else if (argument == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else if (argument == "--list" && hasValue) {
+            Moon::IfStream list(argv[++i]);
+            Moon::String line;
+
+            while (std::getline(list, line)) {
+                if (!line.empty()) {
+                    files.push_back(line);
+                }
+            }
+        } else {
+            files.push_back(argument);
+        }
+    }
+
+    if (!valid || files.empty()) {
+        std::cout << "Usage: " << argv[0] << " --contact-sheet [--count N] "
+            "[--columns N] [--width N] [--threads N] [--format jpg|png] "
+            "[--output <dir>] [--list <file>] <files...>" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::ContactSheet sheets(files, options);
+    Moon::ContactSheet::Report report = sheets.Run();
+
+    std::cout << report.files << " sheets, " << report.failed << " failed in "
+        << report.seconds << " s (" << (report.seconds > 0.0
+        ? (report.files + report.failed) / report.seconds : 0.0)
+        << " files/s), peak memory "
+        << (report.peakMemory >> 20) << " MB" << std::endl;
+
+    return (report.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunMetrics(int argc, char* argv[])
+{
+    Moon::QualityMetrics::Options options;
+    Moon::Vector<Moon::Path> files;
+
+    for (int i = 2; i < argc; i++) {
+        Moon::String argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--format" && hasValue) {
+            options.format = Moon::String(argv[++i]) == "json"
+                ? Moon::QualityMetrics::Format::Json
+                : Moon::QualityMetrics::Format::Csv;
+        } else if (argument == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else {
+            files.push_back(argument);
+        }
+    }
+
+    if (files.size() != 2) {
+        std::cout << "Usage: " << argv[0] << " --metrics [--format csv|json] "
+            "[--output <file>] <reference> <distorted>" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::QualityMetrics metrics(files[0], files[1], options);
+    Moon::QualityMetrics::Report report = metrics.Run();
+
+    // The measures may go to stdout, keep the summary apart
+    std::cerr << report.frames << " frames, PSNR " << report.psnr
+        << " dB, SSIM " << report.ssim << " in " << report.seconds << " s ("
+        << report.speed << "x real time" << (report.avx2 ? ", AVX2" : "")
+        << ")" << std::endl;
+
+    return (report.failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunBenchmark(int argc, char* argv[])
+{
+    Moon::Benchmark::Options options;
+
+    for (int i = 2; i < argc; i++) {
+        Moon::String argument = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (argument == "--seconds" && hasValue) {
+            options.seconds = std::max(std::atof(argv[++i]), 0.1);
+        } else if (options.suite.empty()) {
+            options.suite = argument;
+        } else {
+            std::cout << "Usage: " << argv[0] << " --benchmark "
+                "[--seconds N] [suite]" << std::endl;
+            return (EXIT_FAILURE);
+        }
+    }
+
+    Moon::Vector<Moon::Benchmark::Result> results =
+        Moon::Benchmark(options).Run();
+
+    if (results.empty()) {
+        std::cerr << "Unknown benchmark suite: " << options.suite << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::Benchmark::Print(std::cout, results);
+    return (EXIT_SUCCESS);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunGrid(int argc, char* argv[])
+{
+    Moon::Vector<Moon::Path> files;
+    sf::Vector2u cellSize(Moon::VideoWall::DEFAULT_CELL_WIDTH,
+        Moon::VideoWall::DEFAULT_CELL_HEIGHT);
+    bool valid = true;
+
+    for (int i = 2; i < argc; i++) {
+        Moon::String argument = argv[i];
+
+        if (argument == "--cell" && i + 2 < argc) {
+            valid &= ParseNumber(argv[++i], cellSize.x);
+            valid &= ParseNumber(argv[++i], cellSize.y);
+        } else {
+            files.push_back(argument);
+        }
+    }
+
+    if (!valid || files.empty() || cellSize.x < 2 || cellSize.y < 2) {
+        std::cout << "Usage: " << argv[0] << " --grid [--cell W H] "
+            "<files...>" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    sf::RenderWindow window(sf::VideoMode({1280, 720}), "Moon", sf::Style::Default);
+    sf::Clock clock;
+
+    if (!ImGui::SFML::Init(window)) {
+        std::cerr << "Coudl'nt initialize ImGui" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::VideoWall wall(files, cellSize);
+
+    if (wall.GetCount() == 0) {
+        ImGui::SFML::Shutdown();
+        return (EXIT_FAILURE);
+    }
+
+    wall.Play();
+
+    auto handleEvent = [&](const sf::Event& event) {
+        ImGui::SFML::ProcessEvent(window, event);
+
+        if (event.is<sf::Event::Closed>()) {
+            window.close();
+        } else if (auto size = event.getIf<sf::Event::Resized>()) {
+            window.setView(sf::View(sf::FloatRect(
+                {0.f, 0.f},
+                {
+                    static_cast<float>(size->size.x),
+                    static_cast<float>(size->size.y)
+                }
+            )));
+        } else if (auto key = event.getIf<sf::Event::KeyPressed>()) {
+            if (key->code == sf::Keyboard::Key::Space) {
+                wall.TogglePause();
+            }
+        }
+    };
+
+    // Same event driven loop as the single player, the overlay statistics
+    // are sampled every STATS_INTERVAL
+    int settleFrames = IMGUI_SETTLE_FRAMES;
+    double statsTime = 0.0;
+    double statsCpuTime = Moon::GetCpuTime();
+    double cpuUsage = 0.0;
+    double fps = 0.0;
+    Moon::Uint64 statsFrames = 0;
+    Moon::Uint64 memory = Moon::GetCurrentMemory();
+    sf::Clock statsClock;
+
+    while (window.isOpen()) {
+        double delay = wall.GetNextUpdateDelay();
+
+        if (settleFrames > 0) {
+            delay = 0.0;
+        }
+        delay = std::min(delay,
+            statsTime + STATS_INTERVAL - statsClock.getElapsedTime().asSeconds());
+
+        if (delay > 0.0) {
+            auto event = window.waitEvent(sf::seconds(
+                static_cast<float>(std::max(delay, MIN_WAIT))));
+
+            if (event) {
+                handleEvent(*event);
+                settleFrames = IMGUI_SETTLE_FRAMES;
+            }
+        }
+
+        while (auto event = window.pollEvent()) {
+            handleEvent(*event);
+            settleFrames = IMGUI_SETTLE_FRAMES;
+        }
+
+        if (!window.isOpen()) {
+            break;
+        }
+
+        if (wall.Update()) {
+            settleFrames = std::max(settleFrames, 1);
+        }
+
+        double now = statsClock.getElapsedTime().asSeconds();
+
+        if (now - statsTime >= STATS_INTERVAL) {
+            double cpuTime = Moon::GetCpuTime();
+            Moon::Uint64 frames = 0;
+
+            for (size_t i = 0; i < wall.GetCount(); i++) {
+                frames += wall.GetPlayer(i).GetPresentedFrames();
+            }
+
+            cpuUsage = 100.0 * (cpuTime - statsCpuTime) / (now - statsTime);
+            fps = (frames - statsFrames) / (now - statsTime);
+            memory = Moon::GetCurrentMemory();
+            statsFrames = frames;
+            statsCpuTime = cpuTime;
+            statsTime = now;
+            settleFrames = std::max(settleFrames, 1);
+        }
+
+        if (settleFrames == 0) {
+            continue;
+        }
+        settleFrames--;
+
+        ImGui::SFML::Update(window, clock.restart());
+
+        ImGui::Begin("Wall");
+        if (ImGui::Button("Play/Pause")) {
+            wall.TogglePause();
+        }
+        ImGui::Text("Tiles: %zu (%ux%u)", wall.GetCount(),
+            wall.GetGridSize().x, wall.GetGridSize().y);
+        ImGui::Text("FPS: %.1f", fps);
+        ImGui::Text("Memory: %.0f MB", static_cast<double>(memory) / (1 << 20));
+        ImGui::Text("CPU: %.1f%%", cpuUsage);
+
+        for (size_t i = 0; i < wall.GetCount(); i++) {
+            ImGui::Text("%2zu %s: %llu dropped", i + 1,
+                wall.GetFilePath(i).filename().string().c_str(),
+                static_cast<unsigned long long>(
+                    wall.GetPlayer(i).GetDroppedFrames()));
+        }
+        ImGui::End();
+
+        window.clear(sf::Color::Black);
+        wall.Draw(window, sf::FloatRect({0.f, 0.f}, window.getView().getSize()));
+        ImGui::SFML::Render(window);
+
+        window.display();
+    }
+
+    ImGui::SFML::Shutdown();
+
+    return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static int RunCompare(int argc, char* argv[])
+{
+    if (argc != 4) {
+        std::cout << "Usage: " << argv[0] << " --compare <reference> <other>"
+            << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    sf::RenderWindow window(sf::VideoMode({1280, 720}), "Moon", sf::Style::Default);
+    sf::Clock clock;
+
+    if (!ImGui::SFML::Init(window)) {
+        std::cerr << "Coudl'nt initialize ImGui" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::ComparePlayer player(argv[2], argv[3]);
+
+    if (!player.IsOpen()) {
+        ImGui::SFML::Shutdown();
+        return (EXIT_FAILURE);
+    }
+
+    player.Play();
+
+    bool wipe = false;
+    float wipePosition = 0.5f;
+    bool seeking = false;
+    float seekPosition = 0.f;
+    sf::Sprite reference(player.GetTexture(0));
+    sf::Sprite other(player.GetTexture(1));
+
+    // Split shows each file in its half; the wipe fits both files to the
+    // same rectangle and crops the reference at the wipe position
+    auto layout = [&](sf::Vector2f size) {
+        sf::Vector2u referenceSize = player.GetTexture(0).getSize();
+        sf::Vector2u otherSize = player.GetTexture(1).getSize();
+
+        if (referenceSize.x == 0 || otherSize.x == 0) {
+            return;
+        }
+
+        auto fit = [](sf::Sprite& sprite, sf::Vector2u texture,
+            sf::FloatRect area
+        ) {
+            float scale = std::min(area.size.x / texture.x,
+                area.size.y / texture.y);
+
+            sprite.setTextureRect(sf::IntRect({0, 0}, sf::Vector2i(texture)));
+            sprite.setScale({scale, scale});
+            sprite.setPosition(area.position + (area.size -
+                sf::Vector2f(texture) * scale) / 2.f);
+        };
+
+        if (!wipe) {
+            sf::Vector2f half(size.x / 2, size.y);
+
+            fit(reference, referenceSize, sf::FloatRect({0.f, 0.f}, half));
+            fit(other, otherSize, sf::FloatRect({half.x, 0.f}, half));
+            return;
+        }
+
+        fit(reference, referenceSize, sf::FloatRect({0.f, 0.f}, size));
+
+        sf::Vector2f shown = sf::Vector2f(referenceSize).componentWiseMul(
+            reference.getScale());
+
+        other.setTextureRect(sf::IntRect({0, 0}, sf::Vector2i(otherSize)));
+        other.setPosition(reference.getPosition());
+        other.setScale(shown.componentWiseDiv(sf::Vector2f(otherSize)));
+        reference.setTextureRect(sf::IntRect({0, 0}, {
+            static_cast<int>(referenceSize.x * wipePosition),
+            static_cast<int>(referenceSize.y)
+        }));
+    };
+
+    auto handleEvent = [&](const sf::Event& event) {
+        ImGui::SFML::ProcessEvent(window, event);
+
+        if (event.is<sf::Event::Closed>()) {
+            window.close();
+        } else if (auto size = event.getIf<sf::Event::Resized>()) {
+            window.setView(sf::View(sf::FloatRect(
+                {0.f, 0.f},
+                {
+                    static_cast<float>(size->size.x),
+                    static_cast<float>(size->size.y)
+                }
+            )));
+        } else if (auto key = event.getIf<sf::Event::KeyPressed>()) {
+            if (key->code == sf::Keyboard::Key::Space) {
+                player.TogglePause();
+            } else if (key->code == sf::Keyboard::Key::Right) {
+                player.StepForward();
+            } else if (key->code == sf::Keyboard::Key::Left) {
+                player.StepBackward();
+            } else if (key->code == sf::Keyboard::Key::W) {
+                wipe = !wipe;
+            }
+        } else if (auto move = event.getIf<sf::Event::MouseMoved>()) {
+            // Dragging over the picture moves the wipe
+            if (wipe && sf::Mouse::isButtonPressed(sf::Mouse::Button::Left) &&
+                !ImGui::GetIO().WantCaptureMouse
+            ) {
+                sf::FloatRect bounds = reference.getGlobalBounds();
+                float width = player.GetTexture(0).getSize().x *
+                    reference.getScale().x;
+
+                wipePosition = std::clamp(
+                    (move->position.x - bounds.position.x) / width, 0.f, 1.f);
+            }
+        }
+    };
+
+    int settleFrames = IMGUI_SETTLE_FRAMES;
+
+    while (window.isOpen()) {
+        double delay = settleFrames > 0 ? 0.0 : player.GetNextUpdateDelay();
+
+        // A zero timeout would block until the next event, and the delay
+        // is infinite while paused
+        if (delay > 0.0) {
+            auto event = window.waitEvent(sf::seconds(
+                static_cast<float>(std::min(std::max(delay, MIN_WAIT),
+                    STATS_INTERVAL))));
+
+            if (event) {
+                handleEvent(*event);
+                settleFrames = IMGUI_SETTLE_FRAMES;
+            }
+        }
+
+        while (auto event = window.pollEvent()) {
+            handleEvent(*event);
+            settleFrames = IMGUI_SETTLE_FRAMES;
+        }
+
+        if (!window.isOpen()) {
+            break;
+        }
+
+        if (player.Update()) {
+            settleFrames = std::max(settleFrames, 1);
+        }
+
+        if (settleFrames == 0) {
+            continue;
+        }
+        settleFrames--;
+
+        ImGui::SFML::Update(window, clock.restart());
+
+        ImGui::Begin("Compare");
+        if (ImGui::Button("Play/Pause")) {
+            player.TogglePause();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("<")) {
+            player.StepBackward();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button(">")) {
+            player.StepForward();
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Wipe", &wipe);
+        if (wipe) {
+            ImGui::SliderFloat("Wipe position", &wipePosition, 0.f, 1.f);
+        }
+
+        // Both files are only seeked once the slider is released
+        float position = seeking ? seekPosition
+            : static_cast<float>(player.GetCurrentTime());
+
+        if (ImGui::SliderFloat("Position", &position, 0.f,
+            static_cast<float>(player.GetDuration()), "%.2f s")
+        ) {
+            seeking = true;
+            seekPosition = position;
+        }
+        if (ImGui::IsItemDeactivated() && seeking) {
+            seeking = false;
+            player.Seek(seekPosition);
+        }
+
+        ImGui::Text("A: %.3f s  %s", player.GetFrameTime(0),
+            player.GetFilePath(0).filename().string().c_str());
+        ImGui::Text("B: %.3f s  %s", player.GetFrameTime(1),
+            player.GetFilePath(1).filename().string().c_str());
+        ImGui::End();
+
+        window.clear(sf::Color::Black);
+
+        layout(window.getView().getSize());
+        reference.setTexture(player.GetTexture(0));
+        other.setTexture(player.GetTexture(1));
+        if (wipe) {
+            window.draw(other);
+            window.draw(reference);
+        } else {
+            window.draw(reference);
+            window.draw(other);
+        }
+        ImGui::SFML::Render(window);
+
+        window.display();
+    }
+
+    ImGui::SFML::Shutdown();
+
+    return (0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static Moon::SharedPtr<Moon::Playlist> ParsePlaylist(
+    int argc,
+    char* argv[],
+    bool& valid
+)
+{
+    Moon::Vector<Moon::Path> items;
+    bool requested = false;
+    bool loop = false;
+
+    for (int i = 1; i < argc; i++) {
+        Moon::String argument = argv[i];
+
+        if (argument == "--playlist") {
+            requested = true;
+        } else if (argument == "--loop") {
+            loop = true;
+        } else {
+            items.push_back(argument);
+        }
+    }
+
+    valid = !(requested || loop) || items.size() >= 2;
+
+    if (!valid || items.size() < 2) {
+        return (nullptr);
+    }
+    return (std::make_shared<Moon::Playlist>(items, loop));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static const char* GetStageName(Moon::Source::Stage stage)
+{
+    switch (stage) {
+        case Moon::Source::Stage::Opening: return ("Opening");
+        case Moon::Source::Stage::OpeningCodec: return ("Opening codec");
+        case Moon::Source::Stage::Decoding: return ("Decoding");
+        case Moon::Source::Stage::Ready: return ("Ready");
+        case Moon::Source::Stage::Failed: return ("Failed");
+        case Moon::Source::Stage::Cancelled: return ("Cancelled");
+    }
+    return ("");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+static Moon::UniquePtr<Moon::Source> LoadSource(
+    sf::RenderWindow& window,
+    sf::Clock& clock,
+    const Moon::Path& filePath
+)
+{
+    Moon::Loader loader(filePath);
+
+    auto handleEvent = [&](const sf::Event& event) {
+        ImGui::SFML::ProcessEvent(window, event);
+
+        if (event.is<sf::Event::Closed>()) {
+            loader.Cancel();
+            window.close();
+        }
+    };
+
+    // Keep the interface alive while the file is probed on the worker
+    while (window.isOpen() && !loader.IsDone()) {
+        if (auto event = window.waitEvent(
+            sf::seconds(static_cast<float>(UI_POLL_INTERVAL)))
+        ) {
+            handleEvent(*event);
+        }
+
+        while (auto event = window.pollEvent()) {
+            handleEvent(*event);
+        }
+
+        if (!window.isOpen()) {
+            break;
+        }
+
+        ImGui::SFML::Update(window, clock.restart());
+
+        ImGui::Begin("Loading");
+        ImGui::TextUnformatted(filePath.filename().string().c_str());
+        ImGui::ProgressBar(static_cast<float>(loader.GetProgress()),
+            ImVec2(-1.0f, 0.0f), GetStageName(loader.GetStage()));
+        if (ImGui::Button("Cancel")) {
+            loader.Cancel();
+        }
+        ImGui::End();
+
+        window.clear(sf::Color::Black);
+        ImGui::SFML::Render(window);
+        window.display();
+    }
+
+    Moon::UniquePtr<Moon::Source> source = loader.Take();
+
+    if (!source && window.isOpen()) {
+        std::cerr << "Could not load " << filePath << ": "
+            << GetStageName(loader.GetStage()) << std::endl;
+    }
+    return (source);
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 int main(int argc, char* argv[])
 {
     if (argc == 1) {
         std::cout << "Usage: " << argv[0] << " <file>" << std::endl;
+        std::cout << "       " << argv[0] << " [--playlist] [--loop] "
+            "<files...>" << std::endl;
+        std::cout << "       " << argv[0] << " --contact-sheet [options] "
+            "<files...>" << std::endl;
+        std::cout << "       " << argv[0] << " --grid [--cell W H] "
+            "<files...>" << std::endl;
+        std::cout << "       " << argv[0] << " --compare <reference> "
+            "<other>" << std::endl;
+        std::cout << "       " << argv[0] << " --metrics [options] "
+            "<reference> <distorted>" << std::endl;
+        std::cout << "       " << argv[0] << " --benchmark [--seconds N] "
+            "[suite]" << std::endl;
         return (0);
     }
 
-    Moon::VideoPlayer player(argv[1]);
+    if (Moon::String(argv[1]) == "--contact-sheet") {
+        return (RunContactSheet(argc, argv));
+    }
+
+    if (Moon::String(argv[1]) == "--grid") {
+        return (RunGrid(argc, argv));
+    }
+
+    if (Moon::String(argv[1]) == "--compare") {
+        return (RunCompare(argc, argv));
+    }
+
+    if (Moon::String(argv[1]) == "--metrics") {
+        return (RunMetrics(argc, argv));
+    }
+
+    if (Moon::String(argv[1]) == "--benchmark") {
+        return (RunBenchmark(argc, argv));
+    }
+
+    bool valid = true;
+    Moon::SharedPtr<Moon::Playlist> playlist = ParsePlaylist(argc, argv, valid);
+
+    if (!valid) {
+        std::cout << "Usage: " << argv[0] << " [--playlist] [--loop] "
+            "<files...>" << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    Moon::Timeline timeline;
+    Moon::WaveformStrip waveform;
 
     bool isFullscreen = false;
     sf::Vector2i lastPosition;
@@ -29,59 +737,412 @@ int main(int argc, char* argv[])
         return (EXIT_FAILURE);
     }
 
+    Moon::UniquePtr<Moon::Source> source = nullptr;
+
+    if (!playlist) {
+        source = LoadSource(window, clock, argv[1]);
+
+        if (!source) {
+            ImGui::SFML::Shutdown();
+            return (window.isOpen() ? EXIT_FAILURE : EXIT_SUCCESS);
+        }
+    }
+
+    Moon::VideoPlayer player = playlist
+        ? Moon::VideoPlayer(playlist) : Moon::VideoPlayer(std::move(source));
+    Moon::SharedPtr<Moon::Media> shownMedia = player.GetMedia();
+    auto thumbnails = std::make_unique<Moon::ThumbnailProvider>(
+        shownMedia->filePath, player.GetKeyframeIndex());
+    auto analysis = std::make_unique<Moon::MediaAnalysis>(
+        shownMedia->filePath, player.GetDuration());
+    auto peaks = std::make_unique<Moon::AudioPeaks>(shownMedia->filePath);
+    Moon::UniquePtr<Moon::Scopes> scopes = nullptr;
+    Moon::UniquePtr<Moon::Spectrum> spectrum = nullptr;
+    Moon::UniquePtr<Moon::LoudnessScan> loudness = nullptr;
+    Moon::UniquePtr<Moon::AudioOutput> audio = nullptr;
+    int audioStream = -1;
+    bool normalize = true;
+    bool showScopes = false;
+    bool showSpectrum = false;
+    Moon::Array<char, 256> filters{};
+    Moon::Array<char, 512> lutPath{};
+    Moon::SharedPtr<const Moon::ColorLut> lut = nullptr;
+    Moon::ColorGrade grade;
+    bool lutOnCpu = false;
+    bool lutFailed = false;
+
     player.Play();
 
     sf::Sprite sprite(player.GetCurrentFrameTexture());
 
+    // The shader grades at draw time, the player only when it cannot.
+    // Queued frames keep the grade of their path: frames graded on the CPU
+    // skip the shader, and the previous shader stays for the ungraded ones
+    // until the first frame graded on the CPU shows
+    auto applyLut = [&]() {
+        if (!lutOnCpu && grade.SetLut(lut)) {
+            player.SetLut(nullptr);
+        } else {
+            if (!lut) {
+                grade.SetLut(nullptr);
+            }
+            player.SetLut(lut);
+        }
+    };
+
+    // Sound follows the video clock, it is moved back in place when the two
+    // drift apart or after a seek
+    auto syncAudio = [&]() {
+        int stream = player.GetSelectedStream(Moon::Stream::Type::Audio);
+
+        if (!audio || stream != audioStream) {
+            audio.reset();
+            loudness.reset();
+            audioStream = stream;
+            if (stream >= 0) {
+                loudness = std::make_unique<Moon::LoudnessScan>(
+                    shownMedia->filePath, stream);
+                audio = std::make_unique<Moon::AudioOutput>(
+                    shownMedia->filePath, stream);
+                if (spectrum) {
+                    audio->SetTap(spectrum->GetTap());
+                    spectrum->SetSampleRate(audio->GetSampleRate());
+                }
+            }
+        }
+
+        if (!audio || !audio->IsOpen()) {
+            return;
+        }
+
+        Moon::Optional<double> gain = loudness->GetNormalizationGain();
+        bool playing = audio->getStatus() == sf::SoundSource::Status::Playing;
+        double current = player.GetCurrentTime();
+
+        audio->SetGain(normalize && gain ? *gain : 0.0);
+
+        if (!player.IsPlaying() || player.IsReverse() ||
+            player.IsPrerolling() || player.IsEndOfVideo()
+        ) {
+            if (playing) {
+                audio->pause();
+            }
+            return;
+        }
+
+        audio->SetSpeed(player.GetPlaybackSpeed());
+
+        if (!playing) {
+            audio->setPlayingOffset(sf::seconds(static_cast<float>(current)));
+            audio->play();
+        } else if (std::abs(audio->GetPosition() - current) >
+            AUDIO_SYNC_THRESHOLD
+        ) {
+            audio->setPlayingOffset(sf::seconds(static_cast<float>(current)));
+        }
+    };
+
+    auto fitSprite = [&](sf::Vector2u size) {
+        sf::Vector2u videoSize = player.GetCurrentFrameTexture().getSize();
+        float scaleX = static_cast<float>(size.x) / videoSize.x;
+        float scaleY = static_cast<float>(size.y) / videoSize.y;
+        float scale = std::min(scaleX, scaleY);
+
+        sprite.setScale({scale, scale});
+        sprite.setPosition({
+            (size.x - videoSize.x * scale) / 2,
+            (size.y - videoSize.y * scale) / 2}
+        );
+    };
+
+    auto handleEvent = [&](const sf::Event& event) {
+        ImGui::SFML::ProcessEvent(window, event);
+
+        if (event.is<sf::Event::Closed>()) {
+            window.close();
+            player.Stop();
+        } else if (auto size = event.getIf<sf::Event::Resized>()) {
+            window.setView(sf::View(sf::FloatRect(
+                {0.f, 0.f},
+                {
+                    static_cast<float>(size->size.x),
+                    static_cast<float>(size->size.y)
+                }
+            )));
+            fitSprite(size->size);
+        } else if (auto key = event.getIf<sf::Event::KeyPressed>()) {
+            if (key->code == sf::Keyboard::Key::Space) {
+                player.TogglePause();
+            } else if (key->code == sf::Keyboard::Key::R) {
+                player.SetReverse(!player.IsReverse());
+            } else if (key->code == sf::Keyboard::Key::S) {
+                showScopes = !showScopes;
+            } else if (key->code == sf::Keyboard::Key::A) {
+                showSpectrum = !showSpectrum;
+            } else if (key->code == sf::Keyboard::Key::Right) {
+                player.StepForward();
+            } else if (key->code == sf::Keyboard::Key::Left) {
+                player.StepBackward();
+            } else if (key->code == sf::Keyboard::Key::PageDown) {
+                Moon::Optional<double> scene = analysis->FindNextScene(
+                    player.GetCurrentTime());
+
+                if (scene) {
+                    player.Seek(*scene);
+                }
+            } else if (key->code == sf::Keyboard::Key::PageUp) {
+                player.Seek(analysis->FindPreviousScene(
+                    player.GetCurrentTime()));
+            } else if (key->code == sf::Keyboard::Key::F) {
+                isFullscreen = !isFullscreen;
+                window.create(sf::VideoMode({800, 600}), "Moon", sf::Style::Default, (isFullscreen ? sf::State::Fullscreen : sf::State::Windowed));
+                window.setPosition(lastPosition);
+            }
+        }
+    };
+
+    // Nothing is drawn unless something changed; ImGui gets a few extra
+    // frames after each change to settle hover and animation states
+    int settleFrames = IMGUI_SETTLE_FRAMES;
+    double statsTime = 0.0;
+    double statsCpuTime = Moon::GetCpuTime();
+    double cpuUsage = 0.0;
+    Moon::FilterGraph::Stats filterStats;
+    double filterCost = 0.0;
+    double filterRate = 0.0;
+    sf::Clock statsClock;
+
     while (window.isOpen()) {
+        double delay = player.GetNextUpdateDelay();
+
+        if (settleFrames > 0) {
+            delay = 0.0;
+        } else if (thumbnails->IsPending() ||
+            (scopes && scopes->IsPending()) ||
+            (spectrum && spectrum->IsPending())
+        ) {
+            delay = std::min(delay, UI_POLL_INTERVAL);
+        }
+        delay = std::min(delay,
+            statsTime + STATS_INTERVAL - statsClock.getElapsedTime().asSeconds());
+
+        // A zero timeout would block until the next event
+        if (delay > 0.0) {
+            auto event = window.waitEvent(sf::seconds(
+                static_cast<float>(std::max(delay, MIN_WAIT))));
+
+            if (event) {
+                handleEvent(*event);
+                settleFrames = IMGUI_SETTLE_FRAMES;
+            }
+        }
+
         while (auto event = window.pollEvent()) {
-            ImGui::SFML::ProcessEvent(window, *event);
-
-            if (event->is<sf::Event::Closed>()) {
-                window.close();
-                player.Stop();
-            } else if (auto size = event->getIf<sf::Event::Resized>()) {
-                window.setView(sf::View(sf::FloatRect(
-                    {0.f, 0.f},
-                    {
-                        static_cast<float>(size->size.x),
-                        static_cast<float>(size->size.y)
-                    }
-                )));
-
-                sf::Vector2u videoSize = player.GetCurrentFrameTexture().getSize();
-                float scaleX = static_cast<float>(size->size.x) / videoSize.x;
-                float scaleY = static_cast<float>(size->size.y) / videoSize.y;
-                float scale = std::min(scaleX, scaleY);
-
-                sprite.setScale({scale, scale});
-                sprite.setPosition({
-                    (size->size.x - videoSize.x * scale) / 2,
-                    (size->size.y - videoSize.y * scale) / 2}
-                );
-            } else if (auto key = event->getIf<sf::Event::KeyPressed>()) {
-                if (key->code == sf::Keyboard::Key::Space) {
-                    player.TogglePause();
-                } else if (key->code == sf::Keyboard::Key::F) {
-                    isFullscreen = !isFullscreen;
-                    window.create(sf::VideoMode({800, 600}), "Moon", sf::Style::Default, (isFullscreen ? sf::State::Fullscreen : sf::State::Windowed));
-                    window.setPosition(lastPosition);
-                }
+            handleEvent(*event);
+            settleFrames = IMGUI_SETTLE_FRAMES;
+        }
+
+        if (!window.isOpen()) {
+            break;
+        }
+
+        bool presented = player.Update();
+
+        // Each playlist item has its own thumbnails and picture size
+        if (player.GetMedia() != shownMedia) {
+            shownMedia = player.GetMedia();
+            thumbnails = std::make_unique<Moon::ThumbnailProvider>(
+                shownMedia->filePath, player.GetKeyframeIndex());
+            analysis = std::make_unique<Moon::MediaAnalysis>(
+                shownMedia->filePath, player.GetDuration());
+            peaks = std::make_unique<Moon::AudioPeaks>(shownMedia->filePath);
+            audio.reset();
+            sprite.setTexture(player.GetCurrentFrameTexture(), true);
+            fitSprite(window.getSize());
+        }
+
+        syncAudio();
+
+        bool uploaded = thumbnails->Update();
+
+        // Decoded pictures are only kept while the scopes need them
+        if (showScopes && !scopes) {
+            scopes = std::make_unique<Moon::Scopes>();
+            player.SetKeepPictures(true);
+            scopes->Submit(player.GetCurrentFrame());
+        } else if (!showScopes && scopes) {
+            scopes.reset();
+            player.SetKeepPictures(false);
+        }
+
+        if (scopes) {
+            if (presented) {
+                scopes->Submit(player.GetCurrentFrame());
             }
+            uploaded = scopes->Update() || uploaded;
         }
 
+        // The tap only costs the audio thread a copy while it is attached
+        if (showSpectrum && !spectrum) {
+            spectrum = std::make_unique<Moon::Spectrum>();
+            if (audio) {
+                audio->SetTap(spectrum->GetTap());
+                spectrum->SetSampleRate(audio->GetSampleRate());
+            }
+        } else if (!showSpectrum && spectrum) {
+            if (audio) {
+                audio->SetTap(nullptr);
+            }
+            spectrum.reset();
+        }
+
+        if (spectrum) {
+            uploaded = spectrum->Update() || uploaded;
+        }
+
+        if (presented || uploaded) {
+            settleFrames = std::max(settleFrames, 1);
+        }
+
+        double now = statsClock.getElapsedTime().asSeconds();
+
+        if (now - statsTime >= STATS_INTERVAL) {
+            double cpuTime = Moon::GetCpuTime();
+
+            cpuUsage = 100.0 * (cpuTime - statsCpuTime) / (now - statsTime);
+
+            // Filter cost per output picture over the last interval
+            Moon::FilterGraph::Stats stats = player.GetFilterStats();
+            Moon::Uint64 outputs = stats.outputs - std::min(
+                filterStats.outputs, stats.outputs);
+
+            filterCost = outputs == 0 ? 0.0 : 1000.0 *
+                (stats.seconds - filterStats.seconds) / outputs;
+            filterRate = outputs / (now - statsTime);
+            filterStats = stats;
+
+            statsCpuTime = cpuTime;
+            statsTime = now;
+            settleFrames = std::max(settleFrames, 1);
+        }
+
+        if (settleFrames == 0) {
+            continue;
+        }
+        settleFrames--;
+
         ImGui::SFML::Update(window, clock.restart());
 
         if (!isFullscreen) {
             lastPosition = window.getPosition();
         }
-        player.Update();
 
         ImGui::Begin("Controls");
         if (ImGui::Button("Play/Pause")) {
             player.TogglePause();
         }
 
+        ImGui::SameLine();
+        if (ImGui::Button("<")) {
+            player.StepBackward();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button(">")) {
+            player.StepForward();
+        }
+
+        bool reverse = player.IsReverse();
+        if (ImGui::Checkbox("Reverse", &reverse)) {
+            player.SetReverse(reverse);
+        }
+        ImGui::SameLine();
+        ImGui::Checkbox("Scopes", &showScopes);
+        ImGui::SameLine();
+        ImGui::Checkbox("Spectrum", &showSpectrum);
+
+        if (ImGui::InputTextWithHint("Filters", "e.g. hqdn3d,transpose=1",
+            filters.data(), filters.size(), ImGuiInputTextFlags_EnterReturnsTrue)
+        ) {
+            player.SetFilters(filters.data());
+        }
+
+        int deinterlace = static_cast<int>(player.GetDeinterlace());
+
+        if (ImGui::Combo("Deinterlace", &deinterlace, DEINTERLACE_MODES,
+            IM_ARRAYSIZE(DEINTERLACE_MODES))
+        ) {
+            player.SetDeinterlace(
+                static_cast<Moon::FilterGraph::Deinterlace>(deinterlace));
+        }
+
+        int toneCurve = static_cast<int>(player.GetToneMapping());
+
+        if (ImGui::Combo("Tone mapping", &toneCurve, TONE_CURVES,
+            IM_ARRAYSIZE(TONE_CURVES))
+        ) {
+            player.SetToneMapping(static_cast<Moon::ToneMap::Curve>(toneCurve));
+        }
+
+        if (filterStats.outputs > 0) {
+            ImGui::Text("Filters: %.2f ms/frame, %.1f fps%s", filterCost,
+                filterRate, filterStats.deinterlacing ? ", deinterlacing" : "");
+        }
+
+        Moon::String filterError = player.GetFilterError();
+
+        if (!filterError.empty()) {
+            ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "%s", filterError.c_str());
+        }
+
+        if (ImGui::InputTextWithHint("LUT", "path to a .cube file",
+            lutPath.data(), lutPath.size(), ImGuiInputTextFlags_EnterReturnsTrue)
+        ) {
+            auto loaded = std::make_shared<Moon::ColorLut>();
+
+            // A file that fails to load keeps the current grade
+            lutFailed = false;
+            if (lutPath[0] == '\0') {
+                lut = nullptr;
+            } else if (loaded->LoadFromFile(lutPath.data())) {
+                lut = loaded;
+            } else {
+                lutFailed = true;
+            }
+            applyLut();
+        }
+        ImGui::SameLine();
+        if (ImGui::Checkbox("CPU", &lutOnCpu)) {
+            applyLut();
+        }
+
+        if (lutFailed) {
+            ImGui::TextColored({1.f, 0.4f, 0.4f, 1.f}, "Could not load the LUT");
+        } else if (lut) {
+            ImGui::Text("LUT: %s, %d points, %s", lut->GetTitle().c_str(),
+                lut->GetSize(), player.GetLut() ? "CPU" : "shader");
+        }
+
+        ImGui::Checkbox("Normalize", &normalize);
+        if (loudness && loudness->IsComplete()) {
+            Moon::Optional<Moon::LoudnessScan::Result> result =
+                loudness->GetResult();
+
+            if (result) {
+                ImGui::SameLine();
+                ImGui::Text("%.1f LUFS, %.1f dBTP, gain %+.1f dB",
+                    result->integrated, result->truePeak,
+                    *loudness->GetNormalizationGain());
+            }
+        } else if (loudness) {
+            ImGui::SameLine();
+            ImGui::Text("Measuring loudness: %.0f%%",
+                loudness->GetProgress() * 100.0);
+        }
+
+        TrackCombo(player, "Video", Moon::Stream::Type::Video);
+        TrackCombo(player, "Audio", Moon::Stream::Type::Audio);
+        TrackCombo(player, "Subtitles", Moon::Stream::Type::Subtitle);
+
         // Add playback speed controls
         float speed = static_cast<float>(player.GetPlaybackSpeed());
         if (ImGui::SliderFloat("Speed", &speed, 0.25f, 4.0f, "%.2fx")) {
@@ -107,13 +1168,61 @@ int main(int argc, char* argv[])
             player.SetPlaybackSpeed(2.0);
         }
 
-        ImGui::Text("%.0f/%.0f", player.GetCurrentTime(), player.GetDuration());
+        // Memory budget of the frame stepping cache
+        int budget = static_cast<int>(player.GetFrameCacheBudget() >> 20);
+        if (ImGui::SliderInt("Step cache", &budget, 64, 4096, "%d MB")) {
+            player.SetFrameCacheBudget(static_cast<Moon::Uint64>(budget) << 20);
+        }
+        ImGui::Text("Step cache: %.0f MB",
+            static_cast<double>(player.GetFrameCacheSize()) / (1 << 20));
+
+        int preroll = static_cast<int>(player.GetPrerollDepth());
+        if (ImGui::SliderInt("Preroll", &preroll, 1, 30, "%d frames")) {
+            player.SetPrerollDepth(static_cast<size_t>(preroll));
+        }
+        ImGui::Text("First frame: %.1f ms, playback: %.1f ms",
+            player.GetTimeToFirstFrame() * 1000.0,
+            player.GetTimeToPreroll() * 1000.0);
+
+        ImGui::Text("CPU: %.1f%%", cpuUsage);
+
+        if (playlist) {
+            ImGui::Text("Item %zu/%zu: %s", player.GetCurrentItem() + 1,
+                playlist->GetCount(),
+                shownMedia->filePath.filename().string().c_str());
+        }
+
+        // Markers fill in as the analysis goes, redrawn with the stats
+        if (analysis->IsComplete()) {
+            ImGui::Text("Scenes: %zu (PageUp/PageDown)",
+                analysis->GetResults().scenes.size());
+        } else {
+            ImGui::Text("Analyzing: %.0f%%", analysis->GetProgress() * 100.0);
+        }
+
+        timeline.Draw(player, thumbnails.get(), analysis.get());
+        waveform.Draw(player, *peaks);
         ImGui::End();
 
+        if (scopes) {
+            scopes->Draw(&showScopes);
+        }
+
+        if (spectrum) {
+            spectrum->Draw(&showSpectrum);
+        }
+
         window.clear(sf::Color::Black);
 
+        Moon::SharedPtr<const Moon::ColorLut> shownLut = player.GetShownLut();
+
+        if (shownLut && shownLut == player.GetLut()) {
+            grade.SetLut(nullptr);
+        }
+
         sprite.setTexture(player.GetCurrentFrameTexture());
-        window.draw(sprite);
+        window.draw(sprite, sf::RenderStates(
+            shownLut ? nullptr : grade.GetShader()));
         ImGui::SFML::Render(window);
 
         window.display();